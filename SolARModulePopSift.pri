@@ -1,9 +1,39 @@
 HEADERS += \
+    $$PWD/interfaces/IPopSiftBinaryCodes.h \
+    $$PWD/interfaces/IPopSiftBinaryMatcher.h \
+    $$PWD/interfaces/IPopSiftBoWVocabulary.h \
+    $$PWD/interfaces/IPopSiftQualityControl.h \
+    $$PWD/interfaces/IPopSiftStereoMatcher.h \
+    $$PWD/interfaces/IPopSiftWarmup.h \
+    $$PWD/interfaces/SolARBinaryDescriptorMatcherPopSift.h \
+    $$PWD/interfaces/SolARBoWVocabularyPopSift.h \
+    $$PWD/interfaces/SolARDescriptorsExtractorFromImageClientPopSift.h \
     $$PWD/interfaces/SolARDescriptorsExtractorFromImagePopSift.h \
     $$PWD/interfaces/SolARImageMatcherPopSift.h \
     $$PWD/interfaces/SolARPopSiftAPI.h \
-    $$PWD/interfaces/SolARPopSiftHelper.h
+    $$PWD/interfaces/SolARPopSiftBinarySift.h \
+    $$PWD/interfaces/SolARPopSiftDenseSift.h \
+    $$PWD/interfaces/SolARPopSiftDescriptorKernels.h \
+    $$PWD/interfaces/SolARPopSiftExtractionChannel.h \
+    $$PWD/interfaces/SolARPopSiftHelper.h \
+    $$PWD/interfaces/SolARPopSiftKernels.h \
+    $$PWD/interfaces/SolARPopSiftQualityController.h \
+    $$PWD/interfaces/SolARPopSiftStereoMatcher.h \
+    $$PWD/interfaces/SolARPopSiftTaskScheduler.h \
+    $$PWD/interfaces/SolARPopSiftWarmup.h
 
 SOURCES += $$PWD/src/SolARModulePopSift.cpp \
+    $$PWD/src/SolARBinaryDescriptorMatcherPopSift.cpp \
+    $$PWD/src/SolARBoWVocabularyPopSift.cpp \
+    $$PWD/src/SolARDescriptorsExtractorFromImageClientPopSift.cpp \
     $$PWD/src/SolARDescriptorsExtractorFromImagePopSift.cpp \
-    $$PWD/src/SolARImageMatcherPopSift.cpp
+    $$PWD/src/SolARImageMatcherPopSift.cpp \
+    $$PWD/src/SolARPopSiftBinarySift.cpp \
+    $$PWD/src/SolARPopSiftDenseSift.cpp \
+    $$PWD/src/SolARPopSiftDescriptorKernels.cpp \
+    $$PWD/src/SolARPopSiftExtractionChannel.cpp \
+    $$PWD/src/SolARPopSiftKernels.cpp \
+    $$PWD/src/SolARPopSiftQualityController.cpp \
+    $$PWD/src/SolARPopSiftStereoMatcher.cpp \
+    $$PWD/src/SolARPopSiftTaskScheduler.cpp \
+    $$PWD/src/SolARPopSiftWarmup.cpp
@@ -44,6 +44,7 @@ include (SolARModulePopSift.pri)
 unix {
     INCLUDEPATH+= /usr/local/cuda/include
     QMAKE_CXXFLAGS += -Wignored-qualifiers
+    LIBS += -lrt -lpthread
 #    QMAKE_CXX = clang++
 #    QMAKE_LINK = clang++
 }
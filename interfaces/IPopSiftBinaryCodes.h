@@ -0,0 +1,73 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IPOPSIFTBINARYCODES_H
+#define IPOPSIFTBINARYCODES_H
+
+#include <vector>
+
+#include "xpcf/api/IComponentIntrospect.h"
+#include "core/Messages.h"
+#include "datastructure/DescriptorBuffer.h"
+#include "datastructure/Image.h"
+#include "datastructure/Keypoint.h"
+
+namespace SolAR {
+namespace MODULES {
+namespace POPSIFT {
+
+/**
+ * @class IPopSiftBinaryCodes
+ * @brief <B>Computes 256-bit binary codes of the SIFT descriptors, matched by Hamming distance.</B>
+ * <TT>UUID: f0c0d891-aadc-40d0-af72-0b400375b2bb</TT>
+ *
+ * The codes are a TYPE_8U descriptor buffer of 32 bytes per descriptor, the i-th code being the embedding of the i-th
+ * descriptor. They are 16 times smaller than the float descriptors they are stored with.
+ */
+
+class XPCF_IGNORE IPopSiftBinaryCodes : virtual public org::bcom::xpcf::IComponentIntrospect
+{
+public:
+    IPopSiftBinaryCodes() = default;
+    virtual ~IPopSiftBinaryCodes() = default;
+
+    /// @brief extracts the features of an image and computes the binary codes of their descriptors.
+    /// @param[in] image, the image.
+    /// @param[out] keypoints, the detected keypoints.
+    /// @param[out] descriptors, their descriptors.
+    /// @param[out] codes, the binary codes of the descriptors.
+    /// @return FrameworkReturnCode::_SUCCESS if succeed, else FrameworkReturnCode::_ERROR_
+    virtual FrameworkReturnCode extractWithCodes(const SRef<datastructure::Image> image,
+                                                 std::vector<datastructure::Keypoint> & keypoints,
+                                                 SRef<datastructure::DescriptorBuffer> & descriptors,
+                                                 SRef<datastructure::DescriptorBuffer> & codes) = 0;
+
+    /// @brief computes the binary codes of SIFT descriptors (TYPE_32F or TYPE_8U), e.g. of a stored keyframe.
+    /// @return FrameworkReturnCode::_SUCCESS if succeed, else FrameworkReturnCode::_ERROR_
+    virtual FrameworkReturnCode encode(const SRef<datastructure::DescriptorBuffer> descriptors,
+                                       SRef<datastructure::DescriptorBuffer> & codes) = 0;
+};
+
+}
+}
+}
+
+XPCF_DEFINE_INTERFACE_TRAITS(SolAR::MODULES::POPSIFT::IPopSiftBinaryCodes,
+                             "f0c0d891-aadc-40d0-af72-0b400375b2bb",
+                             "IPopSiftBinaryCodes",
+                             "Binary codes of the SIFT descriptors");
+
+#endif // IPOPSIFTBINARYCODES_H
@@ -0,0 +1,75 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IPOPSIFTBINARYMATCHER_H
+#define IPOPSIFTBINARYMATCHER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "xpcf/api/IComponentIntrospect.h"
+#include "core/Messages.h"
+#include "datastructure/DescriptorBuffer.h"
+#include "datastructure/DescriptorMatch.h"
+
+namespace SolAR {
+namespace MODULES {
+namespace POPSIFT {
+
+/**
+ * @class IPopSiftBinaryMatcher
+ * @brief <B>Matches binary SIFT codes by Hamming distance, optionally re-ranking the nearest codes with the float descriptors.</B>
+ * <TT>UUID: 30b06dd6-2a25-4ff5-a49f-bf2c5a44dfa4</TT>
+ */
+
+class XPCF_IGNORE IPopSiftBinaryMatcher : virtual public org::bcom::xpcf::IComponentIntrospect
+{
+public:
+    IPopSiftBinaryMatcher() = default;
+    virtual ~IPopSiftBinaryMatcher() = default;
+
+    /// @brief matches each code of the first set to its nearest code in the second one.
+    /// @param[in] codes1, codes2, the binary codes (see IPopSiftBinaryCodes).
+    /// @param[out] matches, the matches (index 1, index 2, Hamming distance).
+    /// @return FrameworkReturnCode::_SUCCESS if succeed, else FrameworkReturnCode::_ERROR_
+    virtual FrameworkReturnCode matchCodes(const SRef<datastructure::DescriptorBuffer> codes1,
+                                           const SRef<datastructure::DescriptorBuffer> codes2,
+                                           std::vector<datastructure::DescriptorMatch> & matches) = 0;
+
+    /// @brief matches the codes, re-ranking the nearest codes of each query with the descriptors they come from.
+    /// @param[in] codes1, descriptors1, codes2, descriptors2, the codes and their descriptors.
+    /// @param[out] matches, the matches (index 1, index 2, L2 distance of the descriptors).
+    /// @return FrameworkReturnCode::_SUCCESS if succeed, else FrameworkReturnCode::_ERROR_
+    virtual FrameworkReturnCode matchCodes(const SRef<datastructure::DescriptorBuffer> codes1,
+                                           const SRef<datastructure::DescriptorBuffer> descriptors1,
+                                           const SRef<datastructure::DescriptorBuffer> codes2,
+                                           const SRef<datastructure::DescriptorBuffer> descriptors2,
+                                           std::vector<datastructure::DescriptorMatch> & matches) = 0;
+
+    /// @return the number of float descriptor distances computed by the last matching.
+    virtual uint64_t getNbFloatEvaluations() const = 0;
+};
+
+}
+}
+}
+
+XPCF_DEFINE_INTERFACE_TRAITS(SolAR::MODULES::POPSIFT::IPopSiftBinaryMatcher,
+                             "30b06dd6-2a25-4ff5-a49f-bf2c5a44dfa4",
+                             "IPopSiftBinaryMatcher",
+                             "Hamming matching of binary SIFT codes");
+
+#endif // IPOPSIFTBINARYMATCHER_H
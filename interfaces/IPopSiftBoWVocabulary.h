@@ -0,0 +1,99 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IPOPSIFTBOWVOCABULARY_H
+#define IPOPSIFTBOWVOCABULARY_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "xpcf/api/IComponentIntrospect.h"
+#include "core/Messages.h"
+#include "datastructure/DescriptorBuffer.h"
+
+namespace SolAR {
+namespace MODULES {
+namespace POPSIFT {
+
+/// @brief Sparse bag-of-words vector: (word id, weight) pairs sorted by word id, L1 normalized.
+using BoWVector = std::vector<std::pair<uint32_t, float>>;
+
+/**
+ * @class IPopSiftBoWVocabulary
+ * @brief <B>Quantizes SIFT descriptors on a hierarchical k-means vocabulary and scores images with an inverted file.</B>
+ * <TT>UUID: d484d0f1-6bc1-47f3-97e9-c4993abfc829</TT>
+ */
+
+class XPCF_IGNORE IPopSiftBoWVocabulary : virtual public org::bcom::xpcf::IComponentIntrospect
+{
+public:
+    IPopSiftBoWVocabulary() = default;
+    virtual ~IPopSiftBoWVocabulary() = default;
+
+    /// @brief quantizes all the descriptors of a buffer and computes their TF-IDF bag-of-words vector.
+    /// @param[in] descriptors, the SIFT descriptors (32F or 8U) as returned by the extractor. They are read in place.
+    /// @param[out] bow, the L1 normalized TF-IDF vector.
+    /// @param[out] words, the word id of each descriptor.
+    /// @return FrameworkReturnCode::_SUCCESS if succeed, else FrameworkReturnCode::_ERROR_
+    virtual FrameworkReturnCode transform(const SRef<datastructure::DescriptorBuffer> descriptors,
+                                          BoWVector & bow,
+                                          std::vector<uint32_t> & words) = 0;
+
+    /// @brief adds an image to the inverted file index.
+    /// @param[in] imageId, the identifier returned by query, e.g. a keyframe id.
+    /// @param[in] bow, the bag-of-words vector of the image.
+    /// @return FrameworkReturnCode::_SUCCESS if succeed, else FrameworkReturnCode::_ERROR_ if the id is already indexed
+    virtual FrameworkReturnCode addToIndex(uint32_t imageId, const BoWVector & bow) = 0;
+
+    /// @brief removes an image from the inverted file index.
+    /// @return FrameworkReturnCode::_SUCCESS if succeed, else FrameworkReturnCode::_ERROR_ if the id is unknown
+    virtual FrameworkReturnCode removeFromIndex(uint32_t imageId) = 0;
+
+    /// @brief removes all the images from the inverted file index.
+    virtual void clearIndex() = 0;
+
+    /// @brief scores the indexed images against a bag-of-words vector (L1 score in [0, 1]).
+    /// @param[in] bow, the query vector.
+    /// @param[out] results, (image id, score) pairs sorted by decreasing score.
+    /// @param[in] maxResults, maximum number of results, 0 for all the images sharing at least one word.
+    /// @return FrameworkReturnCode::_SUCCESS if succeed, else FrameworkReturnCode::_ERROR_
+    virtual FrameworkReturnCode query(const BoWVector & bow,
+                                      std::vector<std::pair<uint32_t, float>> & results,
+                                      uint32_t maxResults = 0) const = 0;
+
+    /// @brief scores two bag-of-words vectors (L1 score in [0, 1]).
+    virtual float score(const BoWVector & bow1, const BoWVector & bow2) const = 0;
+
+    /// @return the number of words (leaves) of the loaded vocabulary, 0 if no vocabulary is loaded.
+    virtual uint32_t getNbWords() const = 0;
+
+    /// @brief writes the loaded vocabulary in the binary mappable format.
+    /// @return FrameworkReturnCode::_SUCCESS if succeed, else FrameworkReturnCode::_ERROR_
+    virtual FrameworkReturnCode saveVocabulary(const std::string & path) const = 0;
+};
+
+}
+}
+}
+
+XPCF_DEFINE_INTERFACE_TRAITS(SolAR::MODULES::POPSIFT::IPopSiftBoWVocabulary,
+                             "d484d0f1-6bc1-47f3-97e9-c4993abfc829",
+                             "IPopSiftBoWVocabulary",
+                             "Quantizes SIFT descriptors on a hierarchical k-means vocabulary and scores images with an inverted file");
+
+#endif // IPOPSIFTBOWVOCABULARY_H
@@ -0,0 +1,80 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IPOPSIFTQUALITYCONTROL_H
+#define IPOPSIFTQUALITYCONTROL_H
+
+#include <cstdint>
+
+#include "xpcf/api/IComponentIntrospect.h"
+#include "core/Messages.h"
+
+namespace SolAR {
+namespace MODULES {
+namespace POPSIFT {
+
+/// @brief Detection settings driven by the quality controller.
+struct QualitySettings {
+    float threshold = 0.04f;        // Contrast min threshold
+    uint32_t maxKeypoints = 10000;  // Keypoint cap
+    uint32_t firstOctave = 0;       // Octaves skipped at the bottom of the pyramid, added to the configured downsampling
+};
+
+/// @brief Snapshot of the quality controller.
+struct QualityState {
+    bool enabled = false;
+    float targetLatency = 0.0f;     // Target extraction time per frame, in ms
+    float lastLatency = 0.0f;       // Extraction time of the last frame, in ms
+    float smoothedLatency = 0.0f;   // Exponential moving average of the extraction time, in ms
+    float detectionTime = 0.0f;     // Last detection and description time (upload, GPU, download), in ms
+    float conversionTime = 0.0f;    // Last conversion time to SolAR keypoints and descriptors, in ms
+    uint32_t lastNbKeypoints = 0;
+    QualitySettings settings;       // Settings applied to the next frame
+    uint64_t nbFrames = 0;
+    uint64_t nbFramesOverBudget = 0;
+    uint64_t nbAdjustments = 0;
+};
+
+/**
+ * @class IPopSiftQualityControl
+ * @brief <B>Trades keypoints for latency: adapts the detection settings between frames to meet a target extraction time.</B>
+ * <TT>UUID: b89cc819-9af7-4e8a-8fa0-58c8e9720148</TT>
+ */
+
+class XPCF_IGNORE IPopSiftQualityControl : virtual public org::bcom::xpcf::IComponentIntrospect
+{
+public:
+    IPopSiftQualityControl() = default;
+    virtual ~IPopSiftQualityControl() = default;
+
+    /// @brief sets the target extraction time per frame.
+    /// @param[in] targetLatency, in ms. 0 disables the controller and restores the configured settings.
+    virtual void setTargetLatency(float targetLatency) = 0;
+
+    /// @return the current state of the controller. Can be called from another thread than the extraction one.
+    virtual QualityState getQualityState() const = 0;
+};
+
+}
+}
+}
+
+XPCF_DEFINE_INTERFACE_TRAITS(SolAR::MODULES::POPSIFT::IPopSiftQualityControl,
+                             "b89cc819-9af7-4e8a-8fa0-58c8e9720148",
+                             "IPopSiftQualityControl",
+                             "Adapts the detection settings between frames to meet a target extraction time");
+
+#endif // IPOPSIFTQUALITYCONTROL_H
@@ -0,0 +1,87 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IPOPSIFTSTEREOMATCHER_H
+#define IPOPSIFTSTEREOMATCHER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "xpcf/api/IComponentIntrospect.h"
+#include "core/Messages.h"
+#include "datastructure/DescriptorBuffer.h"
+#include "datastructure/DescriptorMatch.h"
+#include "datastructure/Image.h"
+#include "datastructure/Keypoint.h"
+
+namespace SolAR {
+namespace MODULES {
+namespace POPSIFT {
+
+/**
+ * @class IPopSiftStereoMatcher
+ * @brief <B>Matches the images of a rectified stereo pair along the scanlines.</B>
+ * <TT>UUID: 2ffdbbdd-ab6c-41ab-8951-989851674e63</TT>
+ *
+ * A left keypoint is only compared to the right keypoints within rowTolerance rows and within the disparity range
+ * [minDisparity, maxDisparity], the disparity being x left - x right.
+ */
+
+class XPCF_IGNORE IPopSiftStereoMatcher : virtual public org::bcom::xpcf::IComponentIntrospect
+{
+public:
+    IPopSiftStereoMatcher() = default;
+    virtual ~IPopSiftStereoMatcher() = default;
+
+    /// @brief extracts the features of both images and matches them.
+    /// @param[in] left, right, the rectified images.
+    /// @param[out] leftKeypoints, rightKeypoints, the keypoints detected in each image.
+    /// @param[out] leftDescriptors, rightDescriptors, their descriptors.
+    /// @param[out] matches, the matches (left index, right index, L2 distance).
+    /// @param[out] disparities, the disparity of each match.
+    /// @return FrameworkReturnCode::_SUCCESS if succeed, else FrameworkReturnCode::_ERROR_
+    virtual FrameworkReturnCode matchStereo(const SRef<datastructure::Image> left,
+                                            const SRef<datastructure::Image> right,
+                                            std::vector<datastructure::Keypoint> & leftKeypoints,
+                                            std::vector<datastructure::Keypoint> & rightKeypoints,
+                                            SRef<datastructure::DescriptorBuffer> & leftDescriptors,
+                                            SRef<datastructure::DescriptorBuffer> & rightDescriptors,
+                                            std::vector<datastructure::DescriptorMatch> & matches,
+                                            std::vector<float> & disparities) = 0;
+
+    /// @brief matches features already extracted from a rectified pair, e.g. by an extractor of the module.
+    /// @return FrameworkReturnCode::_SUCCESS if succeed, else FrameworkReturnCode::_ERROR_
+    virtual FrameworkReturnCode matchRectified(const std::vector<datastructure::Keypoint> & leftKeypoints,
+                                               const SRef<datastructure::DescriptorBuffer> leftDescriptors,
+                                               const std::vector<datastructure::Keypoint> & rightKeypoints,
+                                               const SRef<datastructure::DescriptorBuffer> rightDescriptors,
+                                               std::vector<datastructure::DescriptorMatch> & matches,
+                                               std::vector<float> & disparities) = 0;
+
+    /// @return the number of descriptor distances computed by the last stereo matching.
+    virtual uint64_t getNbDistanceEvaluations() const = 0;
+};
+
+}
+}
+}
+
+XPCF_DEFINE_INTERFACE_TRAITS(SolAR::MODULES::POPSIFT::IPopSiftStereoMatcher,
+                             "2ffdbbdd-ab6c-41ab-8951-989851674e63",
+                             "IPopSiftStereoMatcher",
+                             "Matching of rectified stereo pairs along the scanlines");
+
+#endif // IPOPSIFTSTEREOMATCHER_H
@@ -0,0 +1,77 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IPOPSIFTWARMUP_H
+#define IPOPSIFTWARMUP_H
+
+#include <cstdint>
+
+#include "xpcf/api/IComponentIntrospect.h"
+#include "core/Messages.h"
+
+namespace SolAR {
+namespace MODULES {
+namespace POPSIFT {
+
+/// @brief Startup times of the last configuration of a component, in ms.
+struct StartupMetrics {
+    bool ready = false;             // the warm-up is done, the next frame runs at steady-state latency
+    bool failed = false;            // the warm-up threw, the frames fail until the next configuration
+    bool background = false;        // the warm-up ran on a background thread
+    bool contextReused = false;     // the detection context of the previous configuration was reconfigured, not recreated
+    float configureTime = 0.0f;     // time spent in onConfigured by the caller
+    float deviceQueryTime = 0.0f;   // query of the device properties, 0 once done by a previous configuration
+    float contextTime = 0.0f;       // creation or reconfiguration of the detection context
+    float primingTime = 0.0f;       // dummy job allocating the buffers of the expected image size
+    float readyTime = 0.0f;         // from the start of onConfigured to the end of the warm-up
+    float firstFrameWaitTime = 0.0f;    // time the first frame waited for the end of the warm-up
+    uint64_t nbConfigurations = 0;
+};
+
+/**
+ * @class IPopSiftWarmup
+ * @brief <B>Readiness of a component warming up in the background after its configuration.</B>
+ * <TT>UUID: 54d93553-d5bb-421f-92bd-4e3babbe5343</TT>
+ */
+
+class XPCF_IGNORE IPopSiftWarmup : virtual public org::bcom::xpcf::IComponentIntrospect
+{
+public:
+    IPopSiftWarmup() = default;
+    virtual ~IPopSiftWarmup() = default;
+
+    /// @return true once the warm-up of the last configuration is done. The frames given before wait for it.
+    virtual bool isReady() const = 0;
+
+    /// @brief waits for the end of the warm-up.
+    /// @param[in] timeout, in ms, negative to wait without limit.
+    /// @return true if the component is ready, false on timeout or if the warm-up failed.
+    virtual bool waitUntilReady(float timeout = -1.0f) = 0;
+
+    /// @return the startup times of the last configuration. Can be called from another thread than the extraction one.
+    virtual StartupMetrics getStartupMetrics() const = 0;
+};
+
+}
+}
+}
+
+XPCF_DEFINE_INTERFACE_TRAITS(SolAR::MODULES::POPSIFT::IPopSiftWarmup,
+                             "54d93553-d5bb-421f-92bd-4e3babbe5343",
+                             "IPopSiftWarmup",
+                             "Readiness and startup times of a component warming up in the background");
+
+#endif // IPOPSIFTWARMUP_H
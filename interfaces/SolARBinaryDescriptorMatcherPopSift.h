@@ -0,0 +1,84 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SolARBinaryDescriptorMatcherPopSift_H
+#define SolARBinaryDescriptorMatcherPopSift_H
+#include <vector>
+#include "IPopSiftBinaryMatcher.h"
+#include "SolARPopSiftAPI.h"
+#include "SolARPopSiftBinarySift.h"
+#include "xpcf/component/ConfigurableBase.h"
+
+namespace SolAR {
+namespace MODULES {
+namespace POPSIFT {
+
+/**
+ * @class SolARBinaryDescriptorMatcherPopSift
+ * @brief <B>Matches the binary SIFT codes of SolARDescriptorsExtractorFromImagePopSift by exhaustive Hamming search.</B>
+ * <TT>UUID: c0b8f18a-d581-4b03-8d96-2e4402fbc4b4</TT>
+ *
+ * The Hamming distances are computed with the AVX-512 VPOPCNTDQ, AVX2 or POPCNT kernels of the module, selected at
+ * runtime. When nbCandidates is greater than 1 and the descriptors are given, the nbCandidates nearest codes of each
+ * query are re-ranked with the L2 distance of their descriptors, which recovers most of the recall of float matching.
+ */
+
+class SOLARMODULEPOPSIFT_EXPORT_API SolARBinaryDescriptorMatcherPopSift : public org::bcom::xpcf::ConfigurableBase,
+    public IPopSiftBinaryMatcher
+{
+public:
+    ///@brief SolARBinaryDescriptorMatcherPopSift constructor;
+    SolARBinaryDescriptorMatcherPopSift();
+    ///@brief SolARBinaryDescriptorMatcherPopSift destructor;
+    ~SolARBinaryDescriptorMatcherPopSift() = default;
+
+    org::bcom::xpcf::XPCFErrorCode onConfigured() override final;
+
+    FrameworkReturnCode matchCodes(const SRef<datastructure::DescriptorBuffer> codes1,
+                                   const SRef<datastructure::DescriptorBuffer> codes2,
+                                   std::vector<datastructure::DescriptorMatch> & matches) override;
+
+    FrameworkReturnCode matchCodes(const SRef<datastructure::DescriptorBuffer> codes1,
+                                   const SRef<datastructure::DescriptorBuffer> descriptors1,
+                                   const SRef<datastructure::DescriptorBuffer> codes2,
+                                   const SRef<datastructure::DescriptorBuffer> descriptors2,
+                                   std::vector<datastructure::DescriptorMatch> & matches) override;
+
+    uint64_t getNbFloatEvaluations() const override { return m_matcher.getNbFloatEvaluations(); }
+
+    void unloadComponent () override final;
+
+private:
+    uint32_t m_nbCandidates = 0;        // Nearest codes re-ranked with the descriptors, 0 or 1 for a Hamming only matching
+    float m_ratio = 0.8f;               // Ratio test of the best over the second best distance, 1 to disable it
+    uint32_t m_maxHammingDistance = 0;  // Largest Hamming distance of a match, 0 for no limit
+
+    BinarySiftMatcher m_matcher;
+};
+
+}
+}
+}
+
+template <> struct org::bcom::xpcf::ComponentTraits<SolAR::MODULES::POPSIFT::SolARBinaryDescriptorMatcherPopSift>
+{
+
+    static constexpr const char * UUID = "{c0b8f18a-d581-4b03-8d96-2e4402fbc4b4}";
+    static constexpr const char * NAME = "SolARBinaryDescriptorMatcherPopSift";
+    static constexpr const char * DESCRIPTION = "SolARBinaryDescriptorMatcherPopSift implements SolAR::MODULES::POPSIFT::IPopSiftBinaryMatcher interface";
+};
+
+#endif // SolARBinaryDescriptorMatcherPopSift_H
@@ -0,0 +1,128 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SolARBoWVocabularyPopSift_H
+#define SolARBoWVocabularyPopSift_H
+#include <map>
+#include <memory>
+#include <vector>
+#include "IPopSiftBoWVocabulary.h"
+#include "SolARPopSiftAPI.h"
+#include "SolARPopSiftTaskScheduler.h"
+#include "xpcf/component/ConfigurableBase.h"
+
+namespace SolAR {
+namespace MODULES {
+namespace POPSIFT {
+
+/**
+ * @class SolARBoWVocabularyPopSift
+ * @brief <B>Quantizes SIFT descriptors on a hierarchical k-means vocabulary and scores images with an inverted file.</B>
+ * <TT>UUID: ce660d6d-1f68-42da-a211-85175afc9d91</TT>
+ *
+ * The vocabulary is loaded from a binary file (.psvoc) which is memory mapped, or imported from a DBoW2 text vocabulary (.txt)
+ * built on float SIFT descriptors. Descriptor buffers are quantized in blocks processed level by level, so that the centroids of
+ * a node stay in cache while all the descriptors of the block reaching that node are compared to them. The blocks are
+ * quantized by a task scheduler created at configuration, its workers being kept from one call to the next.
+ *
+ * Binary format (little endian): a 64 bytes header, then nbNodes nodes {firstChild, nbChildren, wordId, reserved} (4 x uint32),
+ * then nbNodes x descriptorLength float centroids, then nbWords float idf weights. Sections start on 64 bytes boundaries.
+ * The children of a node are contiguous, node 0 is the root.
+ */
+
+class SOLARMODULEPOPSIFT_EXPORT_API SolARBoWVocabularyPopSift : public org::bcom::xpcf::ConfigurableBase,
+    public IPopSiftBoWVocabulary
+{
+public:
+    ///@brief SolARBoWVocabularyPopSift constructor;
+    SolARBoWVocabularyPopSift();
+    ///@brief SolARBoWVocabularyPopSift destructor;
+    ~SolARBoWVocabularyPopSift();
+
+    org::bcom::xpcf::XPCFErrorCode onConfigured() override final;
+
+    FrameworkReturnCode transform(const SRef<datastructure::DescriptorBuffer> descriptors,
+                                  BoWVector & bow,
+                                  std::vector<uint32_t> & words) override;
+
+    FrameworkReturnCode addToIndex(uint32_t imageId, const BoWVector & bow) override;
+
+    FrameworkReturnCode removeFromIndex(uint32_t imageId) override;
+
+    void clearIndex() override;
+
+    FrameworkReturnCode query(const BoWVector & bow,
+                              std::vector<std::pair<uint32_t, float>> & results,
+                              uint32_t maxResults = 0) const override;
+
+    float score(const BoWVector & bow1, const BoWVector & bow2) const override;
+
+    uint32_t getNbWords() const override { return m_nbWords; }
+
+    FrameworkReturnCode saveVocabulary(const std::string & path) const override;
+
+    void unloadComponent () override final;
+
+    struct VocabularyNode {
+        uint32_t firstChild;
+        uint32_t nbChildren;
+        int32_t wordId;     // -1 for internal nodes
+        uint32_t reserved;
+    };
+
+private:
+    bool loadBinary(const std::string & path);
+    bool loadText(const std::string & path);
+    void release();
+    void quantizeBlock(const float * descriptors, uint32_t nbDescriptors, uint32_t * words) const;
+
+    std::string m_vocabularyPath = "";
+    int m_nbThreads = 0;                // Number of quantization threads, 0 for the number of hardware threads
+    uint32_t m_blockSize = 256;         // Number of descriptors quantized together
+
+    // vocabulary, either memory mapped or owned by the storage vectors
+    const VocabularyNode * m_nodes = nullptr;
+    const float * m_centroids = nullptr;
+    const float * m_weights = nullptr;
+    uint32_t m_descriptorLength = 0;
+    uint32_t m_nbNodes = 0;
+    uint32_t m_nbWords = 0;
+    void * m_mapping = nullptr;
+    std::size_t m_mappingSize = 0;
+    std::vector<VocabularyNode> m_nodeStorage;
+    std::vector<float> m_centroidStorage;
+    std::vector<float> m_weightStorage;
+
+    std::unique_ptr<TaskScheduler> m_scheduler;
+
+    // inverted file: for each word, the (image id, weight) of the images containing it
+    std::vector<std::vector<std::pair<uint32_t, float>>> m_invertedFile;
+    std::map<uint32_t, BoWVector> m_indexedImages;
+};
+
+}
+}
+}
+
+template <> struct org::bcom::xpcf::ComponentTraits<SolAR::MODULES::POPSIFT::SolARBoWVocabularyPopSift>
+{
+
+    static constexpr const char * UUID = "{ce660d6d-1f68-42da-a211-85175afc9d91}";
+    static constexpr const char * NAME = "SolARBoWVocabularyPopSift";
+    static constexpr const char * DESCRIPTION = "SolARBoWVocabularyPopSift implements SolAR::MODULES::POPSIFT::IPopSiftBoWVocabulary interface";
+};
+
+#endif // SolARBoWVocabularyPopSift_H
@@ -0,0 +1,85 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SolARDescriptorsExtractorFromImageClientPopSift_H
+#define SolARDescriptorsExtractorFromImageClientPopSift_H
+#include <vector>
+#include "api/features/IDescriptorsExtractorFromImage.h"
+#include "SolARPopSiftAPI.h"
+#include "SolARPopSiftExtractionChannel.h"
+#include "xpcf/component/ConfigurableBase.h"
+
+namespace SolAR {
+namespace MODULES {
+namespace POPSIFT {
+
+/**
+ * @class SolARDescriptorsExtractorFromImageClientPopSift
+ * @brief <B>Extracts keypoints and descriptors through a PopSift extraction server of the same machine.</B>
+ * <TT>UUID: b0331a90-4725-4548-8695-d2ac503e25a4</TT>
+ *
+ * Images and results are exchanged through the shared memory rings of the server (see SolARPopSiftExtractionServer),
+ * so that all the processes of the machine share a single PopSift context.
+ */
+
+class SOLARMODULEPOPSIFT_EXPORT_API SolARDescriptorsExtractorFromImageClientPopSift : public org::bcom::xpcf::ConfigurableBase,
+    public api::features::IDescriptorsExtractorFromImage
+{
+public:
+    ///@brief SolARDescriptorsExtractorFromImageClientPopSift constructor;
+    SolARDescriptorsExtractorFromImageClientPopSift();
+    ///@brief SolARDescriptorsExtractorFromImageClientPopSift destructor;
+    ~SolARDescriptorsExtractorFromImageClientPopSift() = default;
+
+    org::bcom::xpcf::XPCFErrorCode onConfigured() override final;
+
+    ///
+    /// @brief getType
+    /// @return a string describing the type of descriptor used during extraction.
+    ///
+    std::string getTypeString() override { return std::string("DescriptorsExtractorType::SIFT"); }
+
+    /// @brief extracts keypoints and descriptors through the extraction server.
+    /// @param[in] image, image on which the keypoint and their descriptor will be detected and extracted.
+    /// @param[out] keypoints, The keypoints detected in the input image.
+    /// @param[out] descriptors, The descriptors of keypoint of the input image.
+    /// @return FrameworkReturnCode::_SUCCESS_ if succeed, else FrameworkReturnCode::_ERROR
+    FrameworkReturnCode extract (const SRef<SolAR::datastructure::Image> image,
+                                 std::vector<SolAR::datastructure::Keypoint> &keypoints,
+                                 SRef<SolAR::datastructure::DescriptorBuffer> & descriptors) override;
+
+    void unloadComponent () override final;
+
+private:
+    std::string m_serverName = "/solar_popsift";   // Shared memory segment of the server
+    uint32_t m_timeout = 5000;                      // Maximum time to wait for a result, in ms
+
+    ExtractionClient m_client;
+};
+
+}
+}
+}
+
+template <> struct org::bcom::xpcf::ComponentTraits<SolAR::MODULES::POPSIFT::SolARDescriptorsExtractorFromImageClientPopSift>
+{
+
+    static constexpr const char * UUID = "{b0331a90-4725-4548-8695-d2ac503e25a4}";
+    static constexpr const char * NAME = "SolARDescriptorsExtractorFromImageClientPopSift";
+    static constexpr const char * DESCRIPTION = "SolARDescriptorsExtractorFromImageClientPopSift implements SolAR::api::features::IDescriptorsExtractorFromImage interface";
+};
+
+#endif // SolARDescriptorsExtractorFromImageClientPopSift_H
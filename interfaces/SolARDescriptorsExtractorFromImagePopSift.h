@@ -31,8 +31,17 @@
 #ifndef SolARDescriptorsExtractorFromImagePopSift_H
 #define SolARDescriptorsExtractorFromImagePopSift_H
 #include <vector>
+#include "api/features/IDescriptorsExtractor.h"
 #include "api/features/IDescriptorsExtractorFromImage.h"
+#include "api/features/IKeypointDetector.h"
+#include "IPopSiftBinaryCodes.h"
+#include "IPopSiftQualityControl.h"
+#include "IPopSiftWarmup.h"
 #include "SolARPopSiftAPI.h"
+#include "SolARPopSiftBinarySift.h"
+#include "SolARPopSiftDenseSift.h"
+#include "SolARPopSiftQualityController.h"
+#include "SolARPopSiftWarmup.h"
 #include "xpcf/component/ConfigurableBase.h"
 
 #include <popsift/popsift.h>
@@ -49,7 +58,12 @@ namespace POPSIFT {
  */
 
 class SOLARMODULEPOPSIFT_EXPORT_API SolARDescriptorsExtractorFromImagePopSift : public org::bcom::xpcf::ConfigurableBase,
-    public api::features::IDescriptorsExtractorFromImage
+    public api::features::IDescriptorsExtractorFromImage,
+    public api::features::IKeypointDetector,
+    public api::features::IDescriptorsExtractor,
+    public IPopSiftQualityControl,
+    public IPopSiftWarmup,
+    public IPopSiftBinaryCodes
 {
 public:
     ///@brief SolARDescriptorsExtractorFromImagePopSift constructor;
@@ -74,9 +88,72 @@ public:
                                          std::vector<SolAR::datastructure::Keypoint> &keypoints,
                                          SRef<SolAR::datastructure::DescriptorBuffer> & descriptors) override;
 
+    /// @brief only SIFT keypoints are detected.
+    void setType(api::features::KeypointDetectorType type) override;
+
+    /// @return KeypointDetectorType::SIFT
+    api::features::KeypointDetectorType getType() override { return api::features::KeypointDetectorType::SIFT; }
+
+    /// @brief detects keypoints without converting their descriptors. The detection stays resident until the next
+    /// one, so that the descriptors of the keypoints kept by the caller are then computed by extract(image, keypoints, descriptors).
+    /// @param[in] image, image on which the keypoints are detected.
+    /// @param[out] keypoints, The keypoints detected in the input image.
+    void detect(const SRef<SolAR::datastructure::Image> image,
+                std::vector<SolAR::datastructure::Keypoint> & keypoints) override;
+
+    /// @brief computes the descriptors of a subset of the keypoints returned by detect() on the same image.
+    /// In dense mode, any keypoint can be described; the grid pyramid is rebuilt if the image changed.
+    /// @param[in] image, image given to detect().
+    /// @param[in] inputKeypoints, the keypoints to describe, as returned by detect() (their id is used).
+    /// @param[out] descriptors, The descriptors of the input keypoints, in the same order.
+    void extract(const SRef<SolAR::datastructure::Image> image,
+                 const std::vector<SolAR::datastructure::Keypoint> & inputKeypoints,
+                 SRef<SolAR::datastructure::DescriptorBuffer> & descriptors) override;
+
+    /// @brief sets the target extraction time per frame of the detector mode.
+    /// @param[in] targetLatency, in ms. 0 disables the quality controller and restores the configured settings.
+    void setTargetLatency(float targetLatency) override;
+
+    /// @return the current state of the quality controller.
+    QualityState getQualityState() const override;
+
+    /// @return true once the context of the last configuration is created and primed.
+    bool isReady() const override;
+
+    /// @brief waits for the end of the warm-up started by the last configuration.
+    /// @param[in] timeout, in ms, negative to wait without limit.
+    bool waitUntilReady(float timeout = -1.0f) override;
+
+    /// @return the startup times of the last configuration.
+    StartupMetrics getStartupMetrics() const override;
+
+    /// @brief extracts the features of an image and the binary codes of their descriptors.
+    /// Requires binaryProjection to be set.
+    FrameworkReturnCode extractWithCodes(const SRef<SolAR::datastructure::Image> image,
+                                         std::vector<SolAR::datastructure::Keypoint> & keypoints,
+                                         SRef<SolAR::datastructure::DescriptorBuffer> & descriptors,
+                                         SRef<SolAR::datastructure::DescriptorBuffer> & codes) override;
+
+    /// @brief computes the binary codes of descriptors with the configured projection.
+    FrameworkReturnCode encode(const SRef<SolAR::datastructure::DescriptorBuffer> descriptors,
+                               SRef<SolAR::datastructure::DescriptorBuffer> & codes) override;
+
     void unloadComponent () override final;
 
 private:
+    bool checkImage(const SRef<SolAR::datastructure::Image> image) const;
+    popsift::FeaturesHost * detectPopSift(const SRef<SolAR::datastructure::Image> image,
+                                          std::vector<SolAR::datastructure::Keypoint> & keypoints,
+                                          std::vector<const popsift::Descriptor *> * keypointDescriptors,
+                                          float & detectionTime);
+    void releaseDetection();
+    void applyQualitySettings(const QualitySettings & settings);
+    bool configurePopSift();
+    void createPopSift();
+    bool waitForWarmup();
+    void primePopSift();
+    void primeDenseSift();
+
     PopSift* m_popSift;
     popsift::Config config;
 
@@ -91,7 +168,10 @@ private:
     float m_downsampling = 0.0f;   // Downscale width and height of input by 2^N, Use original image, or perform an upscale if == -1
     float m_initialBlur = 0.0f;    // Assume initial blur, subtract when blurring first time
 
+    std::string m_normMode = "RootSift";    // "Classic" also possible, see m_rootSift
     bool m_rootSift = true;         // True, use RootSift(The L1-inspired norm, gives better matching results), otherwise classic (The L2-inspired norm, all descriptors on a hypersphere)
+    std::string m_descriptorType = "Float"; // "Unsigned Char" also possible for dense detection
+    kernels::InputType m_inputType = kernels::InputType::Float;    // imageMode, resolved when configured
 
     int m_numScales = 3; // Scales per octave
     float m_edgeThreshold = 10.0f; // Max ratio of Hessian eigenvalues
@@ -101,6 +181,39 @@ private:
     std::size_t _gridSize = 4;
     uint32_t m_maxTotalKeypoints = 10000;
 
+    std::string m_detection = "detector";   // "dense" computes descriptors on a regular grid, on CPU
+    int m_denseStride = 8;                  // Grid step in pixels for dense detection
+    std::vector<float> m_denseScales = { 1.6f, 3.2f }; // Descriptor scales (sigma in pixels) for dense detection
+    int m_nbThreads = 0;                    // Workers of the CPU dense extraction, 0 for the number of hardware threads
+    int m_pinWorkers = 0;                   // 1 pins the workers of the CPU dense extraction to CPUs
+    bool m_denseDetection = false;
+    DenseSift m_denseSift;
+
+    float m_targetLatency = 0.0f;           // Target extraction time per frame in ms, 0 disables the quality controller
+    float m_maxThreshold = 0.12f;           // Highest contrast threshold set by the quality controller
+    uint32_t m_minTotalKeypoints = 500;     // Lowest keypoint cap set by the quality controller
+    int m_maxFirstOctave = 2;               // Highest number of bottom octaves skipped by the quality controller
+    float m_baseDownsampling = -1.0f;       // Configured downsampling the skipped octaves are added to
+    QualitySettings m_appliedSettings;
+    QualityController m_qualityController;
+
+    int m_asyncWarmup = 1;                  // Creates and primes the context in the background, onConfigured returning immediately
+    uint32_t m_warmupWidth = 640;           // Size of the dummy image priming the buffers, 0 disables the priming
+    uint32_t m_warmupHeight = 480;
+    Warmup m_warmup;
+    bool m_deviceQueried = false;           // the device properties are queried once
+    kernels::InputType m_contextInputType = kernels::InputType::Float; // image type of the PopSift context
+
+    std::string m_binaryProjection = "";    // Projection of the binary codes: "random", or a file of learned directions. Empty disables the codes
+    uint32_t m_binarySeed = 1;              // Seed of the random projection
+    BinarySiftEmbedding m_binaryEmbedding;
+
+    // resident detection of the two-phase API
+    popsift::FeaturesHost * m_detectedFeatures = nullptr;
+    SRef<SolAR::datastructure::Image> m_detectedImage;
+    std::vector<SolAR::datastructure::Keypoint> m_detectedKeypoints;
+    std::vector<const popsift::Descriptor *> m_detectedDescriptors;
+
 };
 
 }
@@ -32,7 +32,12 @@
 #define SolARImageMatcherPopSift_H
 #include <vector>
 #include "api/features/IImageMatcher.h"
+#include "IPopSiftStereoMatcher.h"
+#include "IPopSiftWarmup.h"
 #include "SolARPopSiftAPI.h"
+#include "SolARPopSiftDescriptorKernels.h"
+#include "SolARPopSiftStereoMatcher.h"
+#include "SolARPopSiftWarmup.h"
 #include "xpcf/component/ConfigurableBase.h"
 
 #include <popsift/popsift.h>
@@ -46,10 +51,14 @@ namespace POPSIFT {
  * @brief <B>find the matches between two input images.</B>
  * <TT>UUID: 3baab95a-ad25-11eb-8529-0242ac130003</TT>
  *
+ * With matchingMode set to "stereo", the images are a rectified pair: the features are matched on the CPU along the
+ * scanlines (see RectifiedStereoMatcher) instead of all pairs on the GPU.
  */
 
 class SOLARMODULEPOPSIFT_EXPORT_API SolARImageMatcherPopSift : public org::bcom::xpcf::ConfigurableBase,
-    public api::features::IImageMatcher
+    public api::features::IImageMatcher,
+    public IPopSiftWarmup,
+    public IPopSiftStereoMatcher
 {
 public:
     ///@brief SolARImageMatcherPopSift constructor;
@@ -82,9 +91,45 @@ public:
                                SRef<datastructure::DescriptorBuffer> descriptors2,
                                std::vector<datastructure::DescriptorMatch> & matches) override;
 
+    /// @brief extracts both images of a rectified pair and matches them along the scanlines.
+    FrameworkReturnCode matchStereo(const SRef<datastructure::Image> left,
+                                    const SRef<datastructure::Image> right,
+                                    std::vector<datastructure::Keypoint> & leftKeypoints,
+                                    std::vector<datastructure::Keypoint> & rightKeypoints,
+                                    SRef<datastructure::DescriptorBuffer> & leftDescriptors,
+                                    SRef<datastructure::DescriptorBuffer> & rightDescriptors,
+                                    std::vector<datastructure::DescriptorMatch> & matches,
+                                    std::vector<float> & disparities) override;
+
+    /// @brief matches features already extracted from a rectified pair along the scanlines.
+    FrameworkReturnCode matchRectified(const std::vector<datastructure::Keypoint> & leftKeypoints,
+                                       const SRef<datastructure::DescriptorBuffer> leftDescriptors,
+                                       const std::vector<datastructure::Keypoint> & rightKeypoints,
+                                       const SRef<datastructure::DescriptorBuffer> rightDescriptors,
+                                       std::vector<datastructure::DescriptorMatch> & matches,
+                                       std::vector<float> & disparities) override;
+
+    /// @return the number of descriptor distances computed by the last stereo matching.
+    uint64_t getNbDistanceEvaluations() const override;
+
+    /// @return true once the context of the last configuration is created and primed.
+    bool isReady() const override;
+
+    /// @brief waits for the end of the warm-up started by the last configuration.
+    /// @param[in] timeout, in ms, negative to wait without limit.
+    bool waitUntilReady(float timeout = -1.0f) override;
+
+    /// @return the startup times of the last configuration.
+    StartupMetrics getStartupMetrics() const override;
+
     void unloadComponent () override final;
 
 private:
+    void createPopSift();
+    void primePopSift();
+    bool checkImages(const SRef<datastructure::Image> image1, const SRef<datastructure::Image> image2) const;
+    bool waitForWarmup();
+
     PopSift* m_popSift;
     popsift::Config config;
 
@@ -99,7 +144,9 @@ private:
     float m_downsampling = 0.0f;   // Downscale width and height of input by 2^N, Use original image, or perform an upscale if == -1
     float m_initialBlur = 0.0f;    // Assume initial blur, subtract when blurring first time
 
+    std::string m_normMode = "RootSift";    // "Classic" also possible, see m_rootSift
     bool m_rootSift = true;         // True, use RootSift(The L1-inspired norm, gives better matching results), otherwise classic (The L2-inspired norm, all descriptors on a hypersphere)
+    kernels::InputType m_inputType = kernels::InputType::Float;    // imageMode, resolved when configured
 
     int m_numScales = 3; // Scales per octave
     float m_edgeThreshold = 10.0f; // Max ratio of Hessian eigenvalues
@@ -109,6 +156,23 @@ private:
     std::size_t _gridSize = 4;
     uint32_t m_maxTotalKeypoints = 10000;
 
+    std::string m_matchingMode = "all";     // "stereo" for rectified pairs
+    bool m_stereo = false;
+    float m_rowTolerance = 2.0f;            // Rows searched above and below a left keypoint in stereo mode
+    float m_minDisparity = 0.0f;            // Disparity range of the stereo rig, disparity = x left - x right
+    float m_maxDisparity = 128.0f;
+    float m_stereoRatio = 0.8f;             // Ratio test of the stereo matches, 1 disables it
+    float m_stereoMaxDistance = 0.0f;       // Largest descriptor distance of a stereo match, 0 for no limit
+    RectifiedStereoMatcher m_stereoMatcher;
+
+    int m_asyncWarmup = 1;                  // Creates and primes the context in the background, onConfigured returning immediately
+    uint32_t m_warmupWidth = 640;           // Size of the dummy images priming the buffers, 0 disables the priming
+    uint32_t m_warmupHeight = 480;
+    Warmup m_warmup;
+    bool m_deviceQueried = false;           // the device properties are queried once
+    kernels::InputType m_contextInputType = kernels::InputType::Float; // image type of the PopSift context
+    bool m_contextStereo = false;           // the PopSift context extracts (stereo) or matches on the GPU
+
 };
 
 }
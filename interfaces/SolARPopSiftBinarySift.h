@@ -0,0 +1,150 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOLARPOPSIFTBINARYSIFT_H
+#define SOLARPOPSIFTBINARYSIFT_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "xpcf/core/refs.h"
+
+#include "SolARPopSiftAPI.h"
+#include "SolARPopSiftDescriptorKernels.h"
+#include "core/Messages.h"
+#include "datastructure/DescriptorBuffer.h"
+#include "datastructure/DescriptorMatch.h"
+
+namespace SolAR {
+namespace MODULES {
+namespace POPSIFT {
+
+/**
+ * @class BinarySiftEmbedding
+ * @brief <B>Embeds SIFT descriptors into 256-bit binary codes.</B>
+ *
+ * Bit k of a code is set when the projection of the descriptor on the k-th direction exceeds the k-th threshold, so
+ * that the Hamming distance between codes approximates the angle between descriptors. The directions are either random
+ * (seeded gaussian hyperplanes with a zero sum, which ignore the positive offset all SIFT descriptors share) or learned
+ * offline and loaded from a file. train() sets the thresholds to the median projections of sample descriptors, each bit
+ * then splitting the sample in two halves.
+ *
+ * The codes are stored as DescriptorBuffer of TYPE_8U and 32 bytes, indexed like the descriptors they come from, bit k
+ * being bit k % 64 of the little endian 64-bit word k / 64.
+ *
+ * File format (text): "256 128", then one line per bit: the 128 coefficients of its direction and its threshold.
+ */
+class SOLARMODULEPOPSIFT_EXPORT_API BinarySiftEmbedding
+{
+public:
+    static constexpr uint32_t nbBits = 256;
+    static constexpr uint32_t nbWords = nbBits / 64;
+    static constexpr uint32_t codeSize = nbBits / 8;    // in bytes
+    static constexpr uint32_t descriptorLength = 128;
+
+    BinarySiftEmbedding() = default;
+
+    /// @brief draws random directions, the thresholds being set to 0.
+    void setRandom(uint32_t seed);
+
+    /// @brief loads learned directions and thresholds.
+    /// @return false if the file cannot be read or has a wrong size, the embedding being left unchanged.
+    bool load(const std::string & path);
+
+    /// @brief writes the directions and the thresholds in the text format.
+    bool save(const std::string & path) const;
+
+    /// @brief sets the thresholds to the median projections of sample descriptors.
+    void train(const float * descriptors, std::size_t nbDescriptors);
+
+    bool isValid() const { return !m_directions.empty(); }
+
+    /// @brief computes the codes of nbDescriptors contiguous float descriptors.
+    void encode(const float * descriptors, std::size_t nbDescriptors, uint64_t * codes) const;
+
+    /// @brief computes the codes of a buffer of SIFT descriptors (TYPE_32F or TYPE_8U).
+    /// @param[out] codes, a TYPE_8U buffer of 32 bytes per descriptor.
+    /// @return FrameworkReturnCode::_SUCCESS if succeed, else FrameworkReturnCode::_ERROR_
+    FrameworkReturnCode encode(const SRef<datastructure::DescriptorBuffer> descriptors, SRef<datastructure::DescriptorBuffer> & codes) const;
+
+private:
+    std::vector<float> m_directions;    // descriptorLength x nbBits, transposed so that the projections are accumulated together
+    std::vector<float> m_thresholds;    // nbBits
+};
+
+/// @brief Hamming search parameters.
+struct BinaryMatcherConfig {
+    uint32_t nbCandidates = 0;          // Nearest codes re-ranked with the float descriptors, less than 2 for a Hamming only matching
+    float ratio = 0.8f;                 // Best over second best distance (Hamming, or L2 when re-ranking), 1 keeps every best candidate
+    uint32_t maxHammingDistance = 0;    // Largest Hamming distance of a match or of a candidate, 0 for no limit
+};
+
+/**
+ * @class BinarySiftMatcher
+ * @brief <B>Matches binary SIFT codes by exhaustive Hamming search, optionally re-ranking the nearest codes with the float descriptors.</B>
+ *
+ * The distances of a query code to all the codes of the second set are computed by the popcount kernels of the module,
+ * 32 bytes being read per code instead of 512 for a float descriptor. When re-ranking, the nbCandidates nearest codes are
+ * selected from the histogram of the distances, and only their float descriptors are compared to the query one.
+ * The matching score is the Hamming distance, or the L2 distance of the descriptors when re-ranking.
+ */
+class SOLARMODULEPOPSIFT_EXPORT_API BinarySiftMatcher
+{
+public:
+    BinarySiftMatcher() = default;
+    explicit BinarySiftMatcher(const BinaryMatcherConfig & config) : m_config(config) {}
+
+    void setConfig(const BinaryMatcherConfig & config) { m_config = config; }
+    const BinaryMatcherConfig & getConfig() const { return m_config; }
+
+    /// @brief matches each code of the first buffer to the nearest code of the second one.
+    /// @return FrameworkReturnCode::_SUCCESS if succeed, else FrameworkReturnCode::_ERROR_
+    FrameworkReturnCode match(const SRef<datastructure::DescriptorBuffer> codes1,
+                              const SRef<datastructure::DescriptorBuffer> codes2,
+                              std::vector<datastructure::DescriptorMatch> & matches);
+
+    /// @brief same as above, re-ranking the nearest codes with the descriptors (TYPE_32F or TYPE_8U) they come from.
+    FrameworkReturnCode match(const SRef<datastructure::DescriptorBuffer> codes1,
+                              const SRef<datastructure::DescriptorBuffer> descriptors1,
+                              const SRef<datastructure::DescriptorBuffer> codes2,
+                              const SRef<datastructure::DescriptorBuffer> descriptors2,
+                              std::vector<datastructure::DescriptorMatch> & matches);
+
+    /// @brief matches raw codes, re-ranking with the descriptors if they are given.
+    void match(const uint64_t * codes1, std::size_t nbCodes1, const uint64_t * codes2, std::size_t nbCodes2,
+               const void * descriptors1, const void * descriptors2, kernels::DescriptorType descriptorType,
+               std::vector<datastructure::DescriptorMatch> & matches);
+
+    /// @return the number of float descriptor distances computed by the last match.
+    uint64_t getNbFloatEvaluations() const { return m_nbFloatEvaluations; }
+
+private:
+    void selectCandidates(uint32_t nbCandidates, uint32_t maxDistance);
+
+    BinaryMatcherConfig m_config;
+    std::vector<uint32_t> m_distances;
+    std::vector<uint32_t> m_candidates;
+    std::array<uint32_t, BinarySiftEmbedding::nbBits + 1> m_histogram;
+    uint64_t m_nbFloatEvaluations = 0;
+};
+
+}
+}
+}
+
+#endif // SOLARPOPSIFTBINARYSIFT_H
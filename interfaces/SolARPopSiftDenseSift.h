@@ -0,0 +1,215 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOLARPOPSIFTDENSESIFT_H
+#define SOLARPOPSIFTDENSESIFT_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "SolARPopSiftAPI.h"
+#include "SolARPopSiftDescriptorKernels.h"
+#include "SolARPopSiftTaskScheduler.h"
+#include "core/Messages.h"
+#include "datastructure/Image.h"
+#include "datastructure/Keypoint.h"
+#include "datastructure/DescriptorBuffer.h"
+
+namespace SolAR {
+namespace MODULES {
+namespace POPSIFT {
+
+/// @brief Parameters of the CPU dense SIFT extraction.
+struct DenseSiftConfig {
+    float sigma = 1.6f;                         // Blur of the octave bases
+    float initialBlur = 0.5f;                   // Blur assumed in the input image
+    int stride = 8;                             // Grid step, in input image pixels
+    std::vector<float> scales = { 1.6f, 3.2f }; // Descriptor scales (sigma, in input image pixels)
+    kernels::NormMode normMode = kernels::NormMode::RootSift;
+    kernels::DescriptorType descriptorType = kernels::DescriptorType::Float;   // TYPE_32F or TYPE_8U descriptors
+    uint32_t nbThreads = 1;                     // Workers of the task scheduler, 0 for the number of hardware threads
+    bool pinWorkers = false;                    // Pin the workers of the task scheduler to CPUs
+    uint32_t tileHeight = 32;                   // Rows of a task of the pyramid and of the description
+};
+
+/**
+ * @class DenseSift
+ * @brief <B>Computes upright SIFT descriptors on a regular grid from a Gaussian pyramid, on CPU.</B>
+ *
+ * No DoG extrema detection nor orientation assignment is done. The pyramid is built one level per scale.
+ * The one-shot extract() streams the levels: each strip of grid rows blurs, differentiates and describes only the
+ * rows it reads, in scratch planes taken from a pool of one per busy worker, so that its memory does not depend on
+ * the number of scales. The octave bases are kept from one image to the next, an octave holding up to 3 float planes
+ * at its resolution (base, blurred base and blur temporary), plus about 4 planes of a strip per worker. With the
+ * default scales, a 640x480 image keeps about 4 MB resident.
+ * detect() keeps the gradients of every level resident until the next image, so that the descriptors of a subset of
+ * keypoints can be computed by describe(): a level adds up to 4 planes (blurred image, blur temporary, gradient
+ * magnitude and orientation), about 9.5 MB in all with the default scales. They are released by the next extract().
+ * The work is split into tasks per octave, level and band (or strip) of rows, each depending on the bands of the
+ * previous stage it reads, and run by a work-stealing scheduler: the description of the coarse levels starts while
+ * the first octave, which holds most of the work, is still blurred. The strips recompute the rows within the support
+ * of their neighbours, and the results do not depend on the number of threads nor on the path.
+ * The pixel conversion and the descriptor normalization are the kernels specialized for the configuration and the
+ * input image type, selected once per image layout.
+ */
+class SOLARMODULEPOPSIFT_EXPORT_API DenseSift
+{
+public:
+    static constexpr uint32_t descriptorLength = 128;
+
+    DenseSift();
+    explicit DenseSift(const DenseSiftConfig & config);
+
+    void setConfig(const DenseSiftConfig & config);
+    const DenseSiftConfig & getConfig() const { return m_config; }
+
+    /// @brief number of grid keypoints extracted from an image of the given size.
+    uint32_t getNbKeypoints(uint32_t width, uint32_t height) const;
+
+    /// @brief extracts descriptors on the grid of a grey image (8 bits, or 32 bits float).
+    /// @param[in] image, the input grey image.
+    /// @param[out] keypoints, the grid keypoints, size set to the scale and angle set to 0.
+    /// @param[out] descriptors, the SIFT descriptors (128 elements, of the configured type) of the keypoints.
+    /// @return FrameworkReturnCode::_SUCCESS if succeed, else FrameworkReturnCode::_ERROR_
+    FrameworkReturnCode extract(const SRef<datastructure::Image> image,
+                                std::vector<datastructure::Keypoint> & keypoints,
+                                SRef<datastructure::DescriptorBuffer> & descriptors);
+
+    /// @brief builds the pyramid of a grey image and returns the grid keypoints, without computing descriptors.
+    /// @return FrameworkReturnCode::_SUCCESS if succeed, else FrameworkReturnCode::_ERROR_
+    FrameworkReturnCode detect(const SRef<datastructure::Image> image,
+                               std::vector<datastructure::Keypoint> & keypoints);
+
+    /// @brief computes the descriptors of some keypoints of an image, e.g. the grid keypoints kept after detection.
+    /// The resident pyramid is used if it was built from the same image object, else it is rebuilt. Each keypoint is
+    /// described on the level of the nearest scale, with its size and its angle (in radians).
+    /// @param[out] descriptors, the SIFT descriptors (128 elements, of the configured type), in the order of the keypoints.
+    /// @return FrameworkReturnCode::_SUCCESS if succeed, else FrameworkReturnCode::_ERROR_
+    FrameworkReturnCode describe(const SRef<datastructure::Image> image,
+                                 const std::vector<datastructure::Keypoint> & keypoints,
+                                 SRef<datastructure::DescriptorBuffer> & descriptors);
+
+    /// @brief releases the resident pyramid and the strip planes.
+    void release();
+
+    /// @return the number of workers of the scheduler, including the calling thread.
+    uint32_t getNbThreads() const { return m_scheduler ? m_scheduler->getNbThreads() : 1; }
+
+    /// @return the activity of the workers of the scheduler.
+    std::vector<WorkerStats> getWorkerStats() const;
+
+private:
+    struct Plane {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<float> data;
+        void resize(uint32_t w, uint32_t h) { width = w; height = h; data.resize(std::size_t(w) * h); }
+    };
+
+    struct GridRange {
+        uint32_t first;     // first grid coordinate, in input image pixels
+        uint32_t count;     // number of grid points
+    };
+
+    // a plane and the tasks writing its bands of rows
+    struct Stage {
+        Plane * plane = nullptr;
+        std::vector<TaskGraph::TaskId> bands;
+    };
+
+    struct Octave {
+        float baseSigma;    // blur of the base, in octave pixels
+        Plane base;
+        Plane blurred;      // base blurred before subsampling to the next octave
+        Plane temp;
+        std::vector<float> kernel;
+        Stage baseStage;
+    };
+
+    // gradients of the pyramid level of a scale
+    struct Level {
+        float scale;        // in input image pixels
+        int octave;
+        Plane image;
+        Plane temp;
+        std::vector<float> kernel;
+        Plane magnitude;
+        Plane orientation;
+        std::vector<TaskGraph::TaskId> gradientBands;
+    };
+
+    // gradients of the rows of a level from firstRow on
+    struct Gradients {
+        const float * magnitude;
+        const float * orientation;
+        int width;
+        int height;         // of the level
+        int firstRow;
+    };
+
+    // scratch planes of a strip of extract(), holding the rows it reads
+    struct StripBuffers {
+        Plane temp;
+        Plane image;
+        Plane magnitude;
+        Plane orientation;
+    };
+
+    GridRange gridRange(uint32_t size, float scale) const;
+    FrameworkReturnCode checkImage(const SRef<datastructure::Image> image) const;
+    void addOctaveTasks(TaskGraph & tasks);
+    void addLevelTasks(TaskGraph & tasks);
+    void addStripTasks(TaskGraph & tasks);
+    SRef<datastructure::DescriptorBuffer> createDescriptors(uint32_t nbDescriptors) const;
+    void setLayout(const SRef<datastructure::Image> image);
+    void releaseLevels();
+    StripBuffers * acquireStripBuffers();
+    void releaseStripBuffers(StripBuffers * buffers);
+    FrameworkReturnCode buildPyramid(const SRef<datastructure::Image> image);
+    void gridKeypoints(std::vector<datastructure::Keypoint> & keypoints) const;
+    std::vector<TaskGraph::TaskId> bandsOfRows(const std::vector<TaskGraph::TaskId> & bands, int first, int last) const;
+    Stage addBlurTasks(TaskGraph & tasks, const Stage & input, Plane & temp, Plane & output, std::vector<float> & kernel, float sigma);
+    void describeKeypoint(const Gradients & gradients, float x, float y, float sigma, float angle, void * descriptor) const;
+    Gradients residentGradients(const Level & level) const;
+    const Level & nearestLevel(float size) const;
+
+    DenseSiftConfig m_config;
+    std::vector<float> m_scales;    // sorted scales
+    std::vector<Octave> m_octaves;
+    std::vector<Level> m_levels;    // one level per scale, its planes resident after detect()
+    SRef<datastructure::Image> m_residentImage;    // also the input of the tasks
+    std::mutex m_stripMutex;
+    std::vector<std::unique_ptr<StripBuffers>> m_stripBuffers;
+    std::vector<StripBuffers *> m_freeStripBuffers;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    bool m_isFloat = false;
+    // the graphs only depend on the image layout and are kept from one image to the next
+    TaskGraph m_pyramidTasks;
+    TaskGraph m_extractTasks;       // octave bases and strips of the levels
+    TaskGraph m_describeTasks;
+    const kernels::DescriptorKernels * m_kernels = nullptr;
+    unsigned char * m_output = nullptr;     // descriptors written by the strip tasks
+    std::unique_ptr<TaskScheduler> m_scheduler;
+};
+
+}
+}
+}
+
+#endif // SOLARPOPSIFTDENSESIFT_H
@@ -0,0 +1,79 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOLARPOPSIFTDESCRIPTORKERNELS_H
+#define SOLARPOPSIFTDESCRIPTORKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "SolARPopSiftAPI.h"
+
+namespace SolAR {
+namespace MODULES {
+namespace POPSIFT {
+namespace kernels {
+
+/// @brief Descriptor normalization: RootSift (L1, then square root) or Classic (L2, clamped at 0.2, L2 again).
+enum class NormMode { RootSift, Classic };
+
+/// @brief Pixel type of the input images.
+enum class InputType { Byte, Float };
+
+/// @brief Element type of the descriptors: float (TYPE_32F) or unsigned char (TYPE_8U, saturated).
+enum class DescriptorType { Float, Byte };
+
+/// @brief parses the string properties of the components: "RootSift" or "Classic", "Unsigned Char" or "Float".
+/// @return false if the string is not valid, the value being left unchanged.
+SOLARMODULEPOPSIFT_EXPORT_API bool parseNormMode(const std::string & value, NormMode & mode);
+SOLARMODULEPOPSIFT_EXPORT_API bool parseInputType(const std::string & value, InputType & type);
+SOLARMODULEPOPSIFT_EXPORT_API bool parseDescriptorType(const std::string & value, DescriptorType & type);
+
+/**
+ * @brief CPU kernels of the descriptor computation and matching for one configuration.
+ *
+ * Each entry is a template instance for one (norm, input type, descriptor type) combination, so that the loops carry
+ * no per-pixel nor per-element branch. The table is selected once, when the component is configured. The SIFT mode
+ * (PopSift, OpenCV or VLFeat) only changes the GPU pyramid and is not an axis of the CPU kernels.
+ */
+struct DescriptorKernels {
+    /// @brief converts the pixels [begin, end) of an image to floats in [0, 1].
+    void (*convertPixels)(const void * pixels, float * plane, std::size_t begin, std::size_t end);
+    /// @brief normalizes a 128 bins histogram (modified) and stores it as a descriptor, scaled by 512 like PopSift.
+    void (*finalizeDescriptor)(float * histogram, void * descriptor);
+    /// @brief squared L2 distance between two descriptors of 128 elements.
+    float (*descriptorDistance)(const void * descriptor1, const void * descriptor2);
+    std::size_t descriptorSize;     // in bytes
+    NormMode norm;
+    InputType input;
+    DescriptorType descriptor;
+    const char * name;
+};
+
+/// @brief selects the specialized kernels of a configuration.
+SOLARMODULEPOPSIFT_EXPORT_API const DescriptorKernels & selectDescriptorKernels(NormMode norm, InputType input, DescriptorType descriptor);
+
+/// @brief Generic implementations testing the configuration in their loops, the reference of the specialized kernels.
+SOLARMODULEPOPSIFT_EXPORT_API void convertPixelsGeneric(InputType input, const void * pixels, float * plane, std::size_t begin, std::size_t end);
+SOLARMODULEPOPSIFT_EXPORT_API void finalizeDescriptorGeneric(NormMode norm, DescriptorType descriptor, float * histogram, void * output);
+SOLARMODULEPOPSIFT_EXPORT_API float descriptorDistanceGeneric(DescriptorType descriptor, const void * descriptor1, const void * descriptor2);
+
+}
+}
+}
+}
+
+#endif // SOLARPOPSIFTDESCRIPTORKERNELS_H
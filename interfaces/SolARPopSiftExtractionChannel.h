@@ -0,0 +1,152 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOLARPOPSIFTEXTRACTIONCHANNEL_H
+#define SOLARPOPSIFTEXTRACTIONCHANNEL_H
+
+#include <atomic>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "SolARPopSiftAPI.h"
+#include "api/features/IDescriptorsExtractorFromImage.h"
+
+namespace SolAR {
+namespace MODULES {
+namespace POPSIFT {
+
+/// @brief Sizes of the shared memory segment of an extraction server.
+struct ExtractionChannelConfig {
+    uint32_t maxClients = 8;            // Number of client processes connected at the same time
+    uint32_t slotsPerClient = 2;        // Number of requests in flight per client
+    uint64_t maxImageBytes = 1920 * 1080 * 4;
+    uint32_t maxKeypoints = 20000;
+    uint32_t maxDescriptorBytes = 128 * sizeof(float);  // Size of one descriptor
+};
+
+/// @brief Statistics of an extraction server.
+struct ExtractionServerStats {
+    uint64_t nbRequests = 0;
+    uint64_t nbBatches = 0;
+    uint32_t maxBatchSize = 0;
+    uint32_t nbReclaimedClients = 0;
+};
+
+/**
+ * @class ExtractionServer
+ * @brief <B>Serves descriptor extraction requests of local processes through a POSIX shared memory segment.</B>
+ *
+ * The segment holds a ring of request slots per client. A client writes its image in a free slot of its ring, then
+ * wakes the server up; the server batches the pending requests of all the clients on the single extractor it owns,
+ * and writes the keypoints and descriptors back in the slots. Slots of crashed clients are reclaimed.
+ * Only available on POSIX systems.
+ */
+class SOLARMODULEPOPSIFT_EXPORT_API ExtractionServer
+{
+public:
+    ExtractionServer() = default;
+    ~ExtractionServer();
+
+    /// @brief creates the shared memory segment. An existing segment with the same name is replaced.
+    /// @param[in] name, the segment name, e.g. "/solar_popsift".
+    /// @param[in] extractor, the extractor serving all the clients.
+    /// @return FrameworkReturnCode::_SUCCESS if succeed, else FrameworkReturnCode::_ERROR_
+    FrameworkReturnCode create(const std::string & name,
+                               const SRef<api::features::IDescriptorsExtractorFromImage> extractor,
+                               const ExtractionChannelConfig & config = ExtractionChannelConfig());
+
+    /// @brief serves requests until stop() is called.
+    void run();
+
+    /// @brief serves the pending requests, waiting at most timeoutMs for the first one.
+    /// @return the number of requests served.
+    uint32_t processPending(uint32_t timeoutMs);
+
+    /// @brief makes run() return. Can be called from a signal handler.
+    void stop();
+
+    /// @brief removes the shared memory segment. Connected clients get errors from then on.
+    void destroy();
+
+    ExtractionServerStats getStats() const { return m_stats; }
+
+private:
+    void reclaimDeadClients();
+
+    std::string m_name;
+    SRef<api::features::IDescriptorsExtractorFromImage> m_extractor;
+    unsigned char * m_segment = nullptr;
+    std::size_t m_segmentSize = 0;
+    std::atomic<bool> m_stop { false };
+    ExtractionServerStats m_stats;
+    std::vector<uint32_t> m_batch;
+    std::vector<datastructure::Keypoint> m_keypoints;
+};
+
+/**
+ * @class ExtractionClient
+ * @brief <B>Sends descriptor extraction requests to an ExtractionServer of the same machine.</B>
+ *
+ * extract() can be called concurrently from several threads, up to the number of slots per client. A client whose
+ * server has stopped is disconnected, and can connect to the segment of a restarted server.
+ */
+class SOLARMODULEPOPSIFT_EXPORT_API ExtractionClient
+{
+public:
+    ExtractionClient() = default;
+    ~ExtractionClient();
+
+    /// @brief maps the segment of a running server and reserves a client ring.
+    /// @return FrameworkReturnCode::_SUCCESS if succeed, else FrameworkReturnCode::_ERROR_
+    FrameworkReturnCode connect(const std::string & name);
+
+    /// @brief releases the client ring and unmaps the segment.
+    void disconnect();
+
+    bool isConnected() const;
+
+    /// @brief extracts keypoints and descriptors through the server.
+    /// @param[in] timeoutMs, maximum time to wait for the result.
+    /// @return FrameworkReturnCode::_SUCCESS if succeed, else FrameworkReturnCode::_ERROR_, the client being
+    /// disconnected if the server has stopped
+    FrameworkReturnCode extract(const SRef<datastructure::Image> image,
+                                std::vector<datastructure::Keypoint> & keypoints,
+                                SRef<datastructure::DescriptorBuffer> & descriptors,
+                                uint32_t timeoutMs);
+
+private:
+    FrameworkReturnCode send(const SRef<datastructure::Image> image,
+                             std::vector<datastructure::Keypoint> & keypoints,
+                             SRef<datastructure::DescriptorBuffer> & descriptors,
+                             uint32_t timeoutMs,
+                             bool & serverStopped);
+    void release();
+
+    // extract() maps the segment shared, connect() and disconnect() exclusive
+    mutable std::shared_mutex m_mutex;
+    unsigned char * m_segment = nullptr;
+    std::size_t m_segmentSize = 0;
+    uint32_t m_clientIndex = 0;
+    uint64_t m_connection = 0;      // incremented by every connection
+};
+
+}
+}
+}
+
+#endif // SOLARPOPSIFTEXTRACTIONCHANNEL_H
@@ -0,0 +1,63 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOLARPOPSIFTKERNELS_H
+#define SOLARPOPSIFTKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include "SolARPopSiftAPI.h"
+
+namespace SolAR {
+namespace MODULES {
+namespace POPSIFT {
+namespace kernels {
+
+/// @brief Squared L2 distance between two float vectors of the given length.
+/// The implementation (scalar, SSE2 or AVX2/FMA) is selected once at load time according to the host CPU.
+SOLARMODULEPOPSIFT_EXPORT_API float l2sqr(const float * a, const float * b, std::size_t length);
+
+/// @brief Squared L2 distances between one query and a contiguous block of rows.
+/// @param[in] query, the query vector.
+/// @param[in] rows, nbRows contiguous vectors of the given length.
+/// @param[out] distances, nbRows squared distances.
+SOLARMODULEPOPSIFT_EXPORT_API void l2sqrRows(const float * query, const float * rows, std::size_t nbRows, std::size_t length, float * distances);
+
+/// @brief Converts nbElements unsigned char values to float.
+SOLARMODULEPOPSIFT_EXPORT_API void toFloat(const uint8_t * src, float * dst, std::size_t nbElements);
+
+/// @brief Name of the instruction set selected for the kernels ("AVX2", "SSE2" or "Scalar").
+SOLARMODULEPOPSIFT_EXPORT_API const char * instructionSet();
+
+/// @brief Hamming distance between two 256-bit codes of 4 words.
+SOLARMODULEPOPSIFT_EXPORT_API uint32_t hamming256(const uint64_t * a, const uint64_t * b);
+
+/// @brief Hamming distances between one 256-bit code and a contiguous block of codes.
+/// The implementation (scalar, POPCNT, AVX2 nibble lookup or AVX-512 VPOPCNTDQ) is selected once according to the host CPU.
+/// @param[in] query, the query code.
+/// @param[in] codes, nbCodes contiguous codes of 4 words.
+/// @param[out] distances, nbCodes distances in [0, 256].
+SOLARMODULEPOPSIFT_EXPORT_API void hamming256Rows(const uint64_t * query, const uint64_t * codes, std::size_t nbCodes, uint32_t * distances);
+
+/// @brief Name of the instruction set selected for the Hamming kernels ("AVX512VPOPCNTDQ", "AVX2", "POPCNT" or "Scalar").
+SOLARMODULEPOPSIFT_EXPORT_API const char * hammingInstructionSet();
+
+}
+}
+}
+}
+
+#endif // SOLARPOPSIFTKERNELS_H
@@ -0,0 +1,92 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOLARPOPSIFTQUALITYCONTROLLER_H
+#define SOLARPOPSIFTQUALITYCONTROLLER_H
+
+#include <cstdint>
+#include <mutex>
+
+#include "SolARPopSiftAPI.h"
+#include "IPopSiftQualityControl.h"
+
+namespace SolAR {
+namespace MODULES {
+namespace POPSIFT {
+
+/// @brief Parameters of the quality controller.
+struct QualityControllerConfig {
+    float targetLatency = 0.0f;     // Target extraction time per frame in ms, 0 disables the controller
+    QualitySettings base;           // Configured settings, the best quality the controller goes back to
+    float maxThreshold = 0.12f;     // Highest contrast threshold
+    uint32_t minKeypoints = 500;    // Lowest keypoint cap
+    uint32_t maxFirstOctave = 2;    // Highest number of skipped octaves
+    float deadband = 0.1f;          // Relative band around the target in which the settings are kept
+    float smoothing = 0.3f;         // Weight of the last frame in the moving average of the extraction time
+    uint32_t settleFrames = 3;      // Frames without adjustment after a change of the first octave
+};
+
+/**
+ * @class QualityController
+ * @brief <B>Closed-loop controller of the detection settings from the measured extraction times.</B>
+ *
+ * Over budget, the keypoint cap is lowered first when the conversion stage weighs, then the contrast threshold is
+ * raised, and the bottom octaves are skipped last. Under budget, the settings go back to the configured ones more
+ * slowly; a skipped octave is restored on probation, and skipped again with an increasing backoff if it does not fit.
+ * The settings only change parameters applied per frame, so that no detection context has to be reallocated,
+ * except for the first octave which changes the pyramid size.
+ */
+class SOLARMODULEPOPSIFT_EXPORT_API QualityController
+{
+public:
+    QualityController() = default;
+    explicit QualityController(const QualityControllerConfig & config);
+
+    /// @brief sets the parameters and restores the configured settings.
+    void setConfig(const QualityControllerConfig & config);
+
+    /// @brief sets the target extraction time, 0 disables the controller and restores the configured settings.
+    void setTargetLatency(float targetLatency);
+
+    /// @brief reports the stage times of the last frame and adapts the settings of the next one.
+    /// @param[in] detectionTime, time spent in detection and description, in ms.
+    /// @param[in] conversionTime, time spent in converting the features, in ms.
+    /// @param[in] nbKeypoints, number of keypoints of the frame.
+    /// @return true if the settings changed.
+    bool update(float detectionTime, float conversionTime, uint32_t nbKeypoints);
+
+    QualitySettings getSettings() const;
+    QualityState getState() const;
+
+private:
+    bool degrade(float ratio);
+    bool improve();
+
+    mutable std::mutex m_mutex;
+    QualityControllerConfig m_config;
+    QualityState m_state;
+    uint32_t m_settle = 0;
+    bool m_resetAverage = true;
+    bool m_probing = false;             // an octave was restored, it is checked once settled
+    uint32_t m_probeBackoff = 0;
+    uint32_t m_probeBackoffLength = 0;
+};
+
+}
+}
+}
+
+#endif // SOLARPOPSIFTQUALITYCONTROLLER_H
@@ -0,0 +1,107 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOLARPOPSIFTSTEREOMATCHER_H
+#define SOLARPOPSIFTSTEREOMATCHER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "xpcf/core/refs.h"
+
+#include "SolARPopSiftAPI.h"
+#include "core/Messages.h"
+#include "datastructure/DescriptorBuffer.h"
+#include "datastructure/DescriptorMatch.h"
+#include "datastructure/Keypoint.h"
+
+namespace SolAR {
+namespace MODULES {
+namespace POPSIFT {
+
+/// @brief Search constraints of the rectified stereo matching.
+struct StereoMatcherConfig {
+    float rowTolerance = 2.0f;      // Rows searched above and below a left keypoint
+    float minDisparity = 0.0f;      // Disparity range of the right keypoints, disparity = x left - x right
+    float maxDisparity = 128.0f;
+    float ratio = 0.8f;             // Best over second best candidate distance, 1 keeps every best candidate
+    float maxDistance = 0.0f;       // Largest L2 descriptor distance of a match, 0 for no limit
+};
+
+/**
+ * @class RectifiedStereoMatcher
+ * @brief <B>Matches the keypoints of a rectified stereo pair along the scanlines.</B>
+ *
+ * True correspondences of a rectified pair lie on the same row, within the disparity range of the rig. The right
+ * keypoints are sorted into bands of rowTolerance rows and by x, their descriptors being copied in that order, so
+ * that the candidates of a left keypoint are a few contiguous runs of the bands covering its rows: only their
+ * distances are computed, with the SIMD kernels of the module.
+ */
+class SOLARMODULEPOPSIFT_EXPORT_API RectifiedStereoMatcher
+{
+public:
+    RectifiedStereoMatcher() = default;
+    explicit RectifiedStereoMatcher(const StereoMatcherConfig & config);
+
+    void setConfig(const StereoMatcherConfig & config);
+    const StereoMatcherConfig & getConfig() const { return m_config; }
+
+    /// @brief matches the left keypoints to the right ones.
+    /// @param[in] leftKeypoints, leftDescriptors, the features of the left image (TYPE_32F descriptors).
+    /// @param[in] rightKeypoints, rightDescriptors, the features of the right image.
+    /// @param[out] matches, the matches (left index, right index, L2 distance).
+    /// @param[out] disparities, the disparity of each match.
+    /// @return FrameworkReturnCode::_SUCCESS if succeed, else FrameworkReturnCode::_ERROR_
+    FrameworkReturnCode match(const std::vector<datastructure::Keypoint> & leftKeypoints,
+                              const SRef<datastructure::DescriptorBuffer> leftDescriptors,
+                              const std::vector<datastructure::Keypoint> & rightKeypoints,
+                              const SRef<datastructure::DescriptorBuffer> rightDescriptors,
+                              std::vector<datastructure::DescriptorMatch> & matches,
+                              std::vector<float> & disparities);
+
+    /// @brief same as above, on raw float descriptors of the given length.
+    void match(const std::vector<datastructure::Keypoint> & leftKeypoints, const float * leftDescriptors,
+               const std::vector<datastructure::Keypoint> & rightKeypoints, const float * rightDescriptors,
+               uint32_t descriptorLength,
+               std::vector<datastructure::DescriptorMatch> & matches,
+               std::vector<float> & disparities);
+
+    /// @return the number of descriptor distances computed by the last match.
+    uint64_t getNbDistanceEvaluations() const { return m_nbDistanceEvaluations; }
+
+private:
+    struct Candidate {
+        float x;
+        float y;
+        uint32_t index;     // in the right keypoints
+    };
+
+    void sortRightKeypoints(const std::vector<datastructure::Keypoint> & keypoints, const float * descriptors, uint32_t descriptorLength);
+
+    StereoMatcherConfig m_config;
+    float m_bandHeight = 2.0f;
+    int m_firstBand = 0;
+    std::vector<uint32_t> m_bandStarts;     // first candidate of each band, and the end of the last one
+    std::vector<Candidate> m_candidates;    // right keypoints sorted by band and x
+    std::vector<float> m_sortedDescriptors; // their descriptors, in the same order
+    uint64_t m_nbDistanceEvaluations = 0;
+};
+
+}
+}
+}
+
+#endif // SOLARPOPSIFTSTEREOMATCHER_H
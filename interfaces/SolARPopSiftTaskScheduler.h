@@ -0,0 +1,159 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOLARPOPSIFTTASKSCHEDULER_H
+#define SOLARPOPSIFTTASKSCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "SolARPopSiftAPI.h"
+
+namespace SolAR {
+namespace MODULES {
+namespace POPSIFT {
+
+/**
+ * @class TaskGraph
+ * @brief <B>Tasks and their dependencies, run by a TaskScheduler.</B>
+ *
+ * A task only depends on tasks added before it, so that the insertion order is a valid sequential order.
+ * Tasks must not throw.
+ */
+class SOLARMODULEPOPSIFT_EXPORT_API TaskGraph
+{
+public:
+    using TaskId = uint32_t;
+
+    /// @brief adds a task.
+    /// @param[in] work, the task.
+    /// @param[in] dependencies, tasks already added which must be done before this one.
+    /// @return the id of the task.
+    TaskId add(std::function<void()> work, std::vector<TaskId> dependencies = {});
+
+    std::size_t size() const { return m_tasks.size(); }
+    bool empty() const { return m_tasks.empty(); }
+    void clear() { m_tasks.clear(); }
+
+private:
+    friend class TaskScheduler;
+
+    struct Task {
+        std::function<void()> work;
+        std::vector<TaskId> successors;
+        uint32_t nbDependencies = 0;
+    };
+
+    std::vector<Task> m_tasks;
+};
+
+/// @brief Activity of a worker of the scheduler, since its creation or the last reset.
+struct WorkerStats {
+    int cpu = -1;                   // CPU the worker is pinned to, -1 if not pinned (the calling thread is worker 0)
+    int numaNode = 0;
+    uint64_t nbTasks = 0;
+    uint64_t nbStolenTasks = 0;     // tasks taken from another worker
+    double busyTime = 0.0;          // time spent in tasks, in ms
+    double utilization = 0.0;       // busy time over the time spent in TaskScheduler::run
+};
+
+/**
+ * @class TaskScheduler
+ * @brief <B>Runs task graphs on a pool of work-stealing workers.</B>
+ *
+ * Each worker owns a queue: the tasks made ready by a worker are pushed to its own queue and taken back in LIFO order,
+ * which keeps the data they share in its caches, while idle workers steal the oldest tasks of the others, first on
+ * their NUMA node. On request, the workers are pinned to the CPUs allowed to the process, one NUMA node after the
+ * other, so that the workers of a small pool share the memory of a node. They are not pinned by default, which would
+ * pile them on the same CPUs as the workers of another pool or process. The calling thread of run() is worker 0.
+ */
+class SOLARMODULEPOPSIFT_EXPORT_API TaskScheduler
+{
+public:
+    /// @param[in] nbThreads, number of workers including the calling thread, 0 for the number of hardware threads.
+    /// @param[in] pinWorkers, pin the worker threads to CPUs.
+    explicit TaskScheduler(uint32_t nbThreads = 0, bool pinWorkers = false);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler &) = delete;
+    TaskScheduler & operator=(const TaskScheduler &) = delete;
+
+    uint32_t getNbThreads() const { return uint32_t(m_workers.size()); }
+    bool getPinWorkers() const { return m_pinWorkers; }
+
+    /// @brief runs the tasks of a graph and returns when all are done. Graphs are run one at a time.
+    void run(TaskGraph & graph);
+
+    std::vector<WorkerStats> getWorkerStats() const;
+    void resetStats();
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<TaskGraph::TaskId> tasks;
+        std::thread thread;
+        int cpu = -1;
+        int numaNode = 0;
+        std::vector<uint32_t> victims;  // other workers, those of the same NUMA node first
+        std::minstd_rand random;
+        std::atomic<uint64_t> nbTasks{0};
+        std::atomic<uint64_t> nbStolenTasks{0};
+        std::atomic<uint64_t> busyTime{0};      // in ns
+    };
+
+    void workerLoop(uint32_t index);
+    void work(uint32_t index);
+    bool executeOne(uint32_t index);
+    bool steal(uint32_t index, TaskGraph::TaskId & task);
+    void push(uint32_t index, TaskGraph::TaskId task);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    bool m_pinWorkers;
+    std::mutex m_runMutex;
+
+    // graph being run
+    TaskGraph * m_graph = nullptr;
+    std::unique_ptr<std::atomic<uint32_t>[]> m_pending;
+    std::size_t m_pendingSize = 0;
+    std::atomic<uint32_t> m_remaining{0};
+
+    // sleeping workers
+    std::mutex m_wakeMutex;
+    std::condition_variable m_start;        // a graph is posted
+    std::condition_variable m_wake;         // a task is ready or the graph is done
+    std::condition_variable m_done;         // a worker left the graph
+    std::atomic<uint64_t> m_pushCount{0};
+    std::atomic<uint32_t> m_nbSleeping{0};
+    uint64_t m_generation = 0;
+    uint32_t m_nbWorkersInGraph = 0;
+    bool m_stop = false;
+
+    std::atomic<uint64_t> m_runTime{0};     // time spent in run, in ns
+};
+
+}
+}
+}
+
+#endif // SOLARPOPSIFTTASKSCHEDULER_H
@@ -0,0 +1,103 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOLARPOPSIFTWARMUP_H
+#define SOLARPOPSIFTWARMUP_H
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "SolARPopSiftAPI.h"
+#include "IPopSiftWarmup.h"
+
+namespace SolAR {
+namespace MODULES {
+namespace POPSIFT {
+
+/// @brief A step of a warm-up and the startup metric receiving its duration.
+struct WarmupStage {
+    float StartupMetrics::* time;
+    std::function<void()> work;
+};
+
+/**
+ * @class Warmup
+ * @brief <B>Runs the initialization of a component off the critical path of its configuration.</B>
+ *
+ * The stages run in order, on a background thread or on the calling one, and are timed into the startup metrics.
+ * The frames call waitForFrame() before using what the stages initialize: only the first frames given during the
+ * warm-up wait. A stage throwing marks the warm-up as failed. The owner calls join() before changing the state the
+ * stages use, e.g. at the start of the next configuration and in its destructor.
+ */
+class SOLARMODULEPOPSIFT_EXPORT_API Warmup
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    Warmup() = default;
+    ~Warmup();
+
+    Warmup(const Warmup &) = delete;
+    Warmup & operator=(const Warmup &) = delete;
+
+    /// @brief starts the warm-up of a configuration, after the previous one is done.
+    /// @param[in] configureStart, start of the configuration, the origin of the configure and ready times.
+    /// @param[in] stages, the stages of the warm-up.
+    /// @param[in] background, run the stages on a background thread, otherwise before returning.
+    /// @param[in] contextReused, reported in the startup metrics.
+    void start(Clock::time_point configureStart, std::vector<WarmupStage> stages, bool background, bool contextReused);
+
+    /// @brief corrects the reuse reported in the startup metrics, e.g. by a stage recreating a context that refused
+    /// its new configuration.
+    void setContextReused(bool contextReused);
+
+    /// @brief waits for the end of the warm-up before processing a frame, the wait of the first frame after start()
+    /// being reported in the startup metrics.
+    /// @return true if the warm-up succeeded.
+    bool waitForFrame();
+
+    /// @brief waits for the end of the warm-up.
+    /// @param[in] timeout, in ms, negative to wait without limit.
+    /// @return true if the warm-up succeeded, false on timeout or failure.
+    bool waitUntilReady(float timeout = -1.0f);
+
+    /// @brief waits for the end of the warm-up without reporting it, and joins its thread.
+    void join();
+
+    bool isReady() const;
+    StartupMetrics getMetrics() const;
+
+private:
+    void run(std::vector<WarmupStage> stages);
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_done;
+    std::thread m_thread;
+    StartupMetrics m_metrics;
+    Clock::time_point m_configureStart;
+    bool m_running = false;
+    bool m_firstFrame = false;          // no frame was processed since start()
+};
+
+}
+}
+}
+
+#endif // SOLARPOPSIFTWARMUP_H
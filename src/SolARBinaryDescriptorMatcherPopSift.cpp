@@ -0,0 +1,75 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SolARBinaryDescriptorMatcherPopSift.h"
+#include "SolARPopSiftKernels.h"
+#include "core/Log.h"
+
+XPCF_DEFINE_FACTORY_CREATE_INSTANCE(SolAR::MODULES::POPSIFT::SolARBinaryDescriptorMatcherPopSift);
+
+namespace xpcf  = org::bcom::xpcf;
+
+namespace SolAR {
+using namespace datastructure;
+namespace MODULES {
+namespace POPSIFT {
+
+SolARBinaryDescriptorMatcherPopSift::SolARBinaryDescriptorMatcherPopSift():ConfigurableBase(xpcf::toUUID<SolARBinaryDescriptorMatcherPopSift>())
+{
+    addInterface<IPopSiftBinaryMatcher>(this);
+    declareProperty("nbCandidates", m_nbCandidates);
+    declareProperty("ratio", m_ratio);
+    declareProperty("maxHammingDistance", m_maxHammingDistance);
+
+    LOG_DEBUG(" SolARBinaryDescriptorMatcherPopSift constructor");
+}
+
+xpcf::XPCFErrorCode SolARBinaryDescriptorMatcherPopSift::onConfigured()
+{
+    LOG_DEBUG(" SolARBinaryDescriptorMatcherPopSift onConfigured");
+
+    if (m_ratio <= 0.f) {
+        LOG_ERROR("SolARBinaryDescriptorMatcherPopSift ratio must be positive, got {}", m_ratio);
+        return xpcf::XPCFErrorCode::_FAIL;
+    }
+    BinaryMatcherConfig config;
+    config.nbCandidates = m_nbCandidates;
+    config.ratio = m_ratio;
+    config.maxHammingDistance = m_maxHammingDistance;
+    m_matcher.setConfig(config);
+    LOG_INFO("SolARBinaryDescriptorMatcherPopSift uses {} Hamming kernels, {} re-ranked candidates", kernels::hammingInstructionSet(), m_nbCandidates);
+    return xpcf::XPCFErrorCode::_SUCCESS;
+}
+
+FrameworkReturnCode SolARBinaryDescriptorMatcherPopSift::matchCodes(const SRef<DescriptorBuffer> codes1,
+                                                                    const SRef<DescriptorBuffer> codes2,
+                                                                    std::vector<DescriptorMatch> & matches)
+{
+    return m_matcher.match(codes1, codes2, matches);
+}
+
+FrameworkReturnCode SolARBinaryDescriptorMatcherPopSift::matchCodes(const SRef<DescriptorBuffer> codes1,
+                                                                    const SRef<DescriptorBuffer> descriptors1,
+                                                                    const SRef<DescriptorBuffer> codes2,
+                                                                    const SRef<DescriptorBuffer> descriptors2,
+                                                                    std::vector<DescriptorMatch> & matches)
+{
+    return m_matcher.match(codes1, descriptors1, codes2, descriptors2, matches);
+}
+
+}
+}
+}
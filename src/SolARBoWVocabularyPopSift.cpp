@@ -0,0 +1,533 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "SolARBoWVocabularyPopSift.h"
+#include "SolARPopSiftKernels.h"
+#include "core/Log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+XPCF_DEFINE_FACTORY_CREATE_INSTANCE(SolAR::MODULES::POPSIFT::SolARBoWVocabularyPopSift);
+
+namespace xpcf  = org::bcom::xpcf;
+
+namespace SolAR {
+using namespace datastructure;
+namespace MODULES {
+namespace POPSIFT {
+
+namespace {
+
+const char vocabularyMagic[8] = { 'P', 'S', 'V', 'O', 'C', 'A', 'B', '\0' };
+const uint32_t vocabularyVersion = 1;
+const uint64_t sectionAlignment = 64;
+
+struct VocabularyHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t descriptorLength;
+    uint32_t nbNodes;
+    uint32_t nbWords;
+    uint64_t nodesOffset;
+    uint64_t centroidsOffset;
+    uint64_t weightsOffset;
+    uint8_t reserved[16];
+};
+static_assert(sizeof(VocabularyHeader) == 64, "vocabulary header must be 64 bytes");
+
+uint64_t alignSection(uint64_t offset)
+{
+    return (offset + sectionAlignment - 1) / sectionAlignment * sectionAlignment;
+}
+
+void fillHeader(VocabularyHeader & header, uint32_t descriptorLength, uint32_t nbNodes, uint32_t nbWords)
+{
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, vocabularyMagic, sizeof(vocabularyMagic));
+    header.version = vocabularyVersion;
+    header.descriptorLength = descriptorLength;
+    header.nbNodes = nbNodes;
+    header.nbWords = nbWords;
+    header.nodesOffset = alignSection(sizeof(VocabularyHeader));
+    header.centroidsOffset = alignSection(header.nodesOffset + uint64_t(nbNodes) * sizeof(SolARBoWVocabularyPopSift::VocabularyNode));
+    header.weightsOffset = alignSection(header.centroidsOffset + uint64_t(nbNodes) * descriptorLength * sizeof(float));
+}
+
+bool checkHeader(const VocabularyHeader & header, uint64_t fileSize)
+{
+    VocabularyHeader expected;
+    fillHeader(expected, header.descriptorLength, header.nbNodes, header.nbWords);
+    return std::memcmp(header.magic, vocabularyMagic, sizeof(vocabularyMagic)) == 0
+            && header.version == vocabularyVersion
+            && header.descriptorLength > 0
+            && header.nbNodes > 0
+            && header.nbWords > 0
+            && header.nodesOffset == expected.nodesOffset
+            && header.centroidsOffset == expected.centroidsOffset
+            && header.weightsOffset == expected.weightsOffset
+            && header.weightsOffset + uint64_t(header.nbWords) * sizeof(float) <= fileSize;
+}
+
+}
+
+SolARBoWVocabularyPopSift::SolARBoWVocabularyPopSift():ConfigurableBase(xpcf::toUUID<SolARBoWVocabularyPopSift>())
+{
+    addInterface<IPopSiftBoWVocabulary>(this);
+    declareProperty("vocabularyPath", m_vocabularyPath);
+    declareProperty("nbThreads", m_nbThreads);
+    declareProperty("blockSize", m_blockSize);
+
+    LOG_DEBUG(" SolARBoWVocabularyPopSift constructor");
+}
+
+SolARBoWVocabularyPopSift::~SolARBoWVocabularyPopSift(){
+    release();
+}
+
+void SolARBoWVocabularyPopSift::release()
+{
+#ifndef _WIN32
+    if (m_mapping != nullptr)
+        munmap(m_mapping, m_mappingSize);
+#endif
+    m_mapping = nullptr;
+    m_mappingSize = 0;
+    m_nodes = nullptr;
+    m_centroids = nullptr;
+    m_weights = nullptr;
+    m_nbNodes = m_nbWords = m_descriptorLength = 0;
+    m_nodeStorage.clear();
+    m_centroidStorage.clear();
+    m_weightStorage.clear();
+}
+
+xpcf::XPCFErrorCode SolARBoWVocabularyPopSift::onConfigured()
+{
+    LOG_DEBUG(" SolARBoWVocabularyPopSift onConfigured");
+
+    release();
+    clearIndex();
+    if (m_blockSize == 0)
+        m_blockSize = 256;
+    // the workers are not pinned: they share the CPUs with those of the extraction
+    uint32_t nbThreads = m_nbThreads > 0 ? uint32_t(m_nbThreads) : std::max(1u, std::thread::hardware_concurrency());
+    if (!m_scheduler || m_scheduler->getNbThreads() != nbThreads)
+        m_scheduler.reset(new TaskScheduler(nbThreads, false));
+
+    bool isText = m_vocabularyPath.size() > 4 && m_vocabularyPath.compare(m_vocabularyPath.size() - 4, 4, ".txt") == 0;
+    bool loaded = isText ? loadText(m_vocabularyPath) : loadBinary(m_vocabularyPath);
+    if (!loaded) {
+        LOG_ERROR("SolARBoWVocabularyPopSift cannot load the vocabulary {}", m_vocabularyPath);
+        release();
+        return xpcf::XPCFErrorCode::_FAIL;
+    }
+    m_invertedFile.assign(m_nbWords, {});
+    LOG_INFO("SolARBoWVocabularyPopSift loaded {} words ({} nodes) from {}, {} kernels", m_nbWords, m_nbNodes, m_vocabularyPath, kernels::instructionSet());
+    return xpcf::XPCFErrorCode::_SUCCESS;
+}
+
+bool SolARBoWVocabularyPopSift::loadBinary(const std::string & path)
+{
+    VocabularyHeader header;
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || uint64_t(fileStat.st_size) < sizeof(VocabularyHeader)) {
+        close(fd);
+        return false;
+    }
+    std::size_t fileSize = static_cast<std::size_t>(fileStat.st_size);
+    void * mapping = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        return false;
+    m_mapping = mapping;
+    m_mappingSize = fileSize;
+    std::memcpy(&header, mapping, sizeof(header));
+    if (!checkHeader(header, fileSize))
+        return false;
+    const unsigned char * base = static_cast<const unsigned char *>(mapping);
+    m_nodes = reinterpret_cast<const VocabularyNode *>(base + header.nodesOffset);
+    m_centroids = reinterpret_cast<const float *>(base + header.centroidsOffset);
+    m_weights = reinterpret_cast<const float *>(base + header.weightsOffset);
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return false;
+    uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+    if (fileSize < sizeof(VocabularyHeader) || !file.read(reinterpret_cast<char *>(&header), sizeof(header)) || !checkHeader(header, fileSize))
+        return false;
+    m_nodeStorage.resize(header.nbNodes);
+    m_centroidStorage.resize(std::size_t(header.nbNodes) * header.descriptorLength);
+    m_weightStorage.resize(header.nbWords);
+    file.seekg(header.nodesOffset);
+    file.read(reinterpret_cast<char *>(m_nodeStorage.data()), m_nodeStorage.size() * sizeof(VocabularyNode));
+    file.seekg(header.centroidsOffset);
+    file.read(reinterpret_cast<char *>(m_centroidStorage.data()), m_centroidStorage.size() * sizeof(float));
+    file.seekg(header.weightsOffset);
+    file.read(reinterpret_cast<char *>(m_weightStorage.data()), m_weightStorage.size() * sizeof(float));
+    if (!file)
+        return false;
+    m_nodes = m_nodeStorage.data();
+    m_centroids = m_centroidStorage.data();
+    m_weights = m_weightStorage.data();
+#endif
+    m_descriptorLength = header.descriptorLength;
+    m_nbNodes = header.nbNodes;
+    m_nbWords = header.nbWords;
+
+    // check the tree topology once, so that quantization does not have to
+    for (uint32_t i = 0; i < m_nbNodes; ++i) {
+        const VocabularyNode & node = m_nodes[i];
+        if (node.nbChildren == 0) {
+            if (node.wordId < 0 || uint32_t(node.wordId) >= m_nbWords)
+                return false;
+        }
+        else if (node.firstChild <= i || uint64_t(node.firstChild) + node.nbChildren > m_nbNodes)
+            return false;
+    }
+    return true;
+}
+
+bool SolARBoWVocabularyPopSift::loadText(const std::string & path)
+{
+    // DBoW2 text format: "k L scoring weighting", then one line per node (except the root):
+    // "parentId isLeaf d_0 ... d_n-1 weight"
+    std::ifstream file(path);
+    if (!file.is_open())
+        return false;
+    std::string line;
+    if (!std::getline(file, line))
+        return false;
+
+    std::vector<uint32_t> parents(1, 0);
+    std::vector<bool> leaves(1, false);
+    std::vector<float> centroids;
+    std::vector<float> weights(1, 0.0f);
+    uint32_t descriptorLength = 0;
+    while (std::getline(file, line)) {
+        std::istringstream stream(line);
+        std::vector<float> values;
+        float value;
+        while (stream >> value)
+            values.push_back(value);
+        if (values.empty())
+            continue;
+        if (values.size() < 4)
+            return false;
+        uint32_t length = static_cast<uint32_t>(values.size() - 3);
+        if (descriptorLength == 0) {
+            descriptorLength = length;
+            centroids.assign(descriptorLength, 0.0f); // root centroid, never used
+        }
+        if (length != descriptorLength || values[0] < 0.0f || values[0] >= float(parents.size()))
+            return false;
+        parents.push_back(static_cast<uint32_t>(values[0]));
+        leaves.push_back(values[1] != 0.0f);
+        centroids.insert(centroids.end(), values.begin() + 2, values.end() - 1);
+        weights.push_back(values.back());
+    }
+    if (parents.size() < 2)
+        return false;
+
+    // renumber the nodes breadth first so that siblings are contiguous
+    std::vector<std::vector<uint32_t>> children(parents.size());
+    for (uint32_t i = 1; i < parents.size(); ++i)
+        children[parents[i]].push_back(i);
+    m_nodeStorage.assign(parents.size(), VocabularyNode{0, 0, -1, 0});
+    m_centroidStorage.assign(parents.size() * descriptorLength, 0.0f);
+    std::deque<std::pair<uint32_t, uint32_t>> queue; // (original id, new id)
+    queue.emplace_back(0, 0);
+    uint32_t nbAssigned = 1;
+    while (!queue.empty()) {
+        uint32_t original = queue.front().first;
+        uint32_t renumbered = queue.front().second;
+        queue.pop_front();
+        std::copy_n(centroids.begin() + std::size_t(original) * descriptorLength, descriptorLength,
+                    m_centroidStorage.begin() + std::size_t(renumbered) * descriptorLength);
+        VocabularyNode & node = m_nodeStorage[renumbered];
+        if (leaves[original] || children[original].empty()) {
+            node.wordId = static_cast<int32_t>(m_weightStorage.size());
+            m_weightStorage.push_back(weights[original]);
+            continue;
+        }
+        node.firstChild = nbAssigned;
+        node.nbChildren = static_cast<uint32_t>(children[original].size());
+        for (uint32_t child : children[original])
+            queue.emplace_back(child, nbAssigned++);
+    }
+
+    m_nodes = m_nodeStorage.data();
+    m_centroids = m_centroidStorage.data();
+    m_weights = m_weightStorage.data();
+    m_descriptorLength = descriptorLength;
+    m_nbNodes = static_cast<uint32_t>(m_nodeStorage.size());
+    m_nbWords = static_cast<uint32_t>(m_weightStorage.size());
+    return true;
+}
+
+FrameworkReturnCode SolARBoWVocabularyPopSift::saveVocabulary(const std::string & path) const
+{
+    if (m_nodes == nullptr) {
+        LOG_ERROR("SolARBoWVocabularyPopSift::saveVocabulary no vocabulary loaded");
+        return FrameworkReturnCode::_ERROR_;
+    }
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        LOG_ERROR("SolARBoWVocabularyPopSift::saveVocabulary cannot open {}", path);
+        return FrameworkReturnCode::_ERROR_;
+    }
+    VocabularyHeader header;
+    fillHeader(header, m_descriptorLength, m_nbNodes, m_nbWords);
+    const char padding[sectionAlignment] = {};
+    auto writeSection = [&](uint64_t offset, const void * data, std::size_t size) {
+        uint64_t position = static_cast<uint64_t>(file.tellp());
+        file.write(padding, static_cast<std::streamsize>(offset - position));
+        file.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+    };
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    writeSection(header.nodesOffset, m_nodes, std::size_t(m_nbNodes) * sizeof(VocabularyNode));
+    writeSection(header.centroidsOffset, m_centroids, std::size_t(m_nbNodes) * m_descriptorLength * sizeof(float));
+    writeSection(header.weightsOffset, m_weights, std::size_t(m_nbWords) * sizeof(float));
+    if (!file) {
+        LOG_ERROR("SolARBoWVocabularyPopSift::saveVocabulary failed to write {}", path);
+        return FrameworkReturnCode::_ERROR_;
+    }
+    return FrameworkReturnCode::_SUCCESS;
+}
+
+void SolARBoWVocabularyPopSift::quantizeBlock(const float * descriptors, uint32_t nbDescriptors, uint32_t * words) const
+{
+    std::vector<uint32_t> current(nbDescriptors, 0);
+    std::vector<uint32_t> order(nbDescriptors);
+    std::vector<float> distances;
+    std::iota(order.begin(), order.end(), 0);
+
+    // descend the tree level by level: the descriptors sharing the same node are compared together to its children
+    bool descending = true;
+    while (descending) {
+        descending = false;
+        std::stable_sort(order.begin(), order.end(), [&current](uint32_t a, uint32_t b) { return current[a] < current[b]; });
+        for (uint32_t i = 0; i < nbDescriptors; ++i) {
+            const VocabularyNode & node = m_nodes[current[order[i]]];
+            if (node.nbChildren == 0)
+                continue;
+            descending = true;
+            const float * children = m_centroids + std::size_t(node.firstChild) * m_descriptorLength;
+            distances.resize(node.nbChildren);
+            uint32_t nodeId = current[order[i]];
+            for (; i < nbDescriptors && current[order[i]] == nodeId; ++i) {
+                uint32_t d = order[i];
+                kernels::l2sqrRows(descriptors + std::size_t(d) * m_descriptorLength, children, node.nbChildren, m_descriptorLength, distances.data());
+                current[d] = node.firstChild + static_cast<uint32_t>(std::min_element(distances.begin(), distances.end()) - distances.begin());
+            }
+            --i;
+        }
+    }
+    for (uint32_t d = 0; d < nbDescriptors; ++d)
+        words[d] = static_cast<uint32_t>(m_nodes[current[d]].wordId);
+}
+
+FrameworkReturnCode SolARBoWVocabularyPopSift::transform(const SRef<DescriptorBuffer> descriptors,
+                                                         BoWVector & bow,
+                                                         std::vector<uint32_t> & words)
+{
+    bow.clear();
+    words.clear();
+    if (m_nodes == nullptr) {
+        LOG_ERROR("SolARBoWVocabularyPopSift::transform no vocabulary loaded");
+        return FrameworkReturnCode::_ERROR_;
+    }
+    if (!descriptors || descriptors->getNbDescriptors() == 0)
+        return FrameworkReturnCode::_SUCCESS;
+    if (descriptors->getDescriptorLength() != m_descriptorLength) {
+        LOG_ERROR("SolARBoWVocabularyPopSift::transform descriptor length {} does not match the vocabulary ({})", descriptors->getDescriptorLength(), m_descriptorLength);
+        return FrameworkReturnCode::_ERROR_;
+    }
+    bool isFloat = descriptors->getDescriptorDataType() == DescriptorDataType::TYPE_32F;
+    if (!isFloat && descriptors->getDescriptorDataType() != DescriptorDataType::TYPE_8U) {
+        LOG_ERROR("SolARBoWVocabularyPopSift::transform only supports 32F and 8U descriptors");
+        return FrameworkReturnCode::_ERROR_;
+    }
+
+    uint32_t nbDescriptors = descriptors->getNbDescriptors();
+    words.resize(nbDescriptors);
+    const unsigned char * data = static_cast<const unsigned char *>(descriptors->data());
+    std::size_t elementSize = isFloat ? sizeof(float) : sizeof(uint8_t);
+    uint32_t nbBlocks = (nbDescriptors + m_blockSize - 1) / m_blockSize;
+
+    // blocks are distributed dynamically: the descent cost varies with the descriptors
+    std::atomic<uint32_t> nextBlock(0);
+    auto worker = [&]() {
+        std::vector<float> converted;
+        for (uint32_t block = nextBlock++; block < nbBlocks; block = nextBlock++) {
+            uint32_t first = block * m_blockSize;
+            uint32_t count = std::min(m_blockSize, nbDescriptors - first);
+            const unsigned char * blockData = data + std::size_t(first) * m_descriptorLength * elementSize;
+            const float * blockDescriptors = reinterpret_cast<const float *>(blockData);
+            if (!isFloat) {
+                converted.resize(std::size_t(count) * m_descriptorLength);
+                kernels::toFloat(blockData, converted.data(), converted.size());
+                blockDescriptors = converted.data();
+            }
+            quantizeBlock(blockDescriptors, count, words.data() + first);
+        }
+    };
+    uint32_t nbWorkers = std::min(m_scheduler->getNbThreads(), nbBlocks);
+    if (nbWorkers <= 1)
+        worker();
+    else {
+        TaskGraph tasks;
+        for (uint32_t t = 0; t < nbWorkers; ++t)
+            tasks.add(worker);
+        m_scheduler->run(tasks);
+    }
+
+    // TF-IDF weighting, L1 normalized
+    std::vector<uint32_t> sorted(words);
+    std::sort(sorted.begin(), sorted.end());
+    float norm = 0.0f;
+    for (std::size_t i = 0; i < sorted.size();) {
+        std::size_t j = i;
+        while (j < sorted.size() && sorted[j] == sorted[i])
+            ++j;
+        float weight = float(j - i) / float(nbDescriptors) * m_weights[sorted[i]];
+        if (weight != 0.0f) {
+            bow.emplace_back(sorted[i], weight);
+            norm += std::abs(weight);
+        }
+        i = j;
+    }
+    if (norm > 0.0f)
+        for (auto & entry : bow)
+            entry.second /= norm;
+    return FrameworkReturnCode::_SUCCESS;
+}
+
+float SolARBoWVocabularyPopSift::score(const BoWVector & bow1, const BoWVector & bow2) const
+{
+    float sum = 0.0f;
+    auto it1 = bow1.begin();
+    auto it2 = bow2.begin();
+    while (it1 != bow1.end() && it2 != bow2.end()) {
+        if (it1->first < it2->first)
+            ++it1;
+        else if (it2->first < it1->first)
+            ++it2;
+        else {
+            sum += std::abs(it1->second) + std::abs(it2->second) - std::abs(it1->second - it2->second);
+            ++it1;
+            ++it2;
+        }
+    }
+    return 0.5f * sum;
+}
+
+FrameworkReturnCode SolARBoWVocabularyPopSift::addToIndex(uint32_t imageId, const BoWVector & bow)
+{
+    if (m_indexedImages.count(imageId) != 0) {
+        LOG_ERROR("SolARBoWVocabularyPopSift::addToIndex image {} is already indexed", imageId);
+        return FrameworkReturnCode::_ERROR_;
+    }
+    for (const auto & entry : bow) {
+        if (entry.first >= m_nbWords) {
+            LOG_ERROR("SolARBoWVocabularyPopSift::addToIndex word {} is not in the vocabulary", entry.first);
+            return FrameworkReturnCode::_ERROR_;
+        }
+    }
+    for (const auto & entry : bow)
+        m_invertedFile[entry.first].emplace_back(imageId, entry.second);
+    m_indexedImages[imageId] = bow;
+    return FrameworkReturnCode::_SUCCESS;
+}
+
+FrameworkReturnCode SolARBoWVocabularyPopSift::removeFromIndex(uint32_t imageId)
+{
+    auto image = m_indexedImages.find(imageId);
+    if (image == m_indexedImages.end()) {
+        LOG_ERROR("SolARBoWVocabularyPopSift::removeFromIndex image {} is not indexed", imageId);
+        return FrameworkReturnCode::_ERROR_;
+    }
+    for (const auto & entry : image->second) {
+        auto & postings = m_invertedFile[entry.first];
+        postings.erase(std::remove_if(postings.begin(), postings.end(),
+                                      [imageId](const std::pair<uint32_t, float> & p) { return p.first == imageId; }),
+                       postings.end());
+    }
+    m_indexedImages.erase(image);
+    return FrameworkReturnCode::_SUCCESS;
+}
+
+void SolARBoWVocabularyPopSift::clearIndex()
+{
+    for (auto & postings : m_invertedFile)
+        postings.clear();
+    m_indexedImages.clear();
+}
+
+FrameworkReturnCode SolARBoWVocabularyPopSift::query(const BoWVector & bow,
+                                                     std::vector<std::pair<uint32_t, float>> & results,
+                                                     uint32_t maxResults) const
+{
+    results.clear();
+    std::unordered_map<uint32_t, float> scores;
+    for (const auto & entry : bow) {
+        if (entry.first >= m_invertedFile.size()) {
+            LOG_ERROR("SolARBoWVocabularyPopSift::query word {} is not in the vocabulary", entry.first);
+            return FrameworkReturnCode::_ERROR_;
+        }
+        float v = std::abs(entry.second);
+        for (const auto & posting : m_invertedFile[entry.first])
+            scores[posting.first] += v + std::abs(posting.second) - std::abs(entry.second - posting.second);
+    }
+    results.reserve(scores.size());
+    for (const auto & s : scores)
+        results.emplace_back(s.first, 0.5f * s.second);
+    auto byScore = [](const std::pair<uint32_t, float> & a, const std::pair<uint32_t, float> & b) {
+        return a.second > b.second || (a.second == b.second && a.first < b.first);
+    };
+    if (maxResults > 0 && maxResults < results.size()) {
+        std::partial_sort(results.begin(), results.begin() + maxResults, results.end(), byScore);
+        results.resize(maxResults);
+    }
+    else
+        std::sort(results.begin(), results.end(), byScore);
+    return FrameworkReturnCode::_SUCCESS;
+}
+
+}
+}
+}
@@ -0,0 +1,64 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "SolARDescriptorsExtractorFromImageClientPopSift.h"
+#include "core/Log.h"
+
+XPCF_DEFINE_FACTORY_CREATE_INSTANCE(SolAR::MODULES::POPSIFT::SolARDescriptorsExtractorFromImageClientPopSift);
+
+namespace xpcf  = org::bcom::xpcf;
+
+namespace SolAR {
+using namespace datastructure;
+namespace MODULES {
+namespace POPSIFT {
+
+SolARDescriptorsExtractorFromImageClientPopSift::SolARDescriptorsExtractorFromImageClientPopSift():ConfigurableBase(xpcf::toUUID<SolARDescriptorsExtractorFromImageClientPopSift>())
+{
+    addInterface<api::features::IDescriptorsExtractorFromImage>(this);
+    declareProperty("serverName", m_serverName);
+    declareProperty("timeout", m_timeout);
+
+    LOG_DEBUG(" SolARDescriptorsExtractorFromImageClientPopSift constructor");
+}
+
+xpcf::XPCFErrorCode SolARDescriptorsExtractorFromImageClientPopSift::onConfigured()
+{
+    LOG_DEBUG(" SolARDescriptorsExtractorFromImageClientPopSift onConfigured");
+
+    // the server may be started later, extract() connects on demand
+    if (m_client.connect(m_serverName) != FrameworkReturnCode::_SUCCESS)
+        LOG_WARNING("SolARDescriptorsExtractorFromImageClientPopSift: extraction server {} not available yet", m_serverName);
+    return xpcf::XPCFErrorCode::_SUCCESS;
+}
+
+FrameworkReturnCode SolARDescriptorsExtractorFromImageClientPopSift::extract(const SRef<Image> image,
+                                                                             std::vector<Keypoint> & keypoints,
+                                                                             SRef<DescriptorBuffer> & descriptors)
+{
+    // a client whose server has stopped is disconnected by the failed extraction: it connects to a restarted server here
+    if (!m_client.isConnected() && m_client.connect(m_serverName) != FrameworkReturnCode::_SUCCESS)
+        return FrameworkReturnCode::_ERROR_;
+    FrameworkReturnCode status = m_client.extract(image, keypoints, descriptors, m_timeout);
+    if (status != FrameworkReturnCode::_SUCCESS)
+        LOG_ERROR("SolARDescriptorsExtractorFromImageClientPopSift: extraction through {} failed", m_serverName);
+    return status;
+}
+
+}
+}
+}
@@ -24,6 +24,9 @@
 #include <popsift/sift_config.h>
 #include <popsift/version.hpp>
 
+#include <chrono>
+#include <cstring>
+
 XPCF_DEFINE_FACTORY_CREATE_INSTANCE(SolAR::MODULES::POPSIFT::SolARDescriptorsExtractorFromImagePopSift);
 
 namespace xpcf  = org::bcom::xpcf;
@@ -33,11 +36,24 @@ using namespace datastructure;
 namespace MODULES {
 namespace POPSIFT {
 
+namespace {
+
+const float popSiftDefaultThreshold = 0.04f;    // contrast threshold of PopSift when none is configured
+
+}
+
 SolARDescriptorsExtractorFromImagePopSift::SolARDescriptorsExtractorFromImagePopSift():ConfigurableBase(xpcf::toUUID<SolARDescriptorsExtractorFromImagePopSift>())
 {
     addInterface<api::features::IDescriptorsExtractorFromImage>(this);
+    addInterface<api::features::IKeypointDetector>(this);
+    addInterface<api::features::IDescriptorsExtractor>(this);
+    addInterface<IPopSiftQualityControl>(this);
+    addInterface<IPopSiftWarmup>(this);
+    addInterface<IPopSiftBinaryCodes>(this);
     declareProperty("mode",m_mode);
     declareProperty("imageMode", m_imageMode);
+    declareProperty("normMode", m_normMode);
+    declareProperty("descriptorType", m_descriptorType);
     declareProperty("nbOctaves",m_nbOctaves);
     declareProperty("nbLevelPerOctave",m_nbLevelPerOctave);
     declareProperty("sigma",m_sigma);
@@ -46,6 +62,20 @@ SolARDescriptorsExtractorFromImagePopSift::SolARDescriptorsExtractorFromImagePop
     declareProperty("downsampling",m_downsampling);
     declareProperty("initialBlur",m_initialBlur);
     declareProperty("maxTotalKeypoints",m_maxTotalKeypoints);
+    declareProperty("detection",m_detection);
+    declareProperty("denseStride",m_denseStride);
+    declarePropertySequence("denseScales",m_denseScales);
+    declareProperty("nbThreads",m_nbThreads);
+    declareProperty("pinWorkers",m_pinWorkers);
+    declareProperty("targetLatency",m_targetLatency);
+    declareProperty("maxThreshold",m_maxThreshold);
+    declareProperty("minTotalKeypoints",m_minTotalKeypoints);
+    declareProperty("maxFirstOctave",m_maxFirstOctave);
+    declareProperty("asyncWarmup",m_asyncWarmup);
+    declareProperty("warmupWidth",m_warmupWidth);
+    declareProperty("warmupHeight",m_warmupHeight);
+    declareProperty("binaryProjection",m_binaryProjection);
+    declareProperty("binarySeed",m_binarySeed);
 
     m_popSift = NULL;
 
@@ -54,19 +84,83 @@ SolARDescriptorsExtractorFromImagePopSift::SolARDescriptorsExtractorFromImagePop
 }
 
 SolARDescriptorsExtractorFromImagePopSift::~SolARDescriptorsExtractorFromImagePopSift(){
-    m_popSift->uninit();
-    delete m_popSift;
+    m_warmup.join();
+    releaseDetection();
+    if (m_popSift != NULL) {
+        m_popSift->uninit();
+        delete m_popSift;
+    }
 }
 
 xpcf::XPCFErrorCode SolARDescriptorsExtractorFromImagePopSift::onConfigured()
 {
+    auto configureStart = Warmup::Clock::now();
     LOG_INFO(" SolARDescriptorsExtractorFromImagePopSift onConfigured");
+    // the warm-up of the previous configuration uses the context and the settings changed below
+    m_warmup.join();
+    // features detected with the previous settings cannot be described anymore
+    releaseDetection();
+
+    m_binaryEmbedding = BinarySiftEmbedding();
+    if (m_binaryProjection == "random")
+        m_binaryEmbedding.setRandom(m_binarySeed);
+    else if (!m_binaryProjection.empty() && !m_binaryEmbedding.load(m_binaryProjection)) {
+        LOG_ERROR("SolARDescriptorsExtractorFromImagePopSift cannot load the binary projection {}", m_binaryProjection);
+        return xpcf::XPCFErrorCode::_FAIL;
+    }
+
+    // the string properties are resolved once, the kernels of the dense extraction are selected from them
+    if (!kernels::parseInputType(m_imageMode, m_inputType)) {
+        LOG_INFO("imageMode for SolARDescriptorsExtractorFromImagePopSift is {}. It should be whether Float or Unsigned Char. It is set by default to Unsigned Char.", m_imageMode);
+        m_inputType = kernels::InputType::Byte;
+    }
+    kernels::NormMode normMode = kernels::NormMode::RootSift;
+    if (!kernels::parseNormMode(m_normMode, normMode))
+        LOG_INFO("{} is not a valid normMode for PopSift Descriptor Extractor. Set to RootSift. Valid values are RootSift, Classic", m_normMode);
+    m_rootSift = (normMode == kernels::NormMode::RootSift);
+    kernels::DescriptorType descriptorType = kernels::DescriptorType::Float;
+    if (!kernels::parseDescriptorType(m_descriptorType, descriptorType))
+        LOG_INFO("{} is not a valid descriptorType for PopSift Descriptor Extractor. Set to Float. Valid values are Float, Unsigned Char", m_descriptorType);
 
-    popsift::cuda::device_prop_t deviceInfo;
-    deviceInfo.set(0, true);
+    if (m_detection != "detector" && m_detection != "dense")
+        LOG_INFO("{} is not a valid detection for PopSift Descriptor Extractor. Set to detector. Valid values are detector, dense", m_detection);
+    m_denseDetection = (m_detection == "dense");
+    if (m_denseDetection)
+    {
+        // the dense grid is computed on CPU, no PopSift context is needed
+        DenseSiftConfig denseConfig;
+        if (m_sigma > 0)
+            denseConfig.sigma = m_sigma;
+        if (m_initialBlur > 0)
+            denseConfig.initialBlur = m_initialBlur;
+        denseConfig.stride = m_denseStride;
+        if (!m_denseScales.empty())
+            denseConfig.scales = m_denseScales;
+        denseConfig.normMode = normMode;
+        denseConfig.descriptorType = descriptorType;
+        denseConfig.nbThreads = m_nbThreads > 0 ? uint32_t(m_nbThreads) : 0;
+        denseConfig.pinWorkers = m_pinWorkers != 0;
+        m_denseSift.setConfig(denseConfig);
+        if (m_popSift != NULL) {
+            m_popSift->uninit();
+            delete m_popSift;
+            m_popSift = NULL;
+        }
+        // the task graphs of the expected image size are built and the workers started by a first extraction
+        std::vector<WarmupStage> stages;
+        if (m_warmupWidth > 0 && m_warmupHeight > 0)
+            stages.push_back({ &StartupMetrics::primingTime, [this]() { primeDenseSift(); } });
+        m_warmup.start(configureStart, std::move(stages), m_asyncWarmup != 0, false);
+        LOG_INFO("SolARDescriptorsExtractorFromImagePopSift dense detection, stride {}, {} scales, {} threads", m_denseStride, denseConfig.scales.size(), m_denseSift.getNbThreads());
+        return xpcf::XPCFErrorCode::_SUCCESS;
+    }
 
-    // reset configuration
+    if (descriptorType != kernels::DescriptorType::Float)
+        LOG_WARNING("PopSift detection computes float descriptors, descriptorType {} is only used by dense detection", m_descriptorType);
 
+    // reset configuration: the settings degraded by the quality controller, and the properties of the previous
+    // configuration left to their default, must not survive a reconfiguration
+    config = popsift::Config();
     if (m_nbOctaves >0)
         config.setOctaves(m_nbOctaves);
     if (m_nbLevelPerOctave >0)
@@ -85,6 +179,19 @@ xpcf::XPCFErrorCode SolARDescriptorsExtractorFromImagePopSift::onConfigured()
     config.setNormMode(m_rootSift ? popsift::Config::RootSift : popsift::Config::Classic);
     config.setFilterSorting(popsift::Config::LargestScaleFirst);
 
+    // the quality controller starts from the configured settings
+    QualityControllerConfig qualityConfig;
+    qualityConfig.targetLatency = m_targetLatency;
+    qualityConfig.base.threshold = m_threshold > 0 ? m_threshold : popSiftDefaultThreshold;
+    qualityConfig.base.maxKeypoints = m_maxTotalKeypoints;
+    qualityConfig.base.firstOctave = 0;
+    qualityConfig.maxThreshold = m_maxThreshold;
+    qualityConfig.minKeypoints = m_minTotalKeypoints;
+    qualityConfig.maxFirstOctave = m_maxFirstOctave > 0 ? uint32_t(m_maxFirstOctave) : 0;
+    m_qualityController.setConfig(qualityConfig);
+    m_appliedSettings = qualityConfig.base;
+    m_baseDownsampling = m_downsampling > 0 ? m_downsampling : -1.0f; // PopSift default upscales the input
+
     if (m_mode=="PopSift")
         config.setMode(popsift::Config::SiftMode::PopSift);
     else if (m_mode=="OpenCV")
@@ -103,58 +210,71 @@ xpcf::XPCFErrorCode SolARDescriptorsExtractorFromImagePopSift::onConfigured()
 #else
     config.setLogMode(popsift::Config::LogMode::None);
 #endif
-    LOG_INFO("SolARDescriptorsExtractorFromImagePopSift Create popSift object");
-    if (m_popSift != NULL)
-        delete m_popSift;
 
-    if (m_imageMode=="Float")
-        m_popSift = new PopSift( config,
-                                 popsift::Config::ExtractingMode,
-                                 PopSift::FloatImages );
-    else if (m_imageMode=="Unsigned Char")
-        m_popSift = new PopSift( config,
-                                 popsift::Config::ExtractingMode,
-                                 PopSift::ByteImages );
-    else
-    {
-        LOG_INFO("imageMode for SolARDescriptorsExtractorFromImagePopSift is {}. It should be whether Float or Unsigned Char. It is set by default to Unsigned Char.", m_imageMode);
-        m_popSift = new PopSift( config,
-                                 popsift::Config::ExtractingMode,
-                                 PopSift::ByteImages );
-    }
+    // the device query, the context creation and the first allocations run off the caller's critical path. The
+    // context of the previous configuration is reconfigured when it was created for the same image type.
+    bool reuseContext = m_popSift != NULL && m_contextInputType == m_inputType;
+    std::vector<WarmupStage> stages;
+    if (!m_deviceQueried)
+        stages.push_back({ &StartupMetrics::deviceQueryTime, [this]() {
+            popsift::cuda::device_prop_t deviceInfo;
+            deviceInfo.set(0, true);
+            m_deviceQueried = true;
+        }});
+    stages.push_back({ &StartupMetrics::contextTime, [this, reuseContext]() {
+        if (reuseContext) {
+            if (!configurePopSift())
+                m_warmup.setContextReused(false);
+            return;
+        }
+        LOG_INFO("SolARDescriptorsExtractorFromImagePopSift Create popSift object");
+        createPopSift();
+    }});
+    if (m_warmupWidth > 0 && m_warmupHeight > 0)
+        stages.push_back({ &StartupMetrics::primingTime, [this]() { primePopSift(); } });
+    m_warmup.start(configureStart, std::move(stages), m_asyncWarmup != 0, reuseContext);
     return xpcf::XPCFErrorCode::_SUCCESS;
 }
 
-FrameworkReturnCode SolARDescriptorsExtractorFromImagePopSift::extract(
-                           const SRef<datastructure::Image> image,
-                           std::vector<datastructure::Keypoint> & keypoints,
-                           SRef<SolAR::datastructure::DescriptorBuffer> & descriptors ) {
-
-    LOG_DEBUG("SolARDescriptorsExtractorFromImagePopSift::extract Begin");
-    if (image->getDataType() == Image::DataType::TYPE_32U  && m_imageMode != "Float")
+bool SolARDescriptorsExtractorFromImagePopSift::checkImage(const SRef<datastructure::Image> image) const
+{
+    if (image->getDataType() == Image::DataType::TYPE_32U  && m_inputType != kernels::InputType::Float)
     {
         LOG_ERROR("Image format on 32 bits per component, imageMode of PopSift Descriptor extractor should be set to Float");
-        return FrameworkReturnCode::_ERROR_;
+        return false;
     }
-    else if (image->getDataType() == Image::DataType::TYPE_8U  && m_imageMode != "Unsigned Char")
+    else if (image->getDataType() == Image::DataType::TYPE_8U  && m_inputType != kernels::InputType::Byte)
     {
         LOG_ERROR("Image format on 8 bits per component, imageMode of PopSift Descriptor extractor should be set to Unsigned Char");
-        return FrameworkReturnCode::_ERROR_;
+        return false;
     }
+    return true;
+}
+
+// Runs a PopSift job and converts its features to keypoints. The returned features are owned by the caller.
+popsift::FeaturesHost * SolARDescriptorsExtractorFromImagePopSift::detectPopSift(
+                           const SRef<datastructure::Image> image,
+                           std::vector<datastructure::Keypoint> & keypoints,
+                           std::vector<const popsift::Descriptor *> * keypointDescriptors,
+                           float & detectionTime)
+{
+    applyQualitySettings(m_qualityController.getSettings());
 
     PopSift::AllocTest allocTestError = m_popSift->testTextureFit(image->getWidth(), image->getHeight());
     if (allocTestError!=PopSift::AllocTest::Ok)
         LOG_ERROR("{}",m_popSift->testTextureFitErrorString(allocTestError,image->getWidth(), image->getHeight()));
 
+    auto start = std::chrono::steady_clock::now();
     SiftJob* job;
-    if (m_imageMode == "Unsigned Char")
+    if (m_inputType == kernels::InputType::Byte)
         job = m_popSift->enqueue(image->getWidth(), image->getHeight(), (unsigned char*)image->data());
-    else if (m_imageMode == "Float")
-        job = m_popSift->enqueue(image->getWidth(), image->getHeight(), (float*)image->data());
     else
-        return FrameworkReturnCode::_ERROR_;
+        job = m_popSift->enqueue(image->getWidth(), image->getHeight(), (float*)image->data());
 
     popsift::FeaturesHost* popFeatures = job->getHost();
+    // the features and the job are owned by the caller of enqueue
+    delete job;
+    detectionTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
 
       int id=0;
     for(const auto& popFeat: *popFeatures)
@@ -172,15 +292,238 @@ FrameworkReturnCode SolARDescriptorsExtractorFromImagePopSift::extract(
                   popFeat.orientation[orientationIndex]);
 
           keypoints.push_back(kp);
+          if (keypointDescriptors)
+              keypointDescriptors->push_back(popFeat.desc[orientationIndex]);
         }
     }
+
+    LOG_DEBUG("{} keypoints were detected by PopSift", id);
+    return popFeatures;
+}
+
+FrameworkReturnCode SolARDescriptorsExtractorFromImagePopSift::extract(
+                           const SRef<datastructure::Image> image,
+                           std::vector<datastructure::Keypoint> & keypoints,
+                           SRef<SolAR::datastructure::DescriptorBuffer> & descriptors ) {
+
+    LOG_DEBUG("SolARDescriptorsExtractorFromImagePopSift::extract Begin");
+    keypoints.clear();
+    if (!checkImage(image) || !waitForWarmup())
+        return FrameworkReturnCode::_ERROR_;
+
+    if (m_denseDetection)
+        return m_denseSift.extract(image, keypoints, descriptors);
+
+    auto start = std::chrono::steady_clock::now();
+    float detectionTime = 0.0f;
+    popsift::FeaturesHost* popFeatures = detectPopSift(image, keypoints, nullptr, detectionTime);
     descriptors.reset( new DescriptorBuffer((unsigned char*)popFeatures->getDescriptors(), DescriptorType::SIFT, DescriptorDataType::TYPE_32F, 128, popFeatures->getDescriptorCount())) ;
+    // the descriptor buffer holds its own copy
+    delete popFeatures;
 
-    LOG_DEBUG("{} keypoints were detected by PopSift", id-1);
+    float totalTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    m_qualityController.update(detectionTime, totalTime - detectionTime, uint32_t(keypoints.size()));
 
     return FrameworkReturnCode::_SUCCESS;
 }
 
+FrameworkReturnCode SolARDescriptorsExtractorFromImagePopSift::extractWithCodes(const SRef<datastructure::Image> image,
+                                                                            std::vector<datastructure::Keypoint> & keypoints,
+                                                                            SRef<DescriptorBuffer> & descriptors,
+                                                                            SRef<DescriptorBuffer> & codes)
+{
+    if (!m_binaryEmbedding.isValid()) {
+        LOG_ERROR("binaryProjection of SolARDescriptorsExtractorFromImagePopSift must be set to compute binary codes");
+        return FrameworkReturnCode::_ERROR_;
+    }
+    if (extract(image, keypoints, descriptors) != FrameworkReturnCode::_SUCCESS)
+        return FrameworkReturnCode::_ERROR_;
+    return m_binaryEmbedding.encode(descriptors, codes);
+}
+
+FrameworkReturnCode SolARDescriptorsExtractorFromImagePopSift::encode(const SRef<DescriptorBuffer> descriptors, SRef<DescriptorBuffer> & codes)
+{
+    return m_binaryEmbedding.encode(descriptors, codes);
+}
+
+void SolARDescriptorsExtractorFromImagePopSift::setType(api::features::KeypointDetectorType type)
+{
+    if (type != api::features::KeypointDetectorType::SIFT)
+        LOG_WARNING("SolARDescriptorsExtractorFromImagePopSift only detects SIFT keypoints");
+}
+
+void SolARDescriptorsExtractorFromImagePopSift::detect(const SRef<datastructure::Image> image,
+                                                       std::vector<datastructure::Keypoint> & keypoints)
+{
+    keypoints.clear();
+    releaseDetection();
+    if (!checkImage(image) || !waitForWarmup())
+        return;
+
+    // the grid pyramid stays resident in the dense extractor
+    if (m_denseDetection) {
+        m_denseSift.detect(image, keypoints);
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    float detectionTime = 0.0f;
+    m_detectedFeatures = detectPopSift(image, keypoints, &m_detectedDescriptors, detectionTime);
+    m_detectedImage = image;
+    m_detectedKeypoints = keypoints;
+
+    float totalTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    m_qualityController.update(detectionTime, totalTime - detectionTime, uint32_t(keypoints.size()));
+}
+
+void SolARDescriptorsExtractorFromImagePopSift::extract(const SRef<datastructure::Image> image,
+                                                        const std::vector<datastructure::Keypoint> & inputKeypoints,
+                                                        SRef<datastructure::DescriptorBuffer> & descriptors)
+{
+    if (m_denseDetection) {
+        if (checkImage(image) && waitForWarmup())
+            m_denseSift.describe(image, inputKeypoints, descriptors);
+        return;
+    }
+
+    if (!m_detectedFeatures || image != m_detectedImage) {
+        LOG_ERROR("SolARDescriptorsExtractorFromImagePopSift describes the keypoints returned by detect() on the same image");
+        descriptors.reset(new DescriptorBuffer(DescriptorType::SIFT, DescriptorDataType::TYPE_32F, 128, 0));
+        return;
+    }
+
+    // PopSift describes every keypoint on the GPU during detection: only the descriptors of the kept keypoints are gathered
+    descriptors.reset(new DescriptorBuffer(DescriptorType::SIFT, DescriptorDataType::TYPE_32F, 128, uint32_t(inputKeypoints.size())));
+    float * output = static_cast<float *>(descriptors->data());
+    for (const auto & keypoint : inputKeypoints) {
+        uint32_t id = keypoint.getId();
+        if (id >= m_detectedKeypoints.size() ||
+            keypoint.getX() != m_detectedKeypoints[id].getX() || keypoint.getY() != m_detectedKeypoints[id].getY()) {
+            LOG_ERROR("Keypoint {} was not returned by the last detection", id);
+            descriptors.reset(new DescriptorBuffer(DescriptorType::SIFT, DescriptorDataType::TYPE_32F, 128, 0));
+            return;
+        }
+        std::copy(m_detectedDescriptors[id]->features, m_detectedDescriptors[id]->features + 128, output);
+        output += 128;
+    }
+}
+
+void SolARDescriptorsExtractorFromImagePopSift::releaseDetection()
+{
+    delete m_detectedFeatures;
+    m_detectedFeatures = nullptr;
+    m_detectedImage.reset();
+    m_detectedKeypoints.clear();
+    m_detectedDescriptors.clear();
+}
+
+void SolARDescriptorsExtractorFromImagePopSift::setTargetLatency(float targetLatency)
+{
+    if (m_denseDetection)
+    {
+        LOG_WARNING("SolARDescriptorsExtractorFromImagePopSift quality control is only available with the detector");
+        return;
+    }
+    m_targetLatency = targetLatency;
+    m_qualityController.setTargetLatency(targetLatency);
+}
+
+QualityState SolARDescriptorsExtractorFromImagePopSift::getQualityState() const
+{
+    return m_qualityController.getState();
+}
+
+bool SolARDescriptorsExtractorFromImagePopSift::isReady() const
+{
+    return m_warmup.isReady();
+}
+
+bool SolARDescriptorsExtractorFromImagePopSift::waitUntilReady(float timeout)
+{
+    return m_warmup.waitUntilReady(timeout);
+}
+
+StartupMetrics SolARDescriptorsExtractorFromImagePopSift::getStartupMetrics() const
+{
+    return m_warmup.getMetrics();
+}
+
+bool SolARDescriptorsExtractorFromImagePopSift::waitForWarmup()
+{
+    if (m_warmup.waitForFrame())
+        return true;
+    LOG_ERROR("SolARDescriptorsExtractorFromImagePopSift warm-up failed, the component must be configured again");
+    return false;
+}
+
+// Dummy job of the expected image size: the buffers of the pyramid and of the features are allocated before the first frame
+void SolARDescriptorsExtractorFromImagePopSift::primePopSift()
+{
+    SiftJob* job;
+    std::size_t nbPixels = std::size_t(m_warmupWidth) * m_warmupHeight;
+    if (m_inputType == kernels::InputType::Byte) {
+        std::vector<unsigned char> pixels(nbPixels, 0);
+        job = m_popSift->enqueue(m_warmupWidth, m_warmupHeight, pixels.data());
+        delete job->getHost();
+    }
+    else {
+        std::vector<float> pixels(nbPixels, 0.0f);
+        job = m_popSift->enqueue(m_warmupWidth, m_warmupHeight, pixels.data());
+        delete job->getHost();
+    }
+    delete job;
+}
+
+void SolARDescriptorsExtractorFromImagePopSift::primeDenseSift()
+{
+    bool isFloat = m_inputType == kernels::InputType::Float;
+    SRef<Image> image(new Image(m_warmupWidth, m_warmupHeight, Image::ImageLayout::LAYOUT_GREY, Image::PixelOrder::INTERLEAVED,
+                                isFloat ? Image::DataType::TYPE_32U : Image::DataType::TYPE_8U));
+    std::memset(image->data(), 0, image->getBufferSize());
+    std::vector<Keypoint> keypoints;
+    SRef<DescriptorBuffer> descriptors;
+    m_denseSift.extract(image, keypoints, descriptors);
+}
+
+// Applies the settings degraded or restored by the quality controller to the PopSift context
+void SolARDescriptorsExtractorFromImagePopSift::applyQualitySettings(const QualitySettings & settings)
+{
+    if (settings.threshold == m_appliedSettings.threshold &&
+        settings.maxKeypoints == m_appliedSettings.maxKeypoints &&
+        settings.firstOctave == m_appliedSettings.firstOctave)
+        return;
+    config.setThreshold(settings.threshold);
+    if (settings.maxKeypoints > 0)
+        config.setFilterMaxExtrema((size_t)settings.maxKeypoints);
+    config.setDownsampling(m_baseDownsampling + float(settings.firstOctave));
+    configurePopSift();
+    m_appliedSettings = settings;
+}
+
+// PopSift refuses a new configuration once the first job has allocated its pyramid: the context is then recreated,
+// its buffers being allocated again by the next job. Returns false if the context was recreated.
+bool SolARDescriptorsExtractorFromImagePopSift::configurePopSift()
+{
+    if (m_popSift->configure(config, true))
+        return true;
+    LOG_INFO("SolARDescriptorsExtractorFromImagePopSift recreates the popSift object to apply its new configuration");
+    createPopSift();
+    return false;
+}
+
+void SolARDescriptorsExtractorFromImagePopSift::createPopSift()
+{
+    if (m_popSift != NULL) {
+        m_popSift->uninit();
+        delete m_popSift;
+        // a failed creation must not leave a freed context to be reused or deleted again
+        m_popSift = NULL;
+    }
+    m_popSift = new PopSift( config,
+                             popsift::Config::ExtractingMode,
+                             m_inputType == kernels::InputType::Float ? PopSift::FloatImages : PopSift::ByteImages );
+    m_contextInputType = m_inputType;
+}
 
 }
 }
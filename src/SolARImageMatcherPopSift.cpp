@@ -33,11 +33,34 @@ using namespace datastructure;
 namespace MODULES {
 namespace POPSIFT {
 
+namespace {
+
+// Keypoints and descriptors of the features extracted by a job, one keypoint per orientation
+SRef<DescriptorBuffer> convertFeatures(popsift::FeaturesHost* features, std::vector<Keypoint> & keypoints)
+{
+    int id = 0;
+    for (const auto& feature : *features)
+    {
+        for (int orientationIndex = 0; orientationIndex < feature.num_ori; ++orientationIndex)
+        {
+            Keypoint kp;
+            kp.init(id++, feature.xpos, feature.ypos, 0.0f, 0.0f, 0.0f, feature.sigma, feature.orientation[orientationIndex]);
+            keypoints.push_back(kp);
+        }
+    }
+    return SRef<DescriptorBuffer>(new DescriptorBuffer((unsigned char*)features->getDescriptors(), DescriptorType::SIFT, DescriptorDataType::TYPE_32F, 128, features->getDescriptorCount()));
+}
+
+}
+
 SolARImageMatcherPopSift::SolARImageMatcherPopSift():ConfigurableBase(xpcf::toUUID<SolARImageMatcherPopSift>())
 {
     addInterface<api::features::IImageMatcher>(this);
+    addInterface<IPopSiftWarmup>(this);
+    addInterface<IPopSiftStereoMatcher>(this);
     declareProperty("mode",m_mode);
     declareProperty("imageMode", m_imageMode);
+    declareProperty("normMode", m_normMode);
     declareProperty("nbOctaves",m_nbOctaves);
     declareProperty("nbLevelPerOctave",m_nbLevelPerOctave);
     declareProperty("sigma",m_sigma);
@@ -46,22 +69,55 @@ SolARImageMatcherPopSift::SolARImageMatcherPopSift():ConfigurableBase(xpcf::toUU
     declareProperty("downsampling",m_downsampling);
     declareProperty("initialBlur",m_initialBlur);
     declareProperty("maxTotalKeypoints",m_maxTotalKeypoints);
-
+    declareProperty("matchingMode",m_matchingMode);
+    declareProperty("rowTolerance",m_rowTolerance);
+    declareProperty("minDisparity",m_minDisparity);
+    declareProperty("maxDisparity",m_maxDisparity);
+    declareProperty("stereoRatio",m_stereoRatio);
+    declareProperty("stereoMaxDistance",m_stereoMaxDistance);
+    declareProperty("asyncWarmup",m_asyncWarmup);
+    declareProperty("warmupWidth",m_warmupWidth);
+    declareProperty("warmupHeight",m_warmupHeight);
+
+    m_popSift = NULL;
 
     LOG_DEBUG(" SolARImageMatcherPopSift constructor");
 }
 
 SolARImageMatcherPopSift::~SolARImageMatcherPopSift(){
-    m_popSift->uninit();
-    delete m_popSift;
+    m_warmup.join();
+    if (m_popSift != NULL) {
+        m_popSift->uninit();
+        delete m_popSift;
+    }
 }
 
 xpcf::XPCFErrorCode SolARImageMatcherPopSift::onConfigured()
 {
+    auto configureStart = Warmup::Clock::now();
     LOG_DEBUG(" SolARImageMatcherPopSift onConfigured");
+    // the warm-up of the previous configuration uses the context and the settings changed below
+    m_warmup.join();
 
-    popsift::cuda::device_prop_t deviceInfo;
-    deviceInfo.set(0, true);
+    if (!kernels::parseInputType(m_imageMode, m_inputType)) {
+        LOG_INFO("imageMode for SolARImageMatcherPopSift is {}. It should be whether Float or Unsigned Char. It is set by default to Unsigned Char.", m_imageMode);
+        m_inputType = kernels::InputType::Byte;
+    }
+    kernels::NormMode normMode = kernels::NormMode::RootSift;
+    if (!kernels::parseNormMode(m_normMode, normMode))
+        LOG_INFO("{} is not a valid normMode for PopSift Image Matcher. Set to RootSift. Valid values are RootSift, Classic", m_normMode);
+    m_rootSift = (normMode == kernels::NormMode::RootSift);
+
+    if (m_matchingMode != "all" && m_matchingMode != "stereo")
+        LOG_INFO("{} is not a valid matchingMode for PopSift Image Matcher. Set to all. Valid values are all, stereo", m_matchingMode);
+    m_stereo = (m_matchingMode == "stereo");
+    StereoMatcherConfig stereoConfig;
+    stereoConfig.rowTolerance = m_rowTolerance;
+    stereoConfig.minDisparity = m_minDisparity;
+    stereoConfig.maxDisparity = m_maxDisparity;
+    stereoConfig.ratio = m_stereoRatio;
+    stereoConfig.maxDistance = m_stereoMaxDistance;
+    m_stereoMatcher.setConfig(stereoConfig);
 
     // reset configuration
 
@@ -95,8 +151,6 @@ xpcf::XPCFErrorCode SolARImageMatcherPopSift::onConfigured()
         config.setMode(popsift::Config::SiftMode::PopSift);
     }
 
-    config.setNormMode(popsift::Config::NormMode::RootSift);
-
 
 #ifdef DEBUG
     config.setLogMode(popsift::Config::LogMode::All);
@@ -104,24 +158,47 @@ xpcf::XPCFErrorCode SolARImageMatcherPopSift::onConfigured()
     config.setLogMode(popsift::Config::LogMode::None);
 #endif
 
-    if (m_imageMode=="Float")
-        m_popSift = new PopSift( config,
-                                 popsift::Config::MatchingMode,
-                                 PopSift::FloatImages );
-    else if (m_imageMode=="Unsigned Char")
-        m_popSift = new PopSift( config,
-                                 popsift::Config::MatchingMode,
-                                 PopSift::ByteImages );
-    else
-    {
-        LOG_INFO("imageMode for SolARImageMatcherPopSift is {}. It should be whether Float or Unsigned Char. It is set by default to Unsigned Char.", m_imageMode);
-        m_popSift = new PopSift( config,
-                                 popsift::Config::MatchingMode,
-                                 PopSift::ByteImages );
-    }
+    // same warm-up as the extractor: the previous context is reconfigured when it was created for the same image type
+    // and processing mode, the stereo matching extracting the features to the host
+    bool reuseContext = m_popSift != NULL && m_contextInputType == m_inputType && m_contextStereo == m_stereo;
+    std::vector<WarmupStage> stages;
+    if (!m_deviceQueried)
+        stages.push_back({ &StartupMetrics::deviceQueryTime, [this]() {
+            popsift::cuda::device_prop_t deviceInfo;
+            deviceInfo.set(0, true);
+            m_deviceQueried = true;
+        }});
+    stages.push_back({ &StartupMetrics::contextTime, [this, reuseContext]() {
+        // PopSift refuses a new configuration once the first job has allocated its pyramid: the context is then recreated
+        if (reuseContext) {
+            if (m_popSift->configure(config, true))
+                return;
+            LOG_INFO("SolARImageMatcherPopSift recreates the popSift object to apply its new configuration");
+            m_warmup.setContextReused(false);
+        }
+        createPopSift();
+    }});
+    if (m_warmupWidth > 0 && m_warmupHeight > 0)
+        stages.push_back({ &StartupMetrics::primingTime, [this]() { primePopSift(); } });
+    m_warmup.start(configureStart, std::move(stages), m_asyncWarmup != 0, reuseContext);
     return xpcf::XPCFErrorCode::_SUCCESS;
 }
 
+void SolARImageMatcherPopSift::createPopSift()
+{
+    if (m_popSift != NULL) {
+        m_popSift->uninit();
+        delete m_popSift;
+        // a failed creation must not leave a freed context to be reused or deleted again
+        m_popSift = NULL;
+    }
+    m_popSift = new PopSift( config,
+                             m_stereo ? popsift::Config::ExtractingMode : popsift::Config::MatchingMode,
+                             m_inputType == kernels::InputType::Float ? PopSift::FloatImages : PopSift::ByteImages );
+    m_contextInputType = m_inputType;
+    m_contextStereo = m_stereo;
+}
+
 FrameworkReturnCode SolARImageMatcherPopSift::match(
                            const SRef<datastructure::Image> image1,
                            const SRef<datastructure::Image> image2,
@@ -131,32 +208,28 @@ FrameworkReturnCode SolARImageMatcherPopSift::match(
                            SRef<datastructure::DescriptorBuffer> descriptors2,
                            std::vector<datastructure::DescriptorMatch> & matches)
 {
-    if ((image1->getDataType() == Image::DataType::TYPE_32U || image2->getDataType() == Image::DataType::TYPE_32U ) && m_imageMode != "Float")
+    if (m_stereo)
     {
-        LOG_ERROR("Image format on 32 bits per component, imageMode of PopSift Descriptor extractor should be set to Float");
-        return FrameworkReturnCode::_ERROR_;
+        std::vector<float> disparities;
+        return matchStereo(image1, image2, keypoints1, keypoints2, descriptors1, descriptors2, matches, disparities);
     }
-    else if ((image1->getDataType() == Image::DataType::TYPE_8U || image2->getDataType() == Image::DataType::TYPE_8U ) && m_imageMode != "Unsigned Char")
-    {
-        LOG_ERROR("Image format on 8 bits per component, imageMode of PopSift Descriptor extractor should be set to Unsigned Char");
+
+    if (!checkImages(image1, image2) || !waitForWarmup())
         return FrameworkReturnCode::_ERROR_;
-    }
 
     SiftJob* job1;
     SiftJob* job2;
 
-    if (m_imageMode == "Unsigned Char")
+    if (m_inputType == kernels::InputType::Byte)
     {
         job1 = m_popSift->enqueue(image1->getWidth(), image1->getHeight(), (unsigned char*)image1->data());
         job2 = m_popSift->enqueue(image2->getWidth(), image2->getHeight(), (unsigned char*)image2->data());
     }
-    else if (m_imageMode == "Float")
+    else
     {
         job1 = m_popSift->enqueue(image1->getWidth(), image1->getHeight(), (float*)image1->data());
         job2 = m_popSift->enqueue(image2->getWidth(), image2->getHeight(), (float*)image2->data());
     }
-    else
-        return FrameworkReturnCode::_ERROR_;
 
     popsift::FeaturesDev* features1 = job1->getDev();
     popsift::FeaturesDev* features2 = job2->getDev();
@@ -212,9 +285,138 @@ FrameworkReturnCode SolARImageMatcherPopSift::match(
     for (int i = 0; i < features1->getDescriptorCount(); i++)
         matches.push_back(DescriptorMatch(i, matches1[i], 1.0f));
 
+    // the features and the jobs are owned by the caller of enqueue
+    delete features1;
+    delete features2;
+    delete job1;
+    delete job2;
+
     return FrameworkReturnCode::_SUCCESS;
 }
 
+FrameworkReturnCode SolARImageMatcherPopSift::matchStereo(const SRef<datastructure::Image> left,
+                                                          const SRef<datastructure::Image> right,
+                                                          std::vector<datastructure::Keypoint> & leftKeypoints,
+                                                          std::vector<datastructure::Keypoint> & rightKeypoints,
+                                                          SRef<datastructure::DescriptorBuffer> & leftDescriptors,
+                                                          SRef<datastructure::DescriptorBuffer> & rightDescriptors,
+                                                          std::vector<datastructure::DescriptorMatch> & matches,
+                                                          std::vector<float> & disparities)
+{
+    if (!m_stereo)
+    {
+        LOG_ERROR("matchStereo requires the matchingMode of SolARImageMatcherPopSift to be set to stereo");
+        return FrameworkReturnCode::_ERROR_;
+    }
+    if (!checkImages(left, right) || !waitForWarmup())
+        return FrameworkReturnCode::_ERROR_;
+
+    // both images are queued before waiting for the first one: the right image is extracted by the PopSift pipeline
+    // while the features of the left one are converted
+    SiftJob* leftJob;
+    SiftJob* rightJob;
+    if (m_inputType == kernels::InputType::Byte)
+    {
+        leftJob = m_popSift->enqueue(left->getWidth(), left->getHeight(), (unsigned char*)left->data());
+        rightJob = m_popSift->enqueue(right->getWidth(), right->getHeight(), (unsigned char*)right->data());
+    }
+    else
+    {
+        leftJob = m_popSift->enqueue(left->getWidth(), left->getHeight(), (float*)left->data());
+        rightJob = m_popSift->enqueue(right->getWidth(), right->getHeight(), (float*)right->data());
+    }
+
+    popsift::FeaturesHost* leftFeatures = leftJob->getHost();
+    leftDescriptors = convertFeatures(leftFeatures, leftKeypoints);
+    popsift::FeaturesHost* rightFeatures = rightJob->getHost();
+    rightDescriptors = convertFeatures(rightFeatures, rightKeypoints);
+
+    // the descriptor buffers hold their own copy
+    delete leftFeatures;
+    delete rightFeatures;
+    delete leftJob;
+    delete rightJob;
+
+    return m_stereoMatcher.match(leftKeypoints, leftDescriptors, rightKeypoints, rightDescriptors, matches, disparities);
+}
+
+FrameworkReturnCode SolARImageMatcherPopSift::matchRectified(const std::vector<datastructure::Keypoint> & leftKeypoints,
+                                                             const SRef<datastructure::DescriptorBuffer> leftDescriptors,
+                                                             const std::vector<datastructure::Keypoint> & rightKeypoints,
+                                                             const SRef<datastructure::DescriptorBuffer> rightDescriptors,
+                                                             std::vector<datastructure::DescriptorMatch> & matches,
+                                                             std::vector<float> & disparities)
+{
+    return m_stereoMatcher.match(leftKeypoints, leftDescriptors, rightKeypoints, rightDescriptors, matches, disparities);
+}
+
+uint64_t SolARImageMatcherPopSift::getNbDistanceEvaluations() const
+{
+    return m_stereoMatcher.getNbDistanceEvaluations();
+}
+
+bool SolARImageMatcherPopSift::checkImages(const SRef<datastructure::Image> image1, const SRef<datastructure::Image> image2) const
+{
+    if ((image1->getDataType() == Image::DataType::TYPE_32U || image2->getDataType() == Image::DataType::TYPE_32U ) && m_inputType != kernels::InputType::Float)
+    {
+        LOG_ERROR("Image format on 32 bits per component, imageMode of PopSift Descriptor extractor should be set to Float");
+        return false;
+    }
+    else if ((image1->getDataType() == Image::DataType::TYPE_8U || image2->getDataType() == Image::DataType::TYPE_8U ) && m_inputType != kernels::InputType::Byte)
+    {
+        LOG_ERROR("Image format on 8 bits per component, imageMode of PopSift Descriptor extractor should be set to Unsigned Char");
+        return false;
+    }
+    return true;
+}
+
+bool SolARImageMatcherPopSift::waitForWarmup()
+{
+    if (!m_warmup.waitForFrame())
+    {
+        LOG_ERROR("SolARImageMatcherPopSift warm-up failed, the component must be configured again");
+        return false;
+    }
+    return true;
+}
+
+bool SolARImageMatcherPopSift::isReady() const
+{
+    return m_warmup.isReady();
+}
+
+bool SolARImageMatcherPopSift::waitUntilReady(float timeout)
+{
+    return m_warmup.waitUntilReady(timeout);
+}
+
+StartupMetrics SolARImageMatcherPopSift::getStartupMetrics() const
+{
+    return m_warmup.getMetrics();
+}
+
+// Dummy job of the expected image size: the buffers of the pyramid and of the features are allocated before the first pair
+void SolARImageMatcherPopSift::primePopSift()
+{
+    SiftJob* job;
+    std::size_t nbPixels = std::size_t(m_warmupWidth) * m_warmupHeight;
+    if (m_inputType == kernels::InputType::Byte) {
+        std::vector<unsigned char> pixels(nbPixels, 0);
+        job = m_popSift->enqueue(m_warmupWidth, m_warmupHeight, pixels.data());
+    }
+    else {
+        std::vector<float> pixels(nbPixels, 0.0f);
+        job = m_popSift->enqueue(m_warmupWidth, m_warmupHeight, pixels.data());
+    }
+    // the stereo context extracts to the host
+    if (m_stereo)
+        delete job->getHost();
+    else
+        delete job->getDev();
+    delete job;
+}
+
+
 
 }
 }
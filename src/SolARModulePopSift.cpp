@@ -16,6 +16,9 @@
 #include "xpcf/module/ModuleFactory.h"
 #include "SolARDescriptorsExtractorFromImagePopSift.h"
 #include "SolARImageMatcherPopSift.h"
+#include "SolARBoWVocabularyPopSift.h"
+#include "SolARDescriptorsExtractorFromImageClientPopSift.h"
+#include "SolARBinaryDescriptorMatcherPopSift.h"
 
 
 namespace xpcf=org::bcom::xpcf;
@@ -36,6 +39,21 @@ extern "C" XPCF_MODULEHOOKS_API xpcf::XPCFErrorCode XPCF_getComponent(const boos
 
         errCode =  xpcf::tryCreateComponent<SolAR::MODULES::POPSIFT::SolARImageMatcherPopSift>(componentUUID,interfaceRef);
      }
+     if (errCode != xpcf::XPCFErrorCode::_SUCCESS)
+     {
+
+        errCode =  xpcf::tryCreateComponent<SolAR::MODULES::POPSIFT::SolARBoWVocabularyPopSift>(componentUUID,interfaceRef);
+     }
+     if (errCode != xpcf::XPCFErrorCode::_SUCCESS)
+     {
+
+        errCode =  xpcf::tryCreateComponent<SolAR::MODULES::POPSIFT::SolARDescriptorsExtractorFromImageClientPopSift>(componentUUID,interfaceRef);
+     }
+     if (errCode != xpcf::XPCFErrorCode::_SUCCESS)
+     {
+
+        errCode =  xpcf::tryCreateComponent<SolAR::MODULES::POPSIFT::SolARBinaryDescriptorMatcherPopSift>(componentUUID,interfaceRef);
+     }
 
     return errCode;
 }
@@ -43,4 +61,7 @@ extern "C" XPCF_MODULEHOOKS_API xpcf::XPCFErrorCode XPCF_getComponent(const boos
 XPCF_BEGIN_COMPONENTS_DECLARATION
 XPCF_ADD_COMPONENT(SolAR::MODULES::POPSIFT::SolARDescriptorsExtractorFromImagePopSift)
 XPCF_ADD_COMPONENT(SolAR::MODULES::POPSIFT::SolARImageMatcherPopSift)
+XPCF_ADD_COMPONENT(SolAR::MODULES::POPSIFT::SolARBoWVocabularyPopSift)
+XPCF_ADD_COMPONENT(SolAR::MODULES::POPSIFT::SolARDescriptorsExtractorFromImageClientPopSift)
+XPCF_ADD_COMPONENT(SolAR::MODULES::POPSIFT::SolARBinaryDescriptorMatcherPopSift)
 XPCF_END_COMPONENTS_DECLARATION
@@ -0,0 +1,373 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SolARPopSiftBinarySift.h"
+#include "SolARPopSiftKernels.h"
+#include "core/Log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <random>
+
+namespace SolAR {
+using namespace datastructure;
+namespace MODULES {
+namespace POPSIFT {
+
+constexpr uint32_t BinarySiftEmbedding::nbBits;
+constexpr uint32_t BinarySiftEmbedding::nbWords;
+constexpr uint32_t BinarySiftEmbedding::codeSize;
+constexpr uint32_t BinarySiftEmbedding::descriptorLength;
+
+namespace {
+
+constexpr uint32_t nbBits = BinarySiftEmbedding::nbBits;
+constexpr uint32_t descriptorLength = BinarySiftEmbedding::descriptorLength;
+
+// std::normal_distribution differs between standard libraries, the same seed must give the same codes everywhere
+class GaussianGenerator {
+public:
+    explicit GaussianGenerator(uint32_t seed) : m_generator(seed) {}
+
+    float operator()()
+    {
+        if (m_hasSpare) {
+            m_hasSpare = false;
+            return m_spare;
+        }
+        const double u1 = (static_cast<double>(m_generator()) + 1.0) / 4294967297.0;
+        const double u2 = static_cast<double>(m_generator()) / 4294967296.0;
+        const double radius = std::sqrt(-2.0 * std::log(u1));
+        const double angle = 6.283185307179586 * u2;
+        m_spare = static_cast<float>(radius * std::sin(angle));
+        m_hasSpare = true;
+        return static_cast<float>(radius * std::cos(angle));
+    }
+
+private:
+    std::mt19937 m_generator;
+    float m_spare = 0.f;
+    bool m_hasSpare = false;
+};
+
+// directions are stored transposed: the 256 projections are updated together by each element of the descriptor
+void project(const std::vector<float> & directions, const float * descriptor, float * projections)
+{
+    std::fill(projections, projections + nbBits, 0.f);
+    for (uint32_t d = 0; d < descriptorLength; ++d) {
+        const float value = descriptor[d];
+        // SIFT descriptors are sparse
+        if (value == 0.f)
+            continue;
+        const float * row = directions.data() + d * nbBits;
+        for (uint32_t k = 0; k < nbBits; ++k)
+            projections[k] += value * row[k];
+    }
+}
+
+}
+
+void BinarySiftEmbedding::setRandom(uint32_t seed)
+{
+    GaussianGenerator gaussian(seed);
+    m_directions.assign(descriptorLength * nbBits, 0.f);
+    m_thresholds.assign(nbBits, 0.f);
+    float direction[descriptorLength];
+    for (uint32_t k = 0; k < nbBits; ++k) {
+        float sum = 0.f;
+        for (uint32_t d = 0; d < descriptorLength; ++d) {
+            direction[d] = gaussian();
+            sum += direction[d];
+        }
+        const float mean = sum / descriptorLength;
+        for (uint32_t d = 0; d < descriptorLength; ++d)
+            m_directions[d * nbBits + k] = direction[d] - mean;
+    }
+}
+
+bool BinarySiftEmbedding::load(const std::string & path)
+{
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        LOG_ERROR("Cannot open the binary projection file {}", path);
+        return false;
+    }
+    uint32_t fileNbBits = 0, fileDescriptorLength = 0;
+    file >> fileNbBits >> fileDescriptorLength;
+    if (!file || fileNbBits != nbBits || fileDescriptorLength != descriptorLength) {
+        LOG_ERROR("The binary projection file {} must project descriptors of {} elements on {} bits", path, descriptorLength, nbBits);
+        return false;
+    }
+    std::vector<float> directions(descriptorLength * nbBits);
+    std::vector<float> thresholds(nbBits);
+    for (uint32_t k = 0; k < nbBits && file; ++k) {
+        for (uint32_t d = 0; d < descriptorLength; ++d)
+            file >> directions[d * nbBits + k];
+        file >> thresholds[k];
+    }
+    if (!file) {
+        LOG_ERROR("The binary projection file {} is truncated", path);
+        return false;
+    }
+    m_directions.swap(directions);
+    m_thresholds.swap(thresholds);
+    return true;
+}
+
+bool BinarySiftEmbedding::save(const std::string & path) const
+{
+    if (!isValid())
+        return false;
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        LOG_ERROR("Cannot create the binary projection file {}", path);
+        return false;
+    }
+    file << nbBits << " " << descriptorLength << "\n" << std::setprecision(9);
+    for (uint32_t k = 0; k < nbBits; ++k) {
+        for (uint32_t d = 0; d < descriptorLength; ++d)
+            file << m_directions[d * nbBits + k] << " ";
+        file << m_thresholds[k] << "\n";
+    }
+    return static_cast<bool>(file);
+}
+
+void BinarySiftEmbedding::train(const float * descriptors, std::size_t nbDescriptors)
+{
+    if (!isValid() || nbDescriptors == 0)
+        return;
+    std::vector<float> projections(nbDescriptors * nbBits);
+    for (std::size_t i = 0; i < nbDescriptors; ++i)
+        project(m_directions, descriptors + i * descriptorLength, projections.data() + i * nbBits);
+    std::vector<float> values(nbDescriptors);
+    for (uint32_t k = 0; k < nbBits; ++k) {
+        for (std::size_t i = 0; i < nbDescriptors; ++i)
+            values[i] = projections[i * nbBits + k];
+        std::nth_element(values.begin(), values.begin() + nbDescriptors / 2, values.end());
+        m_thresholds[k] = values[nbDescriptors / 2];
+    }
+}
+
+void BinarySiftEmbedding::encode(const float * descriptors, std::size_t nbDescriptors, uint64_t * codes) const
+{
+    float projections[nbBits];
+    for (std::size_t i = 0; i < nbDescriptors; ++i) {
+        project(m_directions, descriptors + i * descriptorLength, projections);
+        uint64_t * code = codes + i * nbWords;
+        for (uint32_t w = 0; w < nbWords; ++w) {
+            uint64_t word = 0;
+            for (uint32_t b = 0; b < 64; ++b)
+                word |= static_cast<uint64_t>(projections[w * 64 + b] > m_thresholds[w * 64 + b]) << b;
+            code[w] = word;
+        }
+    }
+}
+
+FrameworkReturnCode BinarySiftEmbedding::encode(const SRef<DescriptorBuffer> descriptors, SRef<DescriptorBuffer> & codes) const
+{
+    if (!isValid()) {
+        LOG_ERROR("The binary embedding is not initialized");
+        return FrameworkReturnCode::_ERROR_;
+    }
+    if (!descriptors || descriptors->getDescriptorLength() != descriptorLength ||
+        (descriptors->getDescriptorDataType() != DescriptorDataType::TYPE_32F &&
+         descriptors->getDescriptorDataType() != DescriptorDataType::TYPE_8U)) {
+        LOG_ERROR("Binary codes can only be computed from SIFT descriptors of {} elements", descriptorLength);
+        return FrameworkReturnCode::_ERROR_;
+    }
+    const uint32_t nbDescriptors = descriptors->getNbDescriptors();
+    codes = SRef<DescriptorBuffer>(new DescriptorBuffer(DescriptorType::SIFT, DescriptorDataType::TYPE_8U, codeSize, nbDescriptors));
+    uint64_t * output = static_cast<uint64_t *>(codes->data());
+    if (descriptors->getDescriptorDataType() == DescriptorDataType::TYPE_32F) {
+        encode(static_cast<const float *>(descriptors->data()), nbDescriptors, output);
+    }
+    else {
+        const uint8_t * input = static_cast<const uint8_t *>(descriptors->data());
+        float descriptor[descriptorLength];
+        for (uint32_t i = 0; i < nbDescriptors; ++i) {
+            kernels::toFloat(input + i * descriptorLength, descriptor, descriptorLength);
+            encode(descriptor, 1, output + i * nbWords);
+        }
+    }
+    return FrameworkReturnCode::_SUCCESS;
+}
+
+namespace {
+
+bool checkCodes(const SRef<DescriptorBuffer> & codes)
+{
+    return codes && codes->getDescriptorDataType() == DescriptorDataType::TYPE_8U &&
+           codes->getDescriptorLength() == BinarySiftEmbedding::codeSize;
+}
+
+}
+
+FrameworkReturnCode BinarySiftMatcher::match(const SRef<DescriptorBuffer> codes1,
+                                             const SRef<DescriptorBuffer> codes2,
+                                             std::vector<DescriptorMatch> & matches)
+{
+    matches.clear();
+    m_nbFloatEvaluations = 0;
+    if (!checkCodes(codes1) || !checkCodes(codes2)) {
+        LOG_ERROR("Binary matching requires codes of {} bytes", BinarySiftEmbedding::codeSize);
+        return FrameworkReturnCode::_ERROR_;
+    }
+    match(static_cast<const uint64_t *>(codes1->data()), codes1->getNbDescriptors(),
+          static_cast<const uint64_t *>(codes2->data()), codes2->getNbDescriptors(),
+          nullptr, nullptr, kernels::DescriptorType::Float, matches);
+    return FrameworkReturnCode::_SUCCESS;
+}
+
+FrameworkReturnCode BinarySiftMatcher::match(const SRef<DescriptorBuffer> codes1,
+                                             const SRef<DescriptorBuffer> descriptors1,
+                                             const SRef<DescriptorBuffer> codes2,
+                                             const SRef<DescriptorBuffer> descriptors2,
+                                             std::vector<DescriptorMatch> & matches)
+{
+    matches.clear();
+    m_nbFloatEvaluations = 0;
+    if (!checkCodes(codes1) || !checkCodes(codes2)) {
+        LOG_ERROR("Binary matching requires codes of {} bytes", BinarySiftEmbedding::codeSize);
+        return FrameworkReturnCode::_ERROR_;
+    }
+    if (!descriptors1 || !descriptors2 ||
+        descriptors1->getDescriptorDataType() != descriptors2->getDescriptorDataType() ||
+        descriptors1->getDescriptorLength() != BinarySiftEmbedding::descriptorLength ||
+        descriptors2->getDescriptorLength() != BinarySiftEmbedding::descriptorLength) {
+        LOG_ERROR("Re-ranking requires SIFT descriptors of the same type in both sets");
+        return FrameworkReturnCode::_ERROR_;
+    }
+    kernels::DescriptorType descriptorType;
+    if (descriptors1->getDescriptorDataType() == DescriptorDataType::TYPE_32F)
+        descriptorType = kernels::DescriptorType::Float;
+    else if (descriptors1->getDescriptorDataType() == DescriptorDataType::TYPE_8U)
+        descriptorType = kernels::DescriptorType::Byte;
+    else {
+        LOG_ERROR("Re-ranking requires descriptors of type TYPE_32F or TYPE_8U");
+        return FrameworkReturnCode::_ERROR_;
+    }
+    if (descriptors1->getNbDescriptors() != codes1->getNbDescriptors() || descriptors2->getNbDescriptors() != codes2->getNbDescriptors()) {
+        LOG_ERROR("The number of descriptors does not match the number of codes");
+        return FrameworkReturnCode::_ERROR_;
+    }
+    match(static_cast<const uint64_t *>(codes1->data()), codes1->getNbDescriptors(),
+          static_cast<const uint64_t *>(codes2->data()), codes2->getNbDescriptors(),
+          descriptors1->data(), descriptors2->data(), descriptorType, matches);
+    return FrameworkReturnCode::_SUCCESS;
+}
+
+void BinarySiftMatcher::selectCandidates(uint32_t nbCandidates, uint32_t maxDistance)
+{
+    // counting sort of the distances: the nearest codes are those under the first distance reaching nbCandidates
+    m_histogram.fill(0);
+    for (uint32_t distance : m_distances)
+        ++m_histogram[distance];
+    uint32_t threshold = 0, count = 0;
+    for (; threshold <= maxDistance; ++threshold) {
+        count += m_histogram[threshold];
+        if (count >= nbCandidates)
+            break;
+    }
+    threshold = std::min(threshold, maxDistance);
+    // the codes at the threshold distance fill the remaining slots
+    uint32_t nbAtThreshold = nbCandidates - (count - m_histogram[threshold]);
+    m_candidates.clear();
+    for (uint32_t j = 0; j < m_distances.size(); ++j) {
+        const uint32_t distance = m_distances[j];
+        if (distance < threshold)
+            m_candidates.push_back(j);
+        else if (distance == threshold && nbAtThreshold > 0) {
+            m_candidates.push_back(j);
+            --nbAtThreshold;
+        }
+    }
+}
+
+void BinarySiftMatcher::match(const uint64_t * codes1, std::size_t nbCodes1, const uint64_t * codes2, std::size_t nbCodes2,
+                              const void * descriptors1, const void * descriptors2, kernels::DescriptorType descriptorType,
+                              std::vector<DescriptorMatch> & matches)
+{
+    matches.clear();
+    m_nbFloatEvaluations = 0;
+    if (nbCodes1 == 0 || nbCodes2 == 0)
+        return;
+    const uint32_t maxDistance = m_config.maxHammingDistance > 0 ? std::min(m_config.maxHammingDistance, BinarySiftEmbedding::nbBits)
+                                                                 : BinarySiftEmbedding::nbBits;
+    const bool rerank = m_config.nbCandidates > 1 && descriptors1 && descriptors2;
+    const bool ratioTest = m_config.ratio < 1.f;
+    m_distances.resize(nbCodes2);
+
+    if (!rerank) {
+        for (std::size_t i = 0; i < nbCodes1; ++i) {
+            kernels::hamming256Rows(codes1 + i * BinarySiftEmbedding::nbWords, codes2, nbCodes2, m_distances.data());
+            uint32_t best = std::numeric_limits<uint32_t>::max(), second = best, bestIndex = 0;
+            for (uint32_t j = 0; j < nbCodes2; ++j) {
+                const uint32_t distance = m_distances[j];
+                if (distance < best) {
+                    second = best;
+                    best = distance;
+                    bestIndex = j;
+                }
+                else if (distance < second)
+                    second = distance;
+            }
+            if (best > maxDistance)
+                continue;
+            if (ratioTest && second != std::numeric_limits<uint32_t>::max() && !(best < m_config.ratio * second))
+                continue;
+            matches.push_back(DescriptorMatch(static_cast<uint32_t>(i), bestIndex, static_cast<float>(best)));
+        }
+        return;
+    }
+
+    const kernels::DescriptorKernels & descriptorKernels =
+        kernels::selectDescriptorKernels(kernels::NormMode::RootSift, kernels::InputType::Byte, descriptorType);
+    const uint8_t * rows1 = static_cast<const uint8_t *>(descriptors1);
+    const uint8_t * rows2 = static_cast<const uint8_t *>(descriptors2);
+    const std::size_t descriptorSize = descriptorKernels.descriptorSize;
+    const float ratio2 = m_config.ratio * m_config.ratio;
+    for (std::size_t i = 0; i < nbCodes1; ++i) {
+        kernels::hamming256Rows(codes1 + i * BinarySiftEmbedding::nbWords, codes2, nbCodes2, m_distances.data());
+        selectCandidates(m_config.nbCandidates, maxDistance);
+        const uint8_t * query = rows1 + i * descriptorSize;
+        float best = std::numeric_limits<float>::max(), second = best;
+        uint32_t bestIndex = 0;
+        for (uint32_t j : m_candidates) {
+            const float distance = descriptorKernels.descriptorDistance(query, rows2 + j * descriptorSize);
+            if (distance < best) {
+                second = best;
+                best = distance;
+                bestIndex = j;
+            }
+            else if (distance < second)
+                second = distance;
+        }
+        m_nbFloatEvaluations += m_candidates.size();
+        if (m_candidates.empty())
+            continue;
+        if (ratioTest && second != std::numeric_limits<float>::max() && !(best < ratio2 * second))
+            continue;
+        matches.push_back(DescriptorMatch(static_cast<uint32_t>(i), bestIndex, std::sqrt(best)));
+    }
+}
+
+}
+}
+}
@@ -0,0 +1,652 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SolARPopSiftDenseSift.h"
+#include "core/Log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <thread>
+
+namespace SolAR {
+using namespace datastructure;
+namespace MODULES {
+namespace POPSIFT {
+
+namespace {
+
+const int nbSpatialBins = 4;
+const int nbOrientationBins = 8;
+const float magnification = 3.0f;       // size of a spatial bin, in sigma
+const float magnitudeClamp = 0.2f;      // classic SIFT clamping of the normalized histogram
+const float normalizationMultiplier = 512.0f; // same scaling as PopSift (2^9)
+const float twoPi = 6.28318530718f;
+const uint32_t keypointsPerTask = 256;  // keypoints described by a task of describe()
+
+// Horizontal pass of a separable blur, on the rows [firstRow, lastRow). The input holds the rows from inputRow on, the
+// output the rows from outputRow on.
+void blurRows(const std::vector<float> & kernel, const float * input, int inputRow, float * output, int outputRow,
+              int width, int firstRow, int lastRow)
+{
+    int radius = int(kernel.size()) / 2;
+    for (int y = firstRow; y < lastRow; ++y) {
+        const float * row = input + std::size_t(y - inputRow) * width;
+        float * out = output + std::size_t(y - outputRow) * width;
+        for (int x = 0; x < width; ++x) {
+            float acc = 0.0f;
+            for (int k = -radius; k <= radius; ++k)
+                acc += kernel[k + radius] * row[std::min(std::max(x + k, 0), width - 1)];
+            out[x] = acc;
+        }
+    }
+}
+
+// Vertical pass of a separable blur of a plane of the given height, on the rows [firstRow, lastRow)
+void blurColumns(const std::vector<float> & kernel, const float * input, int inputRow, float * output, int outputRow,
+                 int width, int height, int firstRow, int lastRow)
+{
+    int radius = int(kernel.size()) / 2;
+    for (int y = firstRow; y < lastRow; ++y) {
+        float * out = output + std::size_t(y - outputRow) * width;
+        std::fill(out, out + width, 0.0f);
+        for (int k = -radius; k <= radius; ++k) {
+            const float * row = input + std::size_t(std::min(std::max(y + k, 0), height - 1) - inputRow) * width;
+            float weight = kernel[k + radius];
+            for (int x = 0; x < width; ++x)
+                out[x] += weight * row[x];
+        }
+    }
+}
+
+// Gradient magnitude and orientation of a plane of the given height, on the rows [firstRow, lastRow)
+void computeGradients(const float * input, int inputRow, float * magnitude, float * orientation, int outputRow,
+                      int width, int height, int firstRow, int lastRow)
+{
+    for (int y = firstRow; y < lastRow; ++y) {
+        const float * up = input + std::size_t((y > 0 ? y - 1 : 0) - inputRow) * width;
+        const float * row = input + std::size_t(y - inputRow) * width;
+        const float * down = input + std::size_t((y + 1 < height ? y + 1 : y) - inputRow) * width;
+        float * magnitudeRow = magnitude + std::size_t(y - outputRow) * width;
+        float * orientationRow = orientation + std::size_t(y - outputRow) * width;
+        for (int x = 0; x < width; ++x) {
+            float dx = 0.5f * (row[x + 1 < width ? x + 1 : x] - row[x > 0 ? x - 1 : 0]);
+            float dy = 0.5f * (down[x] - up[x]);
+            magnitudeRow[x] = std::sqrt(dx * dx + dy * dy);
+            orientationRow[x] = std::atan2(dy, dx);
+        }
+    }
+}
+
+void gaussianKernel(std::vector<float> & kernel, float sigma)
+{
+    int radius = std::max(1, static_cast<int>(std::ceil(4.0f * sigma)));
+    kernel.resize(2 * radius + 1);
+    float sum = 0.0f;
+    for (int i = -radius; i <= radius; ++i) {
+        kernel[i + radius] = std::exp(-0.5f * float(i * i) / (sigma * sigma));
+        sum += kernel[i + radius];
+    }
+    for (float & k : kernel)
+        k /= sum;
+}
+
+// Pixel radius of the support of a descriptor, see DenseSift::describeKeypoint
+int descriptorRadius(float sigma)
+{
+    float binWidth = magnification * sigma;
+    return static_cast<int>(std::floor(std::sqrt(2.0f) * binWidth * (nbSpatialBins + 1) * 0.5f + 0.5f));
+}
+
+}
+
+DenseSift::DenseSift()
+{
+    setConfig(DenseSiftConfig());
+}
+
+DenseSift::DenseSift(const DenseSiftConfig & config)
+{
+    setConfig(config);
+}
+
+void DenseSift::setConfig(const DenseSiftConfig & config)
+{
+    m_config = config;
+    if (m_config.stride < 1)
+        m_config.stride = 1;
+    if (m_config.sigma <= 0.0f)
+        m_config.sigma = 1.6f;
+    if (m_config.initialBlur < 0.0f)
+        m_config.initialBlur = 0.5f;
+    m_scales.clear();
+    for (float scale : m_config.scales)
+        if (scale > 0.0f)
+            m_scales.push_back(scale);
+    std::sort(m_scales.begin(), m_scales.end());
+    m_scales.erase(std::unique(m_scales.begin(), m_scales.end()), m_scales.end());
+    if (m_config.tileHeight < 1)
+        m_config.tileHeight = 1;
+    uint32_t nbThreads = m_config.nbThreads > 0 ? m_config.nbThreads : std::max(1u, std::thread::hardware_concurrency());
+    if (!m_scheduler || m_scheduler->getNbThreads() != nbThreads || m_scheduler->getPinWorkers() != m_config.pinWorkers)
+        m_scheduler.reset(new TaskScheduler(nbThreads, m_config.pinWorkers));
+    m_kernels = &kernels::selectDescriptorKernels(m_config.normMode, kernels::InputType::Byte, m_config.descriptorType);
+    release();
+}
+
+void DenseSift::release()
+{
+    m_pyramidTasks.clear();
+    m_extractTasks.clear();
+    m_describeTasks.clear();
+    m_width = 0;
+    m_height = 0;
+    m_levels.clear();
+    m_octaves.clear();
+    m_residentImage.reset();
+    m_stripBuffers.clear();
+    m_freeStripBuffers.clear();
+}
+
+void DenseSift::releaseLevels()
+{
+    if (m_pyramidTasks.empty())
+        return;
+    m_pyramidTasks.clear();
+    for (Level & level : m_levels) {
+        level.image = Plane();
+        level.temp = Plane();
+        level.magnitude = Plane();
+        level.orientation = Plane();
+        level.gradientBands.clear();
+    }
+    m_residentImage.reset();
+}
+
+DenseSift::StripBuffers * DenseSift::acquireStripBuffers()
+{
+    std::lock_guard<std::mutex> lock(m_stripMutex);
+    if (m_freeStripBuffers.empty()) {
+        m_stripBuffers.emplace_back(new StripBuffers());
+        return m_stripBuffers.back().get();
+    }
+    StripBuffers * buffers = m_freeStripBuffers.back();
+    m_freeStripBuffers.pop_back();
+    return buffers;
+}
+
+void DenseSift::releaseStripBuffers(StripBuffers * buffers)
+{
+    std::lock_guard<std::mutex> lock(m_stripMutex);
+    m_freeStripBuffers.push_back(buffers);
+}
+
+std::vector<WorkerStats> DenseSift::getWorkerStats() const
+{
+    if (!m_scheduler)
+        return std::vector<WorkerStats>();
+    return m_scheduler->getWorkerStats();
+}
+
+DenseSift::GridRange DenseSift::gridRange(uint32_t size, float scale) const
+{
+    // keep the descriptor support inside the image
+    uint32_t margin = static_cast<uint32_t>(std::ceil(magnification * scale * nbSpatialBins / 2.0f)) + 1;
+    if (size <= 2 * margin)
+        return { margin, 0 };
+    return { margin, (size - 1 - 2 * margin) / uint32_t(m_config.stride) + 1 };
+}
+
+uint32_t DenseSift::getNbKeypoints(uint32_t width, uint32_t height) const
+{
+    uint32_t count = 0;
+    for (float scale : m_scales)
+        count += gridRange(width, scale).count * gridRange(height, scale).count;
+    return count;
+}
+
+std::vector<TaskGraph::TaskId> DenseSift::bandsOfRows(const std::vector<TaskGraph::TaskId> & bands, int first, int last) const
+{
+    int tileHeight = int(m_config.tileHeight);
+    int firstBand = std::max(0, first / tileHeight);
+    int lastBand = std::min(int(bands.size()) - 1, std::max(0, last) / tileHeight);
+    return std::vector<TaskGraph::TaskId>(bands.begin() + firstBand, bands.begin() + std::max(firstBand, lastBand + 1));
+}
+
+DenseSift::Stage DenseSift::addBlurTasks(TaskGraph & tasks, const Stage & input, Plane & temp, Plane & output, std::vector<float> & kernel, float sigma)
+{
+    gaussianKernel(kernel, sigma);
+    int radius = int(kernel.size()) / 2;
+
+    const Plane * in = input.plane;
+    int width = int(in->width);
+    int height = int(in->height);
+    int tileHeight = int(m_config.tileHeight);
+    temp.resize(in->width, in->height);
+    output.resize(in->width, in->height);
+    Plane * tempPlane = &temp;
+    Plane * outPlane = &output;
+    const std::vector<float> * blurKernel = &kernel;
+
+    // a horizontal band reads the same rows, a vertical band reads the rows within the kernel radius
+    std::vector<TaskGraph::TaskId> horizontalBands;
+    for (int first = 0; first < height; first += tileHeight) {
+        int last = std::min(height, first + tileHeight);
+        horizontalBands.push_back(tasks.add([=]() {
+            blurRows(*blurKernel, in->data.data(), 0, tempPlane->data.data(), 0, width, first, last);
+        }, bandsOfRows(input.bands, first, last - 1)));
+    }
+    Stage blurred;
+    blurred.plane = &output;
+    for (int first = 0; first < height; first += tileHeight) {
+        int last = std::min(height, first + tileHeight);
+        blurred.bands.push_back(tasks.add([=]() {
+            blurColumns(*blurKernel, tempPlane->data.data(), 0, outPlane->data.data(), 0, width, height, first, last);
+        }, bandsOfRows(horizontalBands, first - radius, last - 1 + radius)));
+    }
+    return blurred;
+}
+
+void DenseSift::describeKeypoint(const Gradients & gradients, float x, float y, float sigma, float angle, void * descriptor) const
+{
+    float histograms[descriptorLength] = {};
+    float binWidth = magnification * sigma;
+    int radius = descriptorRadius(sigma);
+    float cosAngle = std::cos(angle);
+    float sinAngle = std::sin(angle);
+    float weightSigma = nbSpatialBins / 2.0f;
+    int cx = static_cast<int>(std::lround(x));
+    int cy = static_cast<int>(std::lround(y));
+    int width = gradients.width;
+    int height = gradients.height;
+
+    for (int py = std::max(cy - radius, 0); py <= std::min(cy + radius, height - 1); ++py) {
+        for (int px = std::max(cx - radius, 0); px <= std::min(cx + radius, width - 1); ++px) {
+            // sample position in the keypoint frame, in bins
+            float dx = float(px) - x;
+            float dy = float(py) - y;
+            float rx = ( cosAngle * dx + sinAngle * dy) / binWidth;
+            float ry = (-sinAngle * dx + cosAngle * dy) / binWidth;
+            float bx = rx + nbSpatialBins / 2.0f - 0.5f;
+            float by = ry + nbSpatialBins / 2.0f - 0.5f;
+            if (bx <= -1.0f || bx >= float(nbSpatialBins) || by <= -1.0f || by >= float(nbSpatialBins))
+                continue;
+            std::size_t index = std::size_t(py - gradients.firstRow) * width + px;
+            float weight = gradients.magnitude[index] * std::exp(-(rx * rx + ry * ry) / (2.0f * weightSigma * weightSigma));
+            float theta = gradients.orientation[index] - angle;
+            theta = std::fmod(theta, twoPi);
+            if (theta < 0.0f)
+                theta += twoPi;
+            float bo = theta * nbOrientationBins / twoPi;
+
+            // trilinear interpolation over the spatial and orientation bins
+            int x0 = static_cast<int>(std::floor(bx));
+            int y0 = static_cast<int>(std::floor(by));
+            int o0 = static_cast<int>(std::floor(bo));
+            float fx = bx - x0;
+            float fy = by - y0;
+            float fo = bo - o0;
+            for (int iy = 0; iy < 2; ++iy) {
+                int ybin = y0 + iy;
+                if (ybin < 0 || ybin >= nbSpatialBins)
+                    continue;
+                float wy = iy ? fy : 1.0f - fy;
+                for (int ix = 0; ix < 2; ++ix) {
+                    int xbin = x0 + ix;
+                    if (xbin < 0 || xbin >= nbSpatialBins)
+                        continue;
+                    float wxy = wy * (ix ? fx : 1.0f - fx) * weight;
+                    float * histogram = histograms + (ybin * nbSpatialBins + xbin) * nbOrientationBins;
+                    histogram[o0 % nbOrientationBins] += wxy * (1.0f - fo);
+                    histogram[(o0 + 1) % nbOrientationBins] += wxy * fo;
+                }
+            }
+        }
+    }
+
+    m_kernels->finalizeDescriptor(histograms, descriptor);
+}
+
+FrameworkReturnCode DenseSift::checkImage(const SRef<Image> image) const
+{
+    if (!image || image->getNbChannels() != 1) {
+        LOG_ERROR("DenseSift requires a grey image");
+        return FrameworkReturnCode::_ERROR_;
+    }
+    if (image->getDataType() != Image::DataType::TYPE_8U && image->getDataType() != Image::DataType::TYPE_32U) {
+        LOG_ERROR("DenseSift requires an 8 bits or a 32 bits float image");
+        return FrameworkReturnCode::_ERROR_;
+    }
+    return FrameworkReturnCode::_SUCCESS;
+}
+
+void DenseSift::addOctaveTasks(TaskGraph & tasks)
+{
+    int tileHeight = int(m_config.tileHeight);
+
+    // octave of each scale, the smallest octave being at least 2x2
+    std::vector<int> octaves(m_scales.size(), 0);
+    int nbOctaves = 1;
+    for (std::size_t i = 0; i < m_scales.size(); ++i) {
+        float scale = m_scales[i];
+        int targetOctave = scale > m_config.sigma ? static_cast<int>(std::floor(std::log2(scale / m_config.sigma))) : 0;
+        while (octaves[i] < targetOctave && (m_width >> octaves[i]) > 1 && (m_height >> octaves[i]) > 1)
+            ++octaves[i];
+        nbOctaves = std::max(nbOctaves, octaves[i] + 1);
+    }
+    // the tasks keep pointers to the planes: no reallocation once they are added
+    m_octaves.resize(nbOctaves);
+    m_levels.resize(m_scales.size());
+    for (std::size_t i = 0; i < m_scales.size(); ++i) {
+        m_levels[i].scale = m_scales[i];
+        m_levels[i].octave = octaves[i];
+    }
+
+    // first octave base, converted from the image
+    Octave & first = m_octaves[0];
+    first.baseSigma = m_config.initialBlur;
+    first.base.resize(m_width, m_height);
+    first.baseStage.plane = &first.base;
+    first.baseStage.bands.clear();
+    uint32_t width = m_width;
+    for (uint32_t row = 0; row < m_height; row += uint32_t(tileHeight)) {
+        uint32_t lastRow = std::min(m_height, row + uint32_t(tileHeight));
+        Plane * base = &first.base;
+        first.baseStage.bands.push_back(tasks.add([=]() {
+            const Image * image = m_residentImage.get();
+            std::size_t begin = std::size_t(row) * width;
+            std::size_t end = std::size_t(lastRow) * width;
+            m_kernels->convertPixels(image->data(), base->data.data(), begin, end);
+        }));
+    }
+
+    // the next octave base is the current one at twice the base blur, subsampled
+    for (int o = 1; o < nbOctaves; ++o) {
+        Octave & previous = m_octaves[o - 1];
+        Octave & octave = m_octaves[o];
+        Stage source = previous.baseStage;
+        float target = 2.0f * m_config.sigma;
+        if (target > previous.baseSigma)
+            source = addBlurTasks(tasks, previous.baseStage, previous.temp, previous.blurred, previous.kernel,
+                                  std::sqrt(target * target - previous.baseSigma * previous.baseSigma));
+        octave.baseSigma = m_config.sigma;
+        octave.base.resize(source.plane->width / 2, source.plane->height / 2);
+        octave.baseStage.plane = &octave.base;
+        octave.baseStage.bands.clear();
+        const Plane * in = source.plane;
+        Plane * out = &octave.base;
+        for (uint32_t row = 0; row < out->height; row += uint32_t(tileHeight)) {
+            uint32_t lastRow = std::min(out->height, row + uint32_t(tileHeight));
+            octave.baseStage.bands.push_back(tasks.add([=]() {
+                for (uint32_t y = row; y < lastRow; ++y)
+                    for (uint32_t x = 0; x < out->width; ++x)
+                        out->data[std::size_t(y) * out->width + x] = in->data[std::size_t(2 * y) * in->width + 2 * x];
+            }, bandsOfRows(source.bands, 2 * int(row), 2 * int(lastRow - 1))));
+        }
+    }
+}
+
+void DenseSift::addLevelTasks(TaskGraph & tasks)
+{
+    int tileHeight = int(m_config.tileHeight);
+
+    // levels: each one is blurred from its octave base, then its gradients are computed
+    for (Level & level : m_levels) {
+        Octave & octave = m_octaves[level.octave];
+        float sigma = level.scale / float(1 << level.octave);
+        Stage source = octave.baseStage;
+        if (sigma > octave.baseSigma)
+            source = addBlurTasks(tasks, octave.baseStage, level.temp, level.image, level.kernel,
+                                  std::sqrt(sigma * sigma - octave.baseSigma * octave.baseSigma));
+        const Plane * plane = source.plane;
+        level.magnitude.resize(plane->width, plane->height);
+        level.orientation.resize(plane->width, plane->height);
+        level.gradientBands.clear();
+        Level * target = &level;
+        for (uint32_t row = 0; row < plane->height; row += uint32_t(tileHeight)) {
+            uint32_t lastRow = std::min(plane->height, row + uint32_t(tileHeight));
+            level.gradientBands.push_back(tasks.add([=]() {
+                computeGradients(plane->data.data(), 0, target->magnitude.data.data(), target->orientation.data.data(), 0,
+                                 int(plane->width), int(plane->height), int(row), int(lastRow));
+            }, bandsOfRows(source.bands, int(row) - 1, int(lastRow))));
+        }
+    }
+}
+
+void DenseSift::addStripTasks(TaskGraph & tasks)
+{
+    std::size_t descriptorSize = m_kernels->descriptorSize;
+    uint32_t stride = uint32_t(m_config.stride);
+    std::size_t offset = 0;     // in the descriptors of the image
+    for (const Level & level : m_levels) {
+        const Octave & octave = m_octaves[level.octave];
+        const Plane * base = &octave.base;
+        int width = int(base->width);
+        int height = int(base->height);
+        float octaveScale = float(1 << level.octave);
+        float sigma = level.scale / octaveScale;
+        std::vector<float> kernel;
+        if (sigma > octave.baseSigma)
+            gaussianKernel(kernel, std::sqrt(sigma * sigma - octave.baseSigma * octave.baseSigma));
+        int blurRadius = int(kernel.size()) / 2;
+        int radius = descriptorRadius(sigma) + 1;
+        // the rows within the halo of a strip are also computed by its neighbours: the strips are at least twice as
+        // high as their two halos
+        int halo = radius + 1 + blurRadius;
+        uint32_t stripHeight = std::max(m_config.tileHeight, uint32_t(4 * halo));
+        uint32_t rowsPerStrip = std::max(1u, uint32_t(float(stripHeight) * octaveScale) / stride);
+        GridRange columns = gridRange(m_width, level.scale);
+        GridRange rows = gridRange(m_height, level.scale);
+        for (uint32_t row = 0; row < rows.count; row += rowsPerStrip) {
+            uint32_t lastRow = std::min(rows.count, row + rowsPerStrip);
+            std::size_t first = offset + std::size_t(row) * columns.count * descriptorSize;
+            // rows of the gradients read by the descriptors, of the blurred image read by the gradients, and of the
+            // base read by the blur
+            float firstY = float(rows.first + row * stride) / octaveScale;
+            float lastY = float(rows.first + (lastRow - 1) * stride) / octaveScale;
+            int gradientFirst = std::max(0, int(std::floor(firstY)) - radius);
+            int gradientLast = std::min(height - 1, int(std::ceil(lastY)) + radius);
+            int imageFirst = std::max(0, gradientFirst - 1);
+            int imageLast = std::min(height - 1, gradientLast + 1);
+            int baseFirst = std::max(0, imageFirst - blurRadius);
+            int baseLast = std::min(height - 1, imageLast + blurRadius);
+            tasks.add([=]() {
+                StripBuffers * buffers = acquireStripBuffers();
+                const float * image = base->data.data();
+                int imageRow = 0;
+                if (!kernel.empty()) {
+                    buffers->temp.resize(uint32_t(width), uint32_t(baseLast - baseFirst + 1));
+                    buffers->image.resize(uint32_t(width), uint32_t(imageLast - imageFirst + 1));
+                    blurRows(kernel, base->data.data(), 0, buffers->temp.data.data(), baseFirst, width, baseFirst, baseLast + 1);
+                    blurColumns(kernel, buffers->temp.data.data(), baseFirst, buffers->image.data.data(), imageFirst,
+                                width, height, imageFirst, imageLast + 1);
+                    image = buffers->image.data.data();
+                    imageRow = imageFirst;
+                }
+                buffers->magnitude.resize(uint32_t(width), uint32_t(gradientLast - gradientFirst + 1));
+                buffers->orientation.resize(uint32_t(width), uint32_t(gradientLast - gradientFirst + 1));
+                computeGradients(image, imageRow, buffers->magnitude.data.data(), buffers->orientation.data.data(), gradientFirst,
+                                 width, height, gradientFirst, gradientLast + 1);
+                Gradients gradients = { buffers->magnitude.data.data(), buffers->orientation.data.data(), width, height, gradientFirst };
+                unsigned char * descriptor = m_output + first;
+                for (uint32_t r = row; r < lastRow; ++r) {
+                    float y = float(rows.first + r * stride) / octaveScale;
+                    for (uint32_t column = 0; column < columns.count; ++column) {
+                        float x = float(columns.first + column * stride) / octaveScale;
+                        describeKeypoint(gradients, x, y, sigma, 0.0f, descriptor);
+                        descriptor += descriptorSize;
+                    }
+                }
+                releaseStripBuffers(buffers);
+            }, bandsOfRows(octave.baseStage.bands, baseFirst, baseLast));
+        }
+        offset += std::size_t(rows.count) * columns.count * descriptorSize;
+    }
+}
+
+void DenseSift::setLayout(const SRef<Image> image)
+{
+    bool isFloat = image->getDataType() == Image::DataType::TYPE_32U;
+    if (image->getWidth() == m_width && image->getHeight() == m_height && isFloat == m_isFloat)
+        return;
+    m_width = image->getWidth();
+    m_height = image->getHeight();
+    m_isFloat = isFloat;
+    m_kernels = &kernels::selectDescriptorKernels(m_config.normMode, isFloat ? kernels::InputType::Float : kernels::InputType::Byte,
+                                                  m_config.descriptorType);
+    releaseLevels();
+    m_extractTasks.clear();
+}
+
+SRef<DescriptorBuffer> DenseSift::createDescriptors(uint32_t nbDescriptors) const
+{
+    DescriptorDataType dataType = m_config.descriptorType == kernels::DescriptorType::Byte ? DescriptorDataType::TYPE_8U
+                                                                                          : DescriptorDataType::TYPE_32F;
+    return SRef<DescriptorBuffer>(new DescriptorBuffer(DescriptorType::SIFT, dataType, descriptorLength, nbDescriptors));
+}
+
+FrameworkReturnCode DenseSift::buildPyramid(const SRef<Image> image)
+{
+    if (checkImage(image) != FrameworkReturnCode::_SUCCESS)
+        return FrameworkReturnCode::_ERROR_;
+    setLayout(image);
+    // the octave planes are shared with the graph of extract()
+    if (m_pyramidTasks.empty()) {
+        addOctaveTasks(m_pyramidTasks);
+        addLevelTasks(m_pyramidTasks);
+    }
+    m_residentImage = image;
+    m_scheduler->run(m_pyramidTasks);
+    return FrameworkReturnCode::_SUCCESS;
+}
+
+void DenseSift::gridKeypoints(std::vector<Keypoint> & keypoints) const
+{
+    keypoints.clear();
+    keypoints.reserve(getNbKeypoints(m_width, m_height));
+    uint32_t id = 0;
+    for (const Level & level : m_levels) {
+        GridRange columns = gridRange(m_width, level.scale);
+        GridRange rows = gridRange(m_height, level.scale);
+        for (uint32_t row = 0; row < rows.count; ++row) {
+            float y = float(rows.first + row * uint32_t(m_config.stride));
+            for (uint32_t column = 0; column < columns.count; ++column) {
+                float x = float(columns.first + column * uint32_t(m_config.stride));
+                Keypoint keypoint;
+                keypoint.init(id++, x, y, 0.0f, 0.0f, 0.0f, level.scale, 0.0f, 0.0f, level.octave);
+                keypoints.push_back(keypoint);
+            }
+        }
+    }
+}
+
+FrameworkReturnCode DenseSift::detect(const SRef<Image> image, std::vector<Keypoint> & keypoints)
+{
+    keypoints.clear();
+    if (buildPyramid(image) != FrameworkReturnCode::_SUCCESS)
+        return FrameworkReturnCode::_ERROR_;
+    gridKeypoints(keypoints);
+    return FrameworkReturnCode::_SUCCESS;
+}
+
+DenseSift::Gradients DenseSift::residentGradients(const Level & level) const
+{
+    return { level.magnitude.data.data(), level.orientation.data.data(), int(level.magnitude.width), int(level.magnitude.height), 0 };
+}
+
+const DenseSift::Level & DenseSift::nearestLevel(float size) const
+{
+    // level of the nearest scale, in log scale
+    const Level * level = &m_levels.front();
+    if (size > 0.0f) {
+        float best = std::fabs(std::log(size / level->scale));
+        for (const Level & candidate : m_levels) {
+            float distance = std::fabs(std::log(size / candidate.scale));
+            if (distance < best) {
+                best = distance;
+                level = &candidate;
+            }
+        }
+    }
+    return *level;
+}
+
+FrameworkReturnCode DenseSift::describe(const SRef<Image> image,
+                                        const std::vector<Keypoint> & keypoints,
+                                        SRef<DescriptorBuffer> & descriptors)
+{
+    if (image != m_residentImage || m_pyramidTasks.empty()) {
+        if (buildPyramid(image) != FrameworkReturnCode::_SUCCESS)
+            return FrameworkReturnCode::_ERROR_;
+    }
+    descriptors = createDescriptors(uint32_t(keypoints.size()));
+    if (keypoints.empty())
+        return FrameworkReturnCode::_SUCCESS;
+    if (m_levels.empty()) {
+        LOG_ERROR("DenseSift::describe requires at least one scale");
+        return FrameworkReturnCode::_ERROR_;
+    }
+
+    unsigned char * output = static_cast<unsigned char *>(descriptors->data());
+    std::size_t descriptorSize = m_kernels->descriptorSize;
+    const Keypoint * input = keypoints.data();
+    m_describeTasks.clear();
+    for (std::size_t first = 0; first < keypoints.size(); first += keypointsPerTask) {
+        std::size_t last = std::min(keypoints.size(), first + keypointsPerTask);
+        m_describeTasks.add([=]() {
+            for (std::size_t i = first; i < last; ++i) {
+                const Keypoint & keypoint = input[i];
+                const Level & level = nearestLevel(keypoint.getSize());
+                float octaveScale = float(1 << level.octave);
+                float size = keypoint.getSize() > 0.0f ? keypoint.getSize() : level.scale;
+                describeKeypoint(residentGradients(level), keypoint.getX() / octaveScale, keypoint.getY() / octaveScale, size / octaveScale,
+                                 keypoint.getAngle(), output + i * descriptorSize);
+            }
+        });
+    }
+    m_scheduler->run(m_describeTasks);
+    m_describeTasks.clear();
+    return FrameworkReturnCode::_SUCCESS;
+}
+
+FrameworkReturnCode DenseSift::extract(const SRef<Image> image,
+                                       std::vector<Keypoint> & keypoints,
+                                       SRef<DescriptorBuffer> & descriptors)
+{
+    keypoints.clear();
+    if (checkImage(image) != FrameworkReturnCode::_SUCCESS)
+        return FrameworkReturnCode::_ERROR_;
+    // the octave bases and the strips of the levels are run as one graph, the planes of the levels of a previous
+    // detection being released
+    setLayout(image);
+    releaseLevels();
+    if (m_extractTasks.empty()) {
+        addOctaveTasks(m_extractTasks);
+        addStripTasks(m_extractTasks);
+    }
+    gridKeypoints(keypoints);
+    descriptors = createDescriptors(uint32_t(keypoints.size()));
+    m_residentImage = image;
+    m_output = static_cast<unsigned char *>(descriptors->data());
+    m_scheduler->run(m_extractTasks);
+    m_output = nullptr;
+    m_residentImage.reset();
+    return FrameworkReturnCode::_SUCCESS;
+}
+
+}
+}
+}
@@ -0,0 +1,232 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SolARPopSiftDescriptorKernels.h"
+#include "SolARPopSiftKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace SolAR {
+namespace MODULES {
+namespace POPSIFT {
+namespace kernels {
+
+namespace {
+
+const std::size_t descriptorLength = 128;
+const float magnitudeClamp = 0.2f;              // classic SIFT clamping of the normalized histogram
+const float normalizationMultiplier = 512.0f;   // same scaling as PopSift (2^9)
+
+template <InputType input> struct Pixel;
+template <> struct Pixel<InputType::Byte> { using type = uint8_t; static constexpr float range = 255.0f; };
+template <> struct Pixel<InputType::Float> { using type = float; static constexpr float range = 1.0f; };
+
+template <DescriptorType descriptor> struct Element;
+template <> struct Element<DescriptorType::Float> { using type = float; };
+template <> struct Element<DescriptorType::Byte> { using type = uint8_t; };
+
+inline uint8_t saturate(float value)
+{
+    return static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, std::nearbyint(value))));
+}
+
+template <InputType input>
+void convertPixels(const void * pixels, float * plane, std::size_t begin, std::size_t end)
+{
+    using Type = typename Pixel<input>::type;
+    const Type * source = static_cast<const Type *>(pixels);
+    for (std::size_t i = begin; i < end; ++i)
+        plane[i] = float(source[i]) / Pixel<input>::range;
+}
+
+// Normalizes the histogram in place, scaled by the normalization multiplier
+template <NormMode norm>
+void normalize(float * histogram);
+
+template <>
+void normalize<NormMode::RootSift>(float * histogram)
+{
+    float sum = 0.0f;
+    for (std::size_t i = 0; i < descriptorLength; ++i)
+        sum += histogram[i];
+    float scale = sum > 0.0f ? 1.0f / sum : 0.0f;
+    for (std::size_t i = 0; i < descriptorLength; ++i)
+        histogram[i] = std::sqrt(histogram[i] * scale) * normalizationMultiplier;
+}
+
+template <>
+void normalize<NormMode::Classic>(float * histogram)
+{
+    float sum = 0.0f;
+    for (std::size_t i = 0; i < descriptorLength; ++i)
+        sum += histogram[i] * histogram[i];
+    float scale = sum > 0.0f ? 1.0f / std::sqrt(sum) : 0.0f;
+    sum = 0.0f;
+    for (std::size_t i = 0; i < descriptorLength; ++i) {
+        histogram[i] = std::min(histogram[i] * scale, magnitudeClamp);
+        sum += histogram[i] * histogram[i];
+    }
+    scale = sum > 0.0f ? normalizationMultiplier / std::sqrt(sum) : 0.0f;
+    for (std::size_t i = 0; i < descriptorLength; ++i)
+        histogram[i] *= scale;
+}
+
+template <NormMode norm, DescriptorType descriptor>
+void finalizeDescriptor(float * histogram, void * output)
+{
+    normalize<norm>(histogram);
+    if (descriptor == DescriptorType::Float)
+        std::copy(histogram, histogram + descriptorLength, static_cast<float *>(output));
+    else {
+        uint8_t * out = static_cast<uint8_t *>(output);
+        for (std::size_t i = 0; i < descriptorLength; ++i)
+            out[i] = saturate(histogram[i]);
+    }
+}
+
+template <DescriptorType descriptor>
+float descriptorDistance(const void * descriptor1, const void * descriptor2);
+
+template <>
+float descriptorDistance<DescriptorType::Float>(const void * descriptor1, const void * descriptor2)
+{
+    return l2sqr(static_cast<const float *>(descriptor1), static_cast<const float *>(descriptor2), descriptorLength);
+}
+
+template <>
+float descriptorDistance<DescriptorType::Byte>(const void * descriptor1, const void * descriptor2)
+{
+    const uint8_t * a = static_cast<const uint8_t *>(descriptor1);
+    const uint8_t * b = static_cast<const uint8_t *>(descriptor2);
+    int32_t sum = 0;
+    for (std::size_t i = 0; i < descriptorLength; ++i) {
+        int32_t d = int32_t(a[i]) - int32_t(b[i]);
+        sum += d * d;
+    }
+    return float(sum);
+}
+
+template <NormMode norm, InputType input, DescriptorType descriptor>
+constexpr DescriptorKernels instance(const char * name)
+{
+    return { convertPixels<input>, finalizeDescriptor<norm, descriptor>, descriptorDistance<descriptor>,
+             descriptorLength * sizeof(typename Element<descriptor>::type), norm, input, descriptor, name };
+}
+
+// indexed by norm, input type and descriptor type
+const DescriptorKernels kernelTable[2][2][2] = {
+    { { instance<NormMode::RootSift, InputType::Byte, DescriptorType::Float>("RootSift/Byte/Float"),
+        instance<NormMode::RootSift, InputType::Byte, DescriptorType::Byte>("RootSift/Byte/Byte") },
+      { instance<NormMode::RootSift, InputType::Float, DescriptorType::Float>("RootSift/Float/Float"),
+        instance<NormMode::RootSift, InputType::Float, DescriptorType::Byte>("RootSift/Float/Byte") } },
+    { { instance<NormMode::Classic, InputType::Byte, DescriptorType::Float>("Classic/Byte/Float"),
+        instance<NormMode::Classic, InputType::Byte, DescriptorType::Byte>("Classic/Byte/Byte") },
+      { instance<NormMode::Classic, InputType::Float, DescriptorType::Float>("Classic/Float/Float"),
+        instance<NormMode::Classic, InputType::Float, DescriptorType::Byte>("Classic/Float/Byte") } }
+};
+
+}
+
+bool parseNormMode(const std::string & value, NormMode & mode)
+{
+    if (value == "RootSift")
+        mode = NormMode::RootSift;
+    else if (value == "Classic")
+        mode = NormMode::Classic;
+    else
+        return false;
+    return true;
+}
+
+bool parseInputType(const std::string & value, InputType & type)
+{
+    if (value == "Unsigned Char")
+        type = InputType::Byte;
+    else if (value == "Float")
+        type = InputType::Float;
+    else
+        return false;
+    return true;
+}
+
+bool parseDescriptorType(const std::string & value, DescriptorType & type)
+{
+    if (value == "Float")
+        type = DescriptorType::Float;
+    else if (value == "Unsigned Char")
+        type = DescriptorType::Byte;
+    else
+        return false;
+    return true;
+}
+
+const DescriptorKernels & selectDescriptorKernels(NormMode norm, InputType input, DescriptorType descriptor)
+{
+    return kernelTable[int(norm)][int(input)][int(descriptor)];
+}
+
+void convertPixelsGeneric(InputType input, const void * pixels, float * plane, std::size_t begin, std::size_t end)
+{
+    for (std::size_t i = begin; i < end; ++i) {
+        if (input == InputType::Byte)
+            plane[i] = float(static_cast<const uint8_t *>(pixels)[i]) / 255.0f;
+        else
+            plane[i] = static_cast<const float *>(pixels)[i];
+    }
+}
+
+void finalizeDescriptorGeneric(NormMode norm, DescriptorType descriptor, float * histogram, void * output)
+{
+    float sum = 0.0f;
+    for (std::size_t i = 0; i < descriptorLength; ++i)
+        sum += norm == NormMode::RootSift ? histogram[i] : histogram[i] * histogram[i];
+    float scale = sum > 0.0f ? (norm == NormMode::RootSift ? 1.0f / sum : 1.0f / std::sqrt(sum)) : 0.0f;
+    float clampedSum = 0.0f;
+    for (std::size_t i = 0; i < descriptorLength; ++i) {
+        if (norm == NormMode::RootSift)
+            histogram[i] = std::sqrt(histogram[i] * scale) * normalizationMultiplier;
+        else {
+            histogram[i] = std::min(histogram[i] * scale, magnitudeClamp);
+            clampedSum += histogram[i] * histogram[i];
+        }
+    }
+    float clampedScale = clampedSum > 0.0f ? normalizationMultiplier / std::sqrt(clampedSum) : 0.0f;
+    for (std::size_t i = 0; i < descriptorLength; ++i) {
+        float value = norm == NormMode::RootSift ? histogram[i] : histogram[i] * clampedScale;
+        if (descriptor == DescriptorType::Float)
+            static_cast<float *>(output)[i] = value;
+        else
+            static_cast<uint8_t *>(output)[i] = saturate(value);
+    }
+}
+
+float descriptorDistanceGeneric(DescriptorType descriptor, const void * descriptor1, const void * descriptor2)
+{
+    float sum = 0.0f;
+    for (std::size_t i = 0; i < descriptorLength; ++i) {
+        float d = descriptor == DescriptorType::Float
+                ? static_cast<const float *>(descriptor1)[i] - static_cast<const float *>(descriptor2)[i]
+                : float(static_cast<const uint8_t *>(descriptor1)[i]) - float(static_cast<const uint8_t *>(descriptor2)[i]);
+        sum += d * d;
+    }
+    return sum;
+}
+
+}
+}
+}
+}
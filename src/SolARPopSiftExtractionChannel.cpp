@@ -0,0 +1,648 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SolARPopSiftExtractionChannel.h"
+#include "core/Log.h"
+#include "xpcf/xpcf.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <fcntl.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace xpcf  = org::bcom::xpcf;
+
+namespace SolAR {
+using namespace datastructure;
+namespace MODULES {
+namespace POPSIFT {
+
+#ifndef _WIN32
+
+namespace {
+
+const uint32_t segmentMagic = 0x50535348; // "PSSH"
+const uint32_t segmentVersion = 1;
+const uint64_t segmentAlignment = 64;
+
+enum SlotState : uint32_t {
+    Free = 0,       // owned by the client ring, available
+    Writing,        // a client thread writes its request
+    Requested,      // waiting for the server
+    Processing,     // the server extracts
+    Done,           // results are available, the client thread reads them
+    Orphaned        // the client thread timed out while the server was extracting
+};
+
+struct ClientEntry {
+    std::atomic<int32_t> pid;   // 0 if the ring is available
+    uint32_t reserved;
+};
+
+struct SegmentHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t maxClients;
+    uint32_t slotsPerClient;
+    uint64_t maxImageBytes;
+    uint32_t maxKeypoints;
+    uint32_t maxDescriptorBytes;
+    uint64_t clientsOffset;
+    uint64_t slotsOffset;
+    uint64_t slotSize;
+    uint64_t segmentSize;
+    std::atomic<uint32_t> running;
+    std::atomic<uint64_t> sequence;
+    sem_t request;                  // posted for each request, the server waits on it
+};
+
+struct SlotHeader {
+    std::atomic<uint32_t> state;
+    uint32_t width;
+    uint32_t height;
+    uint32_t imageLayout;
+    uint32_t imageDataType;
+    int32_t status;
+    uint64_t imageBytes;
+    uint64_t sequence;
+    uint32_t nbKeypoints;
+    uint32_t nbDescriptors;
+    uint32_t descriptorLength;
+    uint32_t descriptorDataType;
+    uint32_t descriptorType;
+    uint32_t reserved;
+    sem_t done;                     // posted by the server when the slot is Done
+};
+
+struct PackedKeypoint {
+    uint32_t id;
+    float x;
+    float y;
+    float size;
+    float angle;
+    float response;
+    int32_t octave;
+    int32_t classId;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+              "shared memory synchronization requires lock free atomics");
+
+uint64_t align(uint64_t size)
+{
+    return (size + segmentAlignment - 1) / segmentAlignment * segmentAlignment;
+}
+
+uint64_t imageOffset()
+{
+    return align(sizeof(SlotHeader));
+}
+
+uint64_t keypointsOffset(const SegmentHeader * header)
+{
+    return imageOffset() + align(header->maxImageBytes);
+}
+
+uint64_t descriptorsOffset(const SegmentHeader * header)
+{
+    return keypointsOffset(header) + align(uint64_t(header->maxKeypoints) * sizeof(PackedKeypoint));
+}
+
+SegmentHeader * segmentHeader(unsigned char * segment)
+{
+    return reinterpret_cast<SegmentHeader *>(segment);
+}
+
+ClientEntry * clientEntry(unsigned char * segment, uint32_t client)
+{
+    return reinterpret_cast<ClientEntry *>(segment + segmentHeader(segment)->clientsOffset) + client;
+}
+
+unsigned char * slotBase(unsigned char * segment, uint32_t slot)
+{
+    const SegmentHeader * header = segmentHeader(segment);
+    return segment + header->slotsOffset + uint64_t(slot) * header->slotSize;
+}
+
+SlotHeader * slotHeader(unsigned char * segment, uint32_t slot)
+{
+    return reinterpret_cast<SlotHeader *>(slotBase(segment, slot));
+}
+
+// Size in bytes of a pixel of an image written by a client, 0 if its layout or its data type is unknown
+uint32_t pixelSize(uint32_t imageLayout, uint32_t imageDataType)
+{
+    uint32_t nbChannels = 0;
+    switch (static_cast<Image::ImageLayout>(imageLayout)) {
+        case Image::ImageLayout::LAYOUT_GREY: nbChannels = 1; break;
+        case Image::ImageLayout::LAYOUT_RGB:
+        case Image::ImageLayout::LAYOUT_GRB:
+        case Image::ImageLayout::LAYOUT_BGR: nbChannels = 3; break;
+        case Image::ImageLayout::LAYOUT_RGBA:
+        case Image::ImageLayout::LAYOUT_RGBX: nbChannels = 4; break;
+        default: return 0;
+    }
+    switch (static_cast<Image::DataType>(imageDataType)) {
+        case Image::DataType::TYPE_8U: return nbChannels;
+        case Image::DataType::TYPE_16U: return nbChannels * 2;
+        case Image::DataType::TYPE_32U: return nbChannels * 4;
+        case Image::DataType::TYPE_64U: return nbChannels * 8;
+        default: return 0;
+    }
+}
+
+timespec deadlineIn(uint32_t timeoutMs)
+{
+    timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeoutMs / 1000;
+    deadline.tv_nsec += long(timeoutMs % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    return deadline;
+}
+
+bool isPast(const timespec & deadline)
+{
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return now.tv_sec > deadline.tv_sec || (now.tv_sec == deadline.tv_sec && now.tv_nsec >= deadline.tv_nsec);
+}
+
+}
+
+ExtractionServer::~ExtractionServer()
+{
+    destroy();
+}
+
+FrameworkReturnCode ExtractionServer::create(const std::string & name,
+                                             const SRef<api::features::IDescriptorsExtractorFromImage> extractor,
+                                             const ExtractionChannelConfig & config)
+{
+    destroy();
+    if (!extractor || config.maxClients == 0 || config.slotsPerClient == 0) {
+        LOG_ERROR("ExtractionServer::create requires an extractor and at least one client slot");
+        return FrameworkReturnCode::_ERROR_;
+    }
+
+    SegmentHeader layout;
+    layout.maxImageBytes = config.maxImageBytes;
+    layout.maxKeypoints = config.maxKeypoints;
+    uint64_t slotSize = descriptorsOffset(&layout) + align(uint64_t(config.maxKeypoints) * config.maxDescriptorBytes);
+    uint64_t clientsOffset = align(sizeof(SegmentHeader));
+    uint64_t slotsOffset = clientsOffset + align(uint64_t(config.maxClients) * sizeof(ClientEntry));
+    uint64_t segmentSize = slotsOffset + slotSize * config.maxClients * config.slotsPerClient;
+
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        LOG_ERROR("ExtractionServer::create cannot create the shared memory segment {}: {}", name, std::strerror(errno));
+        return FrameworkReturnCode::_ERROR_;
+    }
+    if (ftruncate(fd, off_t(segmentSize)) != 0) {
+        LOG_ERROR("ExtractionServer::create cannot allocate {} bytes for {}: {}", segmentSize, name, std::strerror(errno));
+        close(fd);
+        shm_unlink(name.c_str());
+        return FrameworkReturnCode::_ERROR_;
+    }
+    void * mapping = mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        LOG_ERROR("ExtractionServer::create cannot map {}: {}", name, std::strerror(errno));
+        shm_unlink(name.c_str());
+        return FrameworkReturnCode::_ERROR_;
+    }
+
+    m_name = name;
+    m_extractor = extractor;
+    m_segment = static_cast<unsigned char *>(mapping);
+    m_segmentSize = segmentSize;
+    m_stats = ExtractionServerStats();
+    m_stop = false;
+
+    SegmentHeader * header = new (m_segment) SegmentHeader;
+    header->magic = segmentMagic;
+    header->version = segmentVersion;
+    header->maxClients = config.maxClients;
+    header->slotsPerClient = config.slotsPerClient;
+    header->maxImageBytes = config.maxImageBytes;
+    header->maxKeypoints = config.maxKeypoints;
+    header->maxDescriptorBytes = config.maxDescriptorBytes;
+    header->clientsOffset = clientsOffset;
+    header->slotsOffset = slotsOffset;
+    header->slotSize = slotSize;
+    header->segmentSize = segmentSize;
+    header->sequence.store(0);
+    sem_init(&header->request, 1, 0);
+    for (uint32_t client = 0; client < config.maxClients; ++client)
+        new (&clientEntry(m_segment, client)->pid) std::atomic<int32_t>(0);
+    for (uint32_t slot = 0; slot < config.maxClients * config.slotsPerClient; ++slot) {
+        SlotHeader * slotHead = new (slotBase(m_segment, slot)) SlotHeader;
+        slotHead->state.store(Free);
+        sem_init(&slotHead->done, 1, 0);
+    }
+    header->running.store(1, std::memory_order_release);
+    LOG_INFO("ExtractionServer {} created: {} clients x {} slots, {} MB", name, config.maxClients, config.slotsPerClient, segmentSize >> 20);
+    return FrameworkReturnCode::_SUCCESS;
+}
+
+void ExtractionServer::destroy()
+{
+    if (m_segment == nullptr)
+        return;
+    SegmentHeader * header = segmentHeader(m_segment);
+    header->running.store(0, std::memory_order_release);
+    // wake up the clients waiting for a result, they see the server is no longer running
+    for (uint32_t slot = 0; slot < header->maxClients * header->slotsPerClient; ++slot)
+        sem_post(&slotHeader(m_segment, slot)->done);
+    munmap(m_segment, m_segmentSize);
+    shm_unlink(m_name.c_str());
+    m_segment = nullptr;
+    m_segmentSize = 0;
+}
+
+void ExtractionServer::stop()
+{
+    m_stop = true;
+}
+
+void ExtractionServer::run()
+{
+    auto lastReclaim = std::chrono::steady_clock::now();
+    while (!m_stop && m_segment != nullptr) {
+        processPending(100);
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastReclaim > std::chrono::seconds(1)) {
+            reclaimDeadClients();
+            lastReclaim = now;
+        }
+    }
+}
+
+void ExtractionServer::reclaimDeadClients()
+{
+    SegmentHeader * header = segmentHeader(m_segment);
+    for (uint32_t client = 0; client < header->maxClients; ++client) {
+        ClientEntry * entry = clientEntry(m_segment, client);
+        int32_t pid = entry->pid.load();
+        if (pid == 0 || kill(pid, 0) == 0 || errno != ESRCH)
+            continue;
+        for (uint32_t s = 0; s < header->slotsPerClient; ++s) {
+            SlotHeader * slot = slotHeader(m_segment, client * header->slotsPerClient + s);
+            while (sem_trywait(&slot->done) == 0) {}
+            slot->state.store(Free, std::memory_order_release);
+        }
+        entry->pid.store(0, std::memory_order_release);
+        m_stats.nbReclaimedClients++;
+        LOG_INFO("ExtractionServer reclaimed the ring of the dead client {}", pid);
+    }
+}
+
+uint32_t ExtractionServer::processPending(uint32_t timeoutMs)
+{
+    if (m_segment == nullptr)
+        return 0;
+    SegmentHeader * header = segmentHeader(m_segment);
+    timespec deadline = deadlineIn(timeoutMs);
+    if (sem_timedwait(&header->request, &deadline) != 0)
+        return 0;
+    // the slots are scanned after draining, so every request posted so far is part of this batch
+    while (sem_trywait(&header->request) == 0) {}
+
+    uint32_t nbSlots = header->maxClients * header->slotsPerClient;
+    m_batch.clear();
+    for (uint32_t slot = 0; slot < nbSlots; ++slot)
+        if (slotHeader(m_segment, slot)->state.load(std::memory_order_acquire) == Requested)
+            m_batch.push_back(slot);
+    std::sort(m_batch.begin(), m_batch.end(), [this](uint32_t a, uint32_t b) {
+        return slotHeader(m_segment, a)->sequence < slotHeader(m_segment, b)->sequence;
+    });
+
+    uint32_t nbServed = 0;
+    for (uint32_t slot : m_batch) {
+        SlotHeader * request = slotHeader(m_segment, slot);
+        uint32_t expected = Requested;
+        if (!request->state.compare_exchange_strong(expected, Processing, std::memory_order_acq_rel))
+            continue; // cancelled by the client
+        unsigned char * base = slotBase(m_segment, slot);
+
+        FrameworkReturnCode status = FrameworkReturnCode::_ERROR_;
+        SRef<DescriptorBuffer> descriptors;
+        m_keypoints.clear();
+        // the header is written by the client: an image overflowing the slot fails this request only. The size is bounded
+        // by divisions first, the product of arbitrary dimensions wrapping around.
+        uint32_t size = pixelSize(request->imageLayout, request->imageDataType);
+        bool fits = size > 0 && request->width > 0 && request->height > 0 &&
+                    request->width <= header->maxImageBytes / size / request->height;
+        if (!fits || uint64_t(request->width) * request->height * size != request->imageBytes) {
+            LOG_ERROR("ExtractionServer: invalid request of {}x{} pixels, layout {}, data type {} and {} bytes", request->width,
+                      request->height, request->imageLayout, request->imageDataType, request->imageBytes);
+        }
+        else {
+            try {
+                SRef<Image> image = xpcf::utils::make_shared<Image>(base + imageOffset(), request->width, request->height,
+                                                                    static_cast<Image::ImageLayout>(request->imageLayout),
+                                                                    Image::PixelOrder::INTERLEAVED,
+                                                                    static_cast<Image::DataType>(request->imageDataType));
+                status = m_extractor->extract(image, m_keypoints, descriptors);
+            }
+            catch (const std::exception & e) {
+                LOG_ERROR("ExtractionServer extraction failed: {}", e.what());
+            }
+        }
+
+        request->nbKeypoints = 0;
+        request->nbDescriptors = 0;
+        if (status == FrameworkReturnCode::_SUCCESS) {
+            uint32_t nbDescriptors = descriptors ? descriptors->getNbDescriptors() : 0;
+            uint32_t elementSize = descriptors && descriptors->getDescriptorDataType() == DescriptorDataType::TYPE_32F ? 4 : 1;
+            uint64_t descriptorBytes = descriptors ? uint64_t(nbDescriptors) * descriptors->getDescriptorLength() * elementSize : 0;
+            if (m_keypoints.size() > header->maxKeypoints || descriptorBytes > uint64_t(header->maxKeypoints) * header->maxDescriptorBytes) {
+                LOG_ERROR("ExtractionServer: {} keypoints exceed the slot capacity of {}", m_keypoints.size(), header->maxKeypoints);
+                status = FrameworkReturnCode::_ERROR_;
+            }
+            else {
+                PackedKeypoint * packed = reinterpret_cast<PackedKeypoint *>(base + keypointsOffset(header));
+                for (const Keypoint & keypoint : m_keypoints)
+                    *packed++ = { keypoint.getId(), keypoint.getX(), keypoint.getY(), keypoint.getSize(), keypoint.getAngle(),
+                                  keypoint.getResponse(), keypoint.getOctave(), keypoint.getClassId() };
+                request->nbKeypoints = static_cast<uint32_t>(m_keypoints.size());
+                if (descriptors) {
+                    std::memcpy(base + descriptorsOffset(header), descriptors->data(), descriptorBytes);
+                    request->nbDescriptors = nbDescriptors;
+                    request->descriptorLength = descriptors->getDescriptorLength();
+                    request->descriptorDataType = static_cast<uint32_t>(descriptors->getDescriptorDataType());
+                    request->descriptorType = static_cast<uint32_t>(descriptors->getDescriptorType());
+                }
+            }
+        }
+        request->status = static_cast<int32_t>(status);
+
+        expected = Processing;
+        if (request->state.compare_exchange_strong(expected, Done, std::memory_order_acq_rel))
+            sem_post(&request->done);
+        else
+            request->state.store(Free, std::memory_order_release); // the client gave up
+        ++nbServed;
+    }
+
+    if (nbServed > 0) {
+        m_stats.nbRequests += nbServed;
+        m_stats.nbBatches++;
+        m_stats.maxBatchSize = std::max(m_stats.maxBatchSize, nbServed);
+    }
+    return nbServed;
+}
+
+ExtractionClient::~ExtractionClient()
+{
+    disconnect();
+}
+
+FrameworkReturnCode ExtractionClient::connect(const std::string & name)
+{
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    release();
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        LOG_ERROR("ExtractionClient cannot open the shared memory segment {}: {}", name, std::strerror(errno));
+        return FrameworkReturnCode::_ERROR_;
+    }
+    struct stat segmentStat;
+    if (fstat(fd, &segmentStat) != 0 || uint64_t(segmentStat.st_size) < sizeof(SegmentHeader)) {
+        LOG_ERROR("ExtractionClient: {} is not an extraction server segment", name);
+        close(fd);
+        return FrameworkReturnCode::_ERROR_;
+    }
+    std::size_t segmentSize = static_cast<std::size_t>(segmentStat.st_size);
+    void * mapping = mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        LOG_ERROR("ExtractionClient cannot map {}: {}", name, std::strerror(errno));
+        return FrameworkReturnCode::_ERROR_;
+    }
+    unsigned char * segment = static_cast<unsigned char *>(mapping);
+    SegmentHeader * header = segmentHeader(segment);
+    if (header->magic != segmentMagic || header->version != segmentVersion || header->segmentSize != segmentSize
+            || header->running.load(std::memory_order_acquire) == 0) {
+        LOG_ERROR("ExtractionClient: the server of {} is not running or has an incompatible version", name);
+        munmap(mapping, segmentSize);
+        return FrameworkReturnCode::_ERROR_;
+    }
+    int32_t pid = static_cast<int32_t>(getpid());
+    for (uint32_t client = 0; client < header->maxClients; ++client) {
+        int32_t expected = 0;
+        if (clientEntry(segment, client)->pid.compare_exchange_strong(expected, pid)) {
+            m_segment = segment;
+            m_segmentSize = segmentSize;
+            m_clientIndex = client;
+            m_connection++;
+            return FrameworkReturnCode::_SUCCESS;
+        }
+    }
+    LOG_ERROR("ExtractionClient: the {} client rings of {} are in use", header->maxClients, name);
+    munmap(mapping, segmentSize);
+    return FrameworkReturnCode::_ERROR_;
+}
+
+void ExtractionClient::disconnect()
+{
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    release();
+}
+
+bool ExtractionClient::isConnected() const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_segment != nullptr;
+}
+
+void ExtractionClient::release()
+{
+    if (m_segment == nullptr)
+        return;
+    clientEntry(m_segment, m_clientIndex)->pid.store(0, std::memory_order_release);
+    munmap(m_segment, m_segmentSize);
+    m_segment = nullptr;
+    m_segmentSize = 0;
+}
+
+FrameworkReturnCode ExtractionClient::extract(const SRef<Image> image,
+                                              std::vector<Keypoint> & keypoints,
+                                              SRef<DescriptorBuffer> & descriptors,
+                                              uint32_t timeoutMs)
+{
+    bool serverStopped = false;
+    uint64_t connection = 0;
+    FrameworkReturnCode status = FrameworkReturnCode::_ERROR_;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        connection = m_connection;
+        status = send(image, keypoints, descriptors, timeoutMs, serverStopped);
+    }
+    // a restarted server creates a new segment: the one of the stopped server is released, unless another thread
+    // already connected again
+    if (serverStopped) {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        if (m_connection == connection)
+            release();
+    }
+    return status;
+}
+
+FrameworkReturnCode ExtractionClient::send(const SRef<Image> image,
+                                           std::vector<Keypoint> & keypoints,
+                                           SRef<DescriptorBuffer> & descriptors,
+                                           uint32_t timeoutMs,
+                                           bool & serverStopped)
+{
+    keypoints.clear();
+    if (m_segment == nullptr || !image)
+        return FrameworkReturnCode::_ERROR_;
+    SegmentHeader * header = segmentHeader(m_segment);
+    if (header->running.load(std::memory_order_acquire) == 0) {
+        LOG_ERROR("ExtractionClient: the extraction server has stopped");
+        serverStopped = true;
+        return FrameworkReturnCode::_ERROR_;
+    }
+    uint64_t imageBytes = image->getBufferSize();
+    if (imageBytes > header->maxImageBytes) {
+        LOG_ERROR("ExtractionClient: image of {} bytes exceeds the server limit of {} bytes", imageBytes, header->maxImageBytes);
+        return FrameworkReturnCode::_ERROR_;
+    }
+
+    // take a free slot of the ring
+    timespec deadline = deadlineIn(timeoutMs);
+    uint32_t slot = 0;
+    SlotHeader * request = nullptr;
+    while (request == nullptr) {
+        for (uint32_t s = 0; s < header->slotsPerClient && request == nullptr; ++s) {
+            slot = m_clientIndex * header->slotsPerClient + s;
+            uint32_t expected = Free;
+            if (slotHeader(m_segment, slot)->state.compare_exchange_strong(expected, Writing, std::memory_order_acq_rel))
+                request = slotHeader(m_segment, slot);
+        }
+        if (request == nullptr) {
+            if (isPast(deadline)) {
+                LOG_ERROR("ExtractionClient: no free slot before timeout");
+                return FrameworkReturnCode::_ERROR_;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+    unsigned char * base = slotBase(m_segment, slot);
+    while (sem_trywait(&request->done) == 0) {}
+    request->width = image->getWidth();
+    request->height = image->getHeight();
+    request->imageLayout = static_cast<uint32_t>(image->getImageLayout());
+    request->imageDataType = static_cast<uint32_t>(image->getDataType());
+    request->imageBytes = imageBytes;
+    std::memcpy(base + imageOffset(), image->data(), imageBytes);
+    request->sequence = header->sequence.fetch_add(1);
+    request->state.store(Requested, std::memory_order_release);
+    sem_post(&header->request);
+
+    // wait for the result, or cancel the request
+    while (request->state.load(std::memory_order_acquire) != Done) {
+        if (header->running.load(std::memory_order_acquire) == 0) {
+            LOG_ERROR("ExtractionClient: the extraction server has stopped");
+            serverStopped = true;
+            return FrameworkReturnCode::_ERROR_;
+        }
+        if (sem_timedwait(&request->done, &deadline) == 0 || errno == EINTR)
+            continue;
+        uint32_t expected = Requested;
+        if (request->state.compare_exchange_strong(expected, Free, std::memory_order_acq_rel)) {
+            LOG_ERROR("ExtractionClient: request not served before timeout");
+            return FrameworkReturnCode::_ERROR_;
+        }
+        expected = Processing;
+        if (request->state.compare_exchange_strong(expected, Orphaned, std::memory_order_acq_rel)) {
+            LOG_ERROR("ExtractionClient: extraction not finished before timeout");
+            return FrameworkReturnCode::_ERROR_;
+        }
+    }
+
+    FrameworkReturnCode status = static_cast<FrameworkReturnCode>(request->status);
+    if (status == FrameworkReturnCode::_SUCCESS) {
+        const PackedKeypoint * packed = reinterpret_cast<const PackedKeypoint *>(base + keypointsOffset(header));
+        keypoints.resize(request->nbKeypoints);
+        for (uint32_t i = 0; i < request->nbKeypoints; ++i, ++packed)
+            keypoints[i].init(packed->id, packed->x, packed->y, 0.0f, 0.0f, 0.0f, packed->size, packed->angle,
+                              packed->response, packed->octave, packed->classId);
+        descriptors.reset(new DescriptorBuffer(base + descriptorsOffset(header),
+                                               static_cast<DescriptorType>(request->descriptorType),
+                                               static_cast<DescriptorDataType>(request->descriptorDataType),
+                                               request->descriptorLength, request->nbDescriptors));
+    }
+    request->state.store(Free, std::memory_order_release);
+    return status;
+}
+
+#else // _WIN32
+
+ExtractionServer::~ExtractionServer() {}
+
+FrameworkReturnCode ExtractionServer::create(const std::string &, const SRef<api::features::IDescriptorsExtractorFromImage>, const ExtractionChannelConfig &)
+{
+    LOG_ERROR("ExtractionServer requires POSIX shared memory");
+    return FrameworkReturnCode::_ERROR_;
+}
+
+void ExtractionServer::run() {}
+uint32_t ExtractionServer::processPending(uint32_t) { return 0; }
+void ExtractionServer::stop() { m_stop = true; }
+void ExtractionServer::destroy() {}
+void ExtractionServer::reclaimDeadClients() {}
+
+ExtractionClient::~ExtractionClient() {}
+
+FrameworkReturnCode ExtractionClient::connect(const std::string &)
+{
+    LOG_ERROR("ExtractionClient requires POSIX shared memory");
+    return FrameworkReturnCode::_ERROR_;
+}
+
+void ExtractionClient::disconnect() {}
+bool ExtractionClient::isConnected() const { return false; }
+
+FrameworkReturnCode ExtractionClient::extract(const SRef<Image>, std::vector<Keypoint> &, SRef<DescriptorBuffer> &, uint32_t)
+{
+    return FrameworkReturnCode::_ERROR_;
+}
+
+#endif
+
+}
+}
+}
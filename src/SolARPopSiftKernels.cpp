@@ -0,0 +1,268 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SolARPopSiftKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define POPSIFT_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(POPSIFT_KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define POPSIFT_KERNELS_AVX2 1
+#define POPSIFT_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define POPSIFT_TARGET_POPCNT __attribute__((target("popcnt")))
+#define POPSIFT_TARGET_AVX512_POPCNT __attribute__((target("avx2,avx512f,avx512vpopcntdq")))
+#endif
+
+namespace SolAR {
+namespace MODULES {
+namespace POPSIFT {
+namespace kernels {
+
+namespace {
+
+float l2sqrScalar(const float * a, const float * b, std::size_t length)
+{
+    float sum = 0.0f;
+    for (std::size_t i = 0; i < length; ++i) {
+        float d = a[i] - b[i];
+        sum += d * d;
+    }
+    return sum;
+}
+
+#ifdef POPSIFT_KERNELS_X86
+float l2sqrSSE2(const float * a, const float * b, std::size_t length)
+{
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        __m128 d0 = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+        __m128 d1 = _mm_sub_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4));
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(d0, d0));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(d1, d1));
+    }
+    alignas(16) float partial[4];
+    _mm_store_ps(partial, _mm_add_ps(acc0, acc1));
+    float sum = partial[0] + partial[1] + partial[2] + partial[3];
+    return sum + l2sqrScalar(a + i, b + i, length - i);
+}
+#endif
+
+#ifdef POPSIFT_KERNELS_AVX2
+POPSIFT_TARGET_AVX2 float l2sqrAVX2(const float * a, const float * b, std::size_t length)
+{
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+        acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+        acc1 = _mm256_fmadd_ps(d1, d1, acc1);
+    }
+    __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 half = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+    return _mm_cvtss_f32(half) + l2sqrScalar(a + i, b + i, length - i);
+}
+#endif
+
+// Hamming distances between 256-bit codes, stored as 4 words of 64 bits
+
+uint32_t popcount64Scalar(uint64_t x)
+{
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return static_cast<uint32_t>((x * 0x0101010101010101ULL) >> 56);
+}
+
+uint32_t hamming256Scalar(const uint64_t * a, const uint64_t * b)
+{
+    return popcount64Scalar(a[0] ^ b[0]) + popcount64Scalar(a[1] ^ b[1])
+         + popcount64Scalar(a[2] ^ b[2]) + popcount64Scalar(a[3] ^ b[3]);
+}
+
+void hamming256RowsScalar(const uint64_t * query, const uint64_t * codes, std::size_t nbCodes, uint32_t * distances)
+{
+    for (std::size_t r = 0; r < nbCodes; ++r)
+        distances[r] = hamming256Scalar(query, codes + r * 4);
+}
+
+#ifdef POPSIFT_KERNELS_AVX2
+POPSIFT_TARGET_POPCNT uint32_t hamming256Popcnt(const uint64_t * a, const uint64_t * b)
+{
+    return static_cast<uint32_t>(_mm_popcnt_u64(a[0] ^ b[0]) + _mm_popcnt_u64(a[1] ^ b[1])
+                               + _mm_popcnt_u64(a[2] ^ b[2]) + _mm_popcnt_u64(a[3] ^ b[3]));
+}
+
+POPSIFT_TARGET_POPCNT void hamming256RowsPopcnt(const uint64_t * query, const uint64_t * codes, std::size_t nbCodes, uint32_t * distances)
+{
+    for (std::size_t r = 0; r < nbCodes; ++r)
+        distances[r] = hamming256Popcnt(query, codes + r * 4);
+}
+
+// Nibble lookup popcount: the bytes of the xor are counted with two shuffles and summed by psadbw
+POPSIFT_TARGET_AVX2 void hamming256RowsAVX2(const uint64_t * query, const uint64_t * codes, std::size_t nbCodes, uint32_t * distances)
+{
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowMask = _mm256_set1_epi8(0x0f);
+    const __m256i q = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(query));
+    for (std::size_t r = 0; r < nbCodes; ++r) {
+        __m256i v = _mm256_xor_si256(q, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(codes + r * 4)));
+        __m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, lowMask));
+        __m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask));
+        __m256i sums = _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256());
+        __m128i half = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+        distances[r] = static_cast<uint32_t>(_mm_cvtsi128_si64(half) + _mm_extract_epi64(half, 1));
+    }
+}
+
+// GCC 12 warns about the undefined pass-through operand of the unmasked AVX-512 intrinsics
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+// Two codes per 512-bit register counted by vpopcntq, the word counts of 8 codes being summed in registers
+POPSIFT_TARGET_AVX512_POPCNT void hamming256RowsAVX512(const uint64_t * query, const uint64_t * codes, std::size_t nbCodes, uint32_t * distances)
+{
+    const __m512i q = _mm512_set_epi64(int64_t(query[3]), int64_t(query[2]), int64_t(query[1]), int64_t(query[0]),
+                                       int64_t(query[3]), int64_t(query[2]), int64_t(query[1]), int64_t(query[0]));
+    const __m512i order = _mm512_set_epi64(7, 5, 6, 4, 3, 1, 2, 0);
+    std::size_t r = 0;
+    for (; r + 8 <= nbCodes; r += 8) {
+        const uint64_t * block = codes + r * 4;
+        __m512i c0 = _mm512_popcnt_epi64(_mm512_xor_si512(q, _mm512_loadu_si512(block)));
+        __m512i c1 = _mm512_popcnt_epi64(_mm512_xor_si512(q, _mm512_loadu_si512(block + 8)));
+        __m512i c2 = _mm512_popcnt_epi64(_mm512_xor_si512(q, _mm512_loadu_si512(block + 16)));
+        __m512i c3 = _mm512_popcnt_epi64(_mm512_xor_si512(q, _mm512_loadu_si512(block + 24)));
+        // sums of word pairs, then of the two halves of each code
+        __m512i s01 = _mm512_add_epi64(_mm512_unpacklo_epi64(c0, c1), _mm512_unpackhi_epi64(c0, c1));
+        __m512i s23 = _mm512_add_epi64(_mm512_unpacklo_epi64(c2, c3), _mm512_unpackhi_epi64(c2, c3));
+        __m512i sums = _mm512_add_epi64(_mm512_shuffle_i64x2(s01, s23, _MM_SHUFFLE(2, 0, 2, 0)),
+                                        _mm512_shuffle_i64x2(s01, s23, _MM_SHUFFLE(3, 1, 3, 1)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(distances + r), _mm512_cvtepi64_epi32(_mm512_permutexvar_epi64(order, sums)));
+    }
+    for (; r < nbCodes; ++r)
+        distances[r] = hamming256Popcnt(query, codes + r * 4);
+}
+#pragma GCC diagnostic pop
+#endif
+
+using L2Function = float (*)(const float *, const float *, std::size_t);
+
+struct Dispatch {
+    L2Function l2;
+    const char * name;
+};
+
+Dispatch selectDispatch()
+{
+#ifdef POPSIFT_KERNELS_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return { l2sqrAVX2, "AVX2" };
+#endif
+#ifdef POPSIFT_KERNELS_X86
+    return { l2sqrSSE2, "SSE2" };
+#else
+    return { l2sqrScalar, "Scalar" };
+#endif
+}
+
+const Dispatch & dispatch()
+{
+    static const Dispatch selected = selectDispatch();
+    return selected;
+}
+
+using HammingFunction = uint32_t (*)(const uint64_t *, const uint64_t *);
+using HammingRowsFunction = void (*)(const uint64_t *, const uint64_t *, std::size_t, uint32_t *);
+
+struct HammingDispatch {
+    HammingFunction hamming;
+    HammingRowsFunction rows;
+    const char * name;
+};
+
+HammingDispatch selectHammingDispatch()
+{
+#ifdef POPSIFT_KERNELS_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("popcnt")) {
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq") && __builtin_cpu_supports("avx2"))
+            return { hamming256Popcnt, hamming256RowsAVX512, "AVX512VPOPCNTDQ" };
+        if (__builtin_cpu_supports("avx2"))
+            return { hamming256Popcnt, hamming256RowsAVX2, "AVX2" };
+        return { hamming256Popcnt, hamming256RowsPopcnt, "POPCNT" };
+    }
+#endif
+    return { hamming256Scalar, hamming256RowsScalar, "Scalar" };
+}
+
+const HammingDispatch & hammingDispatch()
+{
+    static const HammingDispatch selected = selectHammingDispatch();
+    return selected;
+}
+
+}
+
+float l2sqr(const float * a, const float * b, std::size_t length)
+{
+    return dispatch().l2(a, b, length);
+}
+
+void l2sqrRows(const float * query, const float * rows, std::size_t nbRows, std::size_t length, float * distances)
+{
+    L2Function l2 = dispatch().l2;
+    for (std::size_t r = 0; r < nbRows; ++r)
+        distances[r] = l2(query, rows + r * length, length);
+}
+
+void toFloat(const uint8_t * src, float * dst, std::size_t nbElements)
+{
+    for (std::size_t i = 0; i < nbElements; ++i)
+        dst[i] = static_cast<float>(src[i]);
+}
+
+const char * instructionSet()
+{
+    return dispatch().name;
+}
+
+uint32_t hamming256(const uint64_t * a, const uint64_t * b)
+{
+    return hammingDispatch().hamming(a, b);
+}
+
+void hamming256Rows(const uint64_t * query, const uint64_t * codes, std::size_t nbCodes, uint32_t * distances)
+{
+    hammingDispatch().rows(query, codes, nbCodes, distances);
+}
+
+const char * hammingInstructionSet()
+{
+    return hammingDispatch().name;
+}
+
+}
+}
+}
+}
@@ -0,0 +1,196 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SolARPopSiftQualityController.h"
+#include "core/Log.h"
+
+#include <algorithm>
+
+namespace SolAR {
+namespace MODULES {
+namespace POPSIFT {
+
+namespace {
+
+const float maxDegradeStep = 2.0f;      // largest change of the threshold or of the keypoint cap in one frame
+const float improveStep = 1.1f;         // change of the threshold or of the keypoint cap when under budget
+const float conversionShare = 0.3f;     // share of the conversion in the frame time above which keypoints are capped first
+const float spikeRatio = 1.5f;          // a frame this much over budget is acted on without waiting for the average
+const float minOctaveCostRatio = 2.0f;  // lowest cost ratio of one more octave at the bottom of the pyramid
+const uint32_t initialProbeBackoff = 8; // frames before probing again an octave that did not fit
+const uint32_t maxProbeBackoff = 512;
+
+}
+
+QualityController::QualityController(const QualityControllerConfig & config)
+{
+    setConfig(config);
+}
+
+void QualityController::setConfig(const QualityControllerConfig & config)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config = config;
+    m_config.maxThreshold = std::max(m_config.maxThreshold, m_config.base.threshold);
+    m_config.minKeypoints = std::min(m_config.minKeypoints, m_config.base.maxKeypoints);
+    m_config.smoothing = std::min(1.0f, std::max(0.01f, m_config.smoothing));
+    m_state = QualityState();
+    m_state.enabled = m_config.targetLatency > 0.0f;
+    m_state.targetLatency = m_config.targetLatency;
+    m_state.settings = m_config.base;
+    m_settle = 0;
+    m_resetAverage = true;
+    m_probing = false;
+    m_probeBackoff = 0;
+    m_probeBackoffLength = initialProbeBackoff;
+}
+
+void QualityController::setTargetLatency(float targetLatency)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config.targetLatency = std::max(0.0f, targetLatency);
+    m_state.enabled = m_config.targetLatency > 0.0f;
+    m_state.targetLatency = m_config.targetLatency;
+    if (!m_state.enabled)
+        m_state.settings = m_config.base;
+    m_resetAverage = true;
+}
+
+bool QualityController::update(float detectionTime, float conversionTime, uint32_t nbKeypoints)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    float latency = detectionTime + conversionTime;
+    m_state.lastLatency = latency;
+    m_state.detectionTime = detectionTime;
+    m_state.conversionTime = conversionTime;
+    m_state.lastNbKeypoints = nbKeypoints;
+    m_state.nbFrames++;
+    if (!m_state.enabled)
+        return false;
+
+    float target = m_config.targetLatency;
+    if (latency > target)
+        m_state.nbFramesOverBudget++;
+    if (m_resetAverage) {
+        m_state.smoothedLatency = latency;
+        m_resetAverage = false;
+    }
+    else
+        m_state.smoothedLatency += m_config.smoothing * (latency - m_state.smoothedLatency);
+
+    if (m_probeBackoff > 0)
+        --m_probeBackoff;
+    // the frames following a change of the pyramid size are not representative
+    if (m_settle > 0) {
+        --m_settle;
+        return false;
+    }
+
+    float measure = latency > spikeRatio * target ? std::max(latency, m_state.smoothedLatency) : m_state.smoothedLatency;
+    float upperBound = target * (1.0f + m_config.deadband);
+    bool changed = false;
+    if (m_probing) {
+        m_probing = false;
+        if (measure > upperBound) {
+            // the octave restored does not fit: skip it again and wait longer before the next probe
+            m_state.settings.firstOctave++;
+            m_settle = m_config.settleFrames;
+            m_resetAverage = true;
+            m_probeBackoff = m_probeBackoffLength;
+            m_probeBackoffLength = std::min(maxProbeBackoff, 2 * m_probeBackoffLength);
+            changed = true;
+        }
+        else
+            m_probeBackoffLength = initialProbeBackoff;
+    }
+    if (!changed) {
+        if (measure > upperBound)
+            changed = degrade(measure / target);
+        else if (measure < target * (1.0f - m_config.deadband))
+            changed = improve();
+    }
+    if (changed) {
+        m_state.nbAdjustments++;
+        LOG_DEBUG("QualityController: {} ms for a target of {} ms, threshold {}, keypoint cap {}, first octave {}",
+                  measure, target, m_state.settings.threshold, m_state.settings.maxKeypoints, m_state.settings.firstOctave);
+    }
+    return changed;
+}
+
+bool QualityController::degrade(float ratio)
+{
+    QualitySettings & settings = m_state.settings;
+    float step = std::min(maxDegradeStep, std::max(improveStep, ratio));
+    bool conversionWeighs = m_state.conversionTime > conversionShare * m_state.lastLatency;
+    bool canCap = settings.maxKeypoints > m_config.minKeypoints;
+    // a cap above the number of keypoints extracted has no effect, start from that number
+    auto cap = [&]() {
+        uint32_t current = std::min(settings.maxKeypoints, std::max(m_state.lastNbKeypoints, m_config.minKeypoints));
+        settings.maxKeypoints = std::max(m_config.minKeypoints, uint32_t(float(current) / step));
+    };
+
+    if (conversionWeighs && canCap)
+        cap();
+    else if (settings.threshold < m_config.maxThreshold)
+        settings.threshold = std::min(m_config.maxThreshold, settings.threshold * step);
+    else if (canCap)
+        cap();
+    else if (settings.firstOctave < m_config.maxFirstOctave) {
+        settings.firstOctave++;
+        m_settle = m_config.settleFrames;
+        m_resetAverage = true;
+    }
+    else
+        return false;
+    return true;
+}
+
+bool QualityController::improve()
+{
+    QualitySettings & settings = m_state.settings;
+    // the cost of an octave depends on the share of the pyramid in the detection time, which is not measured:
+    // the octave is probed when it may fit, and given up if it does not
+    if (settings.firstOctave > m_config.base.firstOctave && m_probeBackoff == 0 &&
+        m_state.smoothedLatency * minOctaveCostRatio < m_config.targetLatency * (1.0f + m_config.deadband)) {
+        settings.firstOctave--;
+        m_settle = m_config.settleFrames;
+        m_resetAverage = true;
+        m_probing = true;
+    }
+    else if (settings.threshold > m_config.base.threshold)
+        settings.threshold = std::max(m_config.base.threshold, settings.threshold / improveStep);
+    else if (settings.maxKeypoints < m_config.base.maxKeypoints)
+        settings.maxKeypoints = std::min(m_config.base.maxKeypoints, uint32_t(float(settings.maxKeypoints) * improveStep) + 1);
+    else
+        return false;
+    return true;
+}
+
+QualitySettings QualityController::getSettings() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_state.settings;
+}
+
+QualityState QualityController::getState() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_state;
+}
+
+}
+}
+}
@@ -0,0 +1,172 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SolARPopSiftStereoMatcher.h"
+#include "SolARPopSiftKernels.h"
+#include "core/Log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace SolAR {
+using namespace datastructure;
+namespace MODULES {
+namespace POPSIFT {
+
+RectifiedStereoMatcher::RectifiedStereoMatcher(const StereoMatcherConfig & config)
+{
+    setConfig(config);
+}
+
+void RectifiedStereoMatcher::setConfig(const StereoMatcherConfig & config)
+{
+    m_config = config;
+    m_config.rowTolerance = std::max(config.rowTolerance, 0.0f);
+    // a left keypoint then covers at most three bands
+    m_bandHeight = std::max(m_config.rowTolerance, 1.0f);
+}
+
+FrameworkReturnCode RectifiedStereoMatcher::match(const std::vector<Keypoint> & leftKeypoints,
+                                                  const SRef<DescriptorBuffer> leftDescriptors,
+                                                  const std::vector<Keypoint> & rightKeypoints,
+                                                  const SRef<DescriptorBuffer> rightDescriptors,
+                                                  std::vector<DescriptorMatch> & matches,
+                                                  std::vector<float> & disparities)
+{
+    matches.clear();
+    disparities.clear();
+    m_nbDistanceEvaluations = 0;
+    if (!leftDescriptors || !rightDescriptors) {
+        LOG_ERROR("Stereo matching requires the descriptors of both images");
+        return FrameworkReturnCode::_ERROR_;
+    }
+    if (leftDescriptors->getDescriptorDataType() != DescriptorDataType::TYPE_32F ||
+        rightDescriptors->getDescriptorDataType() != DescriptorDataType::TYPE_32F ||
+        leftDescriptors->getDescriptorLength() != rightDescriptors->getDescriptorLength()) {
+        LOG_ERROR("Stereo matching requires float descriptors of the same length");
+        return FrameworkReturnCode::_ERROR_;
+    }
+    if (leftDescriptors->getNbDescriptors() != leftKeypoints.size() || rightDescriptors->getNbDescriptors() != rightKeypoints.size()) {
+        LOG_ERROR("The number of descriptors does not match the number of keypoints");
+        return FrameworkReturnCode::_ERROR_;
+    }
+    match(leftKeypoints, static_cast<const float *>(leftDescriptors->data()),
+          rightKeypoints, static_cast<const float *>(rightDescriptors->data()),
+          leftDescriptors->getDescriptorLength(), matches, disparities);
+    return FrameworkReturnCode::_SUCCESS;
+}
+
+void RectifiedStereoMatcher::sortRightKeypoints(const std::vector<Keypoint> & keypoints, const float * descriptors, uint32_t descriptorLength)
+{
+    m_candidates.resize(keypoints.size());
+    int lastBand = 0;
+    m_firstBand = 0;
+    for (uint32_t i = 0; i < keypoints.size(); ++i) {
+        m_candidates[i] = { keypoints[i].getX(), keypoints[i].getY(), i };
+        int band = static_cast<int>(std::floor(m_candidates[i].y / m_bandHeight));
+        if (i == 0 || band < m_firstBand)
+            m_firstBand = band;
+        if (i == 0 || band > lastBand)
+            lastBand = band;
+    }
+    auto bandOf = [this](const Candidate & candidate) {
+        return static_cast<int>(std::floor(candidate.y / m_bandHeight)) - m_firstBand;
+    };
+    std::sort(m_candidates.begin(), m_candidates.end(), [&bandOf](const Candidate & a, const Candidate & b) {
+        int bandA = bandOf(a), bandB = bandOf(b);
+        return bandA != bandB ? bandA < bandB : a.x < b.x;
+    });
+
+    uint32_t nbBands = m_candidates.empty() ? 0 : static_cast<uint32_t>(lastBand - m_firstBand + 1);
+    m_bandStarts.assign(nbBands + 1, 0);
+    for (const Candidate & candidate : m_candidates)
+        ++m_bandStarts[bandOf(candidate) + 1];
+    for (uint32_t band = 0; band < nbBands; ++band)
+        m_bandStarts[band + 1] += m_bandStarts[band];
+
+    m_sortedDescriptors.resize(m_candidates.size() * descriptorLength);
+    for (size_t i = 0; i < m_candidates.size(); ++i)
+        std::memcpy(m_sortedDescriptors.data() + i * descriptorLength, descriptors + size_t(m_candidates[i].index) * descriptorLength,
+                    descriptorLength * sizeof(float));
+}
+
+void RectifiedStereoMatcher::match(const std::vector<Keypoint> & leftKeypoints, const float * leftDescriptors,
+                                   const std::vector<Keypoint> & rightKeypoints, const float * rightDescriptors,
+                                   uint32_t descriptorLength,
+                                   std::vector<DescriptorMatch> & matches,
+                                   std::vector<float> & disparities)
+{
+    matches.clear();
+    disparities.clear();
+    m_nbDistanceEvaluations = 0;
+    if (leftKeypoints.empty() || rightKeypoints.empty())
+        return;
+    sortRightKeypoints(rightKeypoints, rightDescriptors, descriptorLength);
+
+    const float k = m_config.rowTolerance;
+    const float ratio2 = m_config.ratio * m_config.ratio;
+    const float maxDistance2 = m_config.maxDistance * m_config.maxDistance;
+    const int nbBands = static_cast<int>(m_bandStarts.size()) - 1;
+    uint64_t nbEvaluations = 0;
+    for (uint32_t i = 0; i < leftKeypoints.size(); ++i) {
+        const float xL = leftKeypoints[i].getX();
+        const float yL = leftKeypoints[i].getY();
+        const float xMin = xL - m_config.maxDisparity;
+        const float xMax = xL - m_config.minDisparity;
+        const float * query = leftDescriptors + size_t(i) * descriptorLength;
+        int firstBand = std::max(static_cast<int>(std::floor((yL - k) / m_bandHeight)) - m_firstBand, 0);
+        int lastBand = std::min(static_cast<int>(std::floor((yL + k) / m_bandHeight)) - m_firstBand, nbBands - 1);
+
+        float best = std::numeric_limits<float>::max();
+        float second = std::numeric_limits<float>::max();
+        uint32_t bestCandidate = 0;
+        for (int band = firstBand; band <= lastBand; ++band) {
+            auto bandBegin = m_candidates.begin() + m_bandStarts[band];
+            auto bandEnd = m_candidates.begin() + m_bandStarts[band + 1];
+            auto it = std::lower_bound(bandBegin, bandEnd, xMin, [](const Candidate & candidate, float x) { return candidate.x < x; });
+            for (; it != bandEnd && it->x <= xMax; ++it) {
+                if (std::abs(it->y - yL) > k)
+                    continue;
+                size_t candidate = static_cast<size_t>(it - m_candidates.begin());
+                float distance = kernels::l2sqr(query, m_sortedDescriptors.data() + candidate * descriptorLength, descriptorLength);
+                ++nbEvaluations;
+                if (distance < best) {
+                    second = best;
+                    best = distance;
+                    bestCandidate = static_cast<uint32_t>(candidate);
+                }
+                else if (distance < second)
+                    second = distance;
+            }
+        }
+        if (best == std::numeric_limits<float>::max())
+            continue;
+        if (second != std::numeric_limits<float>::max() && best >= ratio2 * second)
+            continue;
+        if (maxDistance2 > 0.0f && best > maxDistance2)
+            continue;
+        const Candidate & right = m_candidates[bestCandidate];
+        matches.push_back(DescriptorMatch(i, right.index, std::sqrt(best)));
+        disparities.push_back(xL - right.x);
+    }
+    m_nbDistanceEvaluations = nbEvaluations;
+}
+
+}
+}
+}
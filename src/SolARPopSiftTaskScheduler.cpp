@@ -0,0 +1,389 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SolARPopSiftTaskScheduler.h"
+#include "core/Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace SolAR {
+namespace MODULES {
+namespace POPSIFT {
+
+namespace {
+
+const int nbSpinsBeforeSleep = 64;      // failed steal rounds before an idle worker sleeps
+
+uint64_t elapsedNs(std::chrono::steady_clock::time_point start)
+{
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+#ifdef __linux__
+// Parses a sysfs CPU list such as "0-3,8-11"
+std::vector<int> parseCpuList(const std::string & list)
+{
+    std::vector<int> cpus;
+    std::stringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        if (range.empty() || range == "\n")
+            continue;
+        std::size_t dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; ++cpu)
+            cpus.push_back(cpu);
+    }
+    return cpus;
+}
+#endif
+
+// CPUs allowed to the process, grouped by NUMA node
+std::vector<std::vector<int>> numaTopology()
+{
+    std::vector<std::vector<int>> nodes;
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+        return nodes;
+    for (int node = 0; ; ++node) {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!file)
+            break;
+        std::string list;
+        std::getline(file, list);
+        std::vector<int> cpus;
+        try {
+            for (int cpu : parseCpuList(list))
+                if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed))
+                    cpus.push_back(cpu);
+        }
+        catch (const std::exception &) {
+            cpus.clear();
+        }
+        if (!cpus.empty())
+            nodes.push_back(cpus);
+    }
+    // no NUMA information: a single node with the allowed CPUs
+    if (nodes.empty()) {
+        std::vector<int> cpus;
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            if (CPU_ISSET(cpu, &allowed))
+                cpus.push_back(cpu);
+        if (!cpus.empty())
+            nodes.push_back(cpus);
+    }
+#endif
+    return nodes;
+}
+
+}
+
+TaskGraph::TaskId TaskGraph::add(std::function<void()> work, std::vector<TaskId> dependencies)
+{
+    TaskId id = TaskId(m_tasks.size());
+    std::sort(dependencies.begin(), dependencies.end());
+    dependencies.erase(std::unique(dependencies.begin(), dependencies.end()), dependencies.end());
+    Task task;
+    task.work = std::move(work);
+    for (TaskId dependency : dependencies) {
+        if (dependency >= id) {
+            LOG_ERROR("TaskGraph: task {} cannot depend on task {} which is not added yet", id, dependency);
+            continue;
+        }
+        m_tasks[dependency].successors.push_back(id);
+        task.nbDependencies++;
+    }
+    m_tasks.push_back(std::move(task));
+    return id;
+}
+
+TaskScheduler::TaskScheduler(uint32_t nbThreads, bool pinWorkers) : m_pinWorkers(pinWorkers)
+{
+    if (nbThreads == 0)
+        nbThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    // workers fill a NUMA node before the next one
+    std::vector<std::pair<int, int>> placement;    // cpu, node
+    if (pinWorkers) {
+        std::vector<std::vector<int>> nodes = numaTopology();
+        for (int node = 0; node < int(nodes.size()); ++node)
+            for (int cpu : nodes[node])
+                placement.emplace_back(cpu, node);
+    }
+
+    m_workers.resize(nbThreads);
+    for (uint32_t i = 0; i < nbThreads; ++i) {
+        m_workers[i].reset(new Worker);
+        m_workers[i]->random.seed(i + 1);
+        if (!placement.empty()) {
+            const auto & slot = placement[i % placement.size()];
+            // the calling thread keeps its affinity, it is only assumed to run on the first node
+            m_workers[i]->cpu = i > 0 ? slot.first : -1;
+            m_workers[i]->numaNode = slot.second;
+        }
+    }
+    for (uint32_t i = 0; i < nbThreads; ++i) {
+        std::vector<uint32_t> & victims = m_workers[i]->victims;
+        for (uint32_t j = 0; j < nbThreads; ++j)
+            if (j != i && m_workers[j]->numaNode == m_workers[i]->numaNode)
+                victims.push_back(j);
+        for (uint32_t j = 0; j < nbThreads; ++j)
+            if (m_workers[j]->numaNode != m_workers[i]->numaNode)
+                victims.push_back(j);
+    }
+    for (uint32_t i = 1; i < nbThreads; ++i)
+        m_workers[i]->thread = std::thread(&TaskScheduler::workerLoop, this, i);
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stop = true;
+    }
+    m_start.notify_all();
+    m_wake.notify_all();
+    for (auto & worker : m_workers)
+        if (worker->thread.joinable())
+            worker->thread.join();
+}
+
+void TaskScheduler::run(TaskGraph & graph)
+{
+    if (graph.empty())
+        return;
+    std::lock_guard<std::mutex> runLock(m_runMutex);
+    auto start = std::chrono::steady_clock::now();
+    std::size_t nbTasks = graph.m_tasks.size();
+
+    if (m_workers.size() == 1) {
+        // the insertion order is a valid order
+        Worker & worker = *m_workers[0];
+        for (auto & task : graph.m_tasks)
+            task.work();
+        worker.nbTasks += nbTasks;
+        uint64_t time = elapsedNs(start);
+        worker.busyTime += time;
+        m_runTime += time;
+        return;
+    }
+
+    if (m_pendingSize < nbTasks) {
+        m_pending.reset(new std::atomic<uint32_t>[nbTasks]);
+        m_pendingSize = nbTasks;
+    }
+    for (std::size_t i = 0; i < nbTasks; ++i)
+        m_pending[i].store(graph.m_tasks[i].nbDependencies, std::memory_order_relaxed);
+    m_graph = &graph;
+    m_remaining.store(uint32_t(nbTasks));
+
+    // the tasks without dependencies are dealt to the workers
+    uint32_t next = 0;
+    for (std::size_t i = 0; i < nbTasks; ++i)
+        if (graph.m_tasks[i].nbDependencies == 0) {
+            Worker & worker = *m_workers[next];
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            worker.tasks.push_back(TaskGraph::TaskId(i));
+            next = (next + 1) % uint32_t(m_workers.size());
+        }
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        ++m_generation;
+    }
+    m_start.notify_all();
+
+    work(0);
+
+    // the graph is owned by the caller: wait for the workers to leave it
+    {
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_done.wait(lock, [this]() { return m_nbWorkersInGraph == 0; });
+    }
+    m_graph = nullptr;
+    m_runTime += elapsedNs(start);
+}
+
+void TaskScheduler::workerLoop(uint32_t index)
+{
+#ifdef __linux__
+    if (m_workers[index]->cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(m_workers[index]->cpu, &cpus);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0)
+            LOG_WARNING("TaskScheduler: worker {} cannot be pinned to CPU {}", index, m_workers[index]->cpu);
+    }
+#endif
+    uint64_t generation = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_start.wait(lock, [&]() { return m_stop || m_generation != generation; });
+            if (m_stop)
+                return;
+            generation = m_generation;
+            m_nbWorkersInGraph++;
+        }
+        work(index);
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            m_nbWorkersInGraph--;
+        }
+        m_done.notify_all();
+    }
+}
+
+void TaskScheduler::work(uint32_t index)
+{
+    int nbFailedRounds = 0;
+    while (m_remaining.load() > 0) {
+        uint64_t pushCount = m_pushCount.load();
+        if (executeOne(index)) {
+            nbFailedRounds = 0;
+            continue;
+        }
+        if (++nbFailedRounds < nbSpinsBeforeSleep) {
+            std::this_thread::yield();
+            continue;
+        }
+        // sleep until a task is pushed or the graph is done
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_nbSleeping++;
+        m_wake.wait(lock, [&]() { return m_stop || m_remaining.load() == 0 || m_pushCount.load() != pushCount; });
+        m_nbSleeping--;
+        nbFailedRounds = 0;
+    }
+}
+
+bool TaskScheduler::executeOne(uint32_t index)
+{
+    Worker & worker = *m_workers[index];
+    TaskGraph::TaskId id;
+    bool stolen = false;
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (!worker.tasks.empty()) {
+            id = worker.tasks.back();
+            worker.tasks.pop_back();
+        }
+        else
+            stolen = true;
+    }
+    if (stolen && !steal(index, id))
+        return false;
+
+    TaskGraph::Task & task = m_graph->m_tasks[id];
+    auto start = std::chrono::steady_clock::now();
+    task.work();
+    worker.busyTime.fetch_add(elapsedNs(start), std::memory_order_relaxed);
+    worker.nbTasks.fetch_add(1, std::memory_order_relaxed);
+    if (stolen)
+        worker.nbStolenTasks.fetch_add(1, std::memory_order_relaxed);
+
+    for (TaskGraph::TaskId successor : task.successors)
+        if (m_pending[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+            push(index, successor);
+    if (m_remaining.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_wake.notify_all();
+    }
+    return true;
+}
+
+bool TaskScheduler::steal(uint32_t index, TaskGraph::TaskId & task)
+{
+    Worker & worker = *m_workers[index];
+    std::size_t nbVictims = worker.victims.size();
+    if (nbVictims == 0)
+        return false;
+    // the workers of the same node come first, from a random start so that thieves spread over the victims
+    std::size_t nbLocal = 0;
+    while (nbLocal < nbVictims && m_workers[worker.victims[nbLocal]]->numaNode == worker.numaNode)
+        ++nbLocal;
+    auto tryRange = [&](std::size_t first, std::size_t count) {
+        if (count == 0)
+            return false;
+        std::size_t offset = worker.random() % count;
+        for (std::size_t i = 0; i < count; ++i) {
+            Worker & victim = *m_workers[worker.victims[first + (offset + i) % count]];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    };
+    return tryRange(0, nbLocal) || tryRange(nbLocal, nbVictims - nbLocal);
+}
+
+void TaskScheduler::push(uint32_t index, TaskGraph::TaskId task)
+{
+    Worker & worker = *m_workers[index];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(task);
+    }
+    m_pushCount++;
+    if (m_nbSleeping.load() > 0) {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_wake.notify_one();
+    }
+}
+
+std::vector<WorkerStats> TaskScheduler::getWorkerStats() const
+{
+    std::vector<WorkerStats> stats(m_workers.size());
+    double runTime = double(m_runTime.load()) * 1e-6;
+    for (std::size_t i = 0; i < m_workers.size(); ++i) {
+        const Worker & worker = *m_workers[i];
+        stats[i].cpu = worker.cpu;
+        stats[i].numaNode = worker.numaNode;
+        stats[i].nbTasks = worker.nbTasks.load();
+        stats[i].nbStolenTasks = worker.nbStolenTasks.load();
+        stats[i].busyTime = double(worker.busyTime.load()) * 1e-6;
+        stats[i].utilization = runTime > 0.0 ? std::min(1.0, stats[i].busyTime / runTime) : 0.0;
+    }
+    return stats;
+}
+
+void TaskScheduler::resetStats()
+{
+    std::lock_guard<std::mutex> runLock(m_runMutex);
+    for (auto & worker : m_workers) {
+        worker->nbTasks = 0;
+        worker->nbStolenTasks = 0;
+        worker->busyTime = 0;
+    }
+    m_runTime = 0;
+}
+
+}
+}
+}
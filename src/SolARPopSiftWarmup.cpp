@@ -0,0 +1,142 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SolARPopSiftWarmup.h"
+#include "core/Log.h"
+
+#include <exception>
+
+namespace SolAR {
+namespace MODULES {
+namespace POPSIFT {
+
+namespace {
+
+float elapsed(Warmup::Clock::time_point start)
+{
+    return std::chrono::duration<float, std::milli>(Warmup::Clock::now() - start).count();
+}
+
+}
+
+Warmup::~Warmup()
+{
+    join();
+}
+
+void Warmup::start(Clock::time_point configureStart, std::vector<WarmupStage> stages, bool background, bool contextReused)
+{
+    join();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        uint64_t nbConfigurations = m_metrics.nbConfigurations + 1;
+        m_metrics = StartupMetrics();
+        m_metrics.nbConfigurations = nbConfigurations;
+        m_metrics.background = background;
+        m_metrics.contextReused = contextReused;
+        m_configureStart = configureStart;
+        m_running = true;
+        m_firstFrame = true;
+    }
+    if (background)
+        m_thread = std::thread(&Warmup::run, this, std::move(stages));
+    else
+        run(std::move(stages));
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_metrics.configureTime = elapsed(configureStart);
+}
+
+void Warmup::setContextReused(bool contextReused)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_metrics.contextReused = contextReused;
+}
+
+void Warmup::run(std::vector<WarmupStage> stages)
+{
+    bool failed = false;
+    for (WarmupStage & stage : stages) {
+        auto stageStart = Clock::now();
+        try {
+            stage.work();
+        }
+        catch (const std::exception & e) {
+            LOG_ERROR("Warm-up failed: {}", e.what());
+            failed = true;
+        }
+        catch (...) {
+            LOG_ERROR("Warm-up failed");
+            failed = true;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_metrics.*stage.time += elapsed(stageStart);
+        if (failed)
+            break;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_metrics.readyTime = elapsed(m_configureStart);
+        m_metrics.ready = !failed;
+        m_metrics.failed = failed;
+        m_running = false;
+    }
+    m_done.notify_all();
+}
+
+bool Warmup::waitForFrame()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_running) {
+        auto waitStart = Clock::now();
+        m_done.wait(lock, [this]() { return !m_running; });
+        if (m_firstFrame)
+            m_metrics.firstFrameWaitTime = elapsed(waitStart);
+    }
+    m_firstFrame = false;
+    return m_metrics.ready;
+}
+
+bool Warmup::waitUntilReady(float timeout)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (timeout < 0.0f)
+        m_done.wait(lock, [this]() { return !m_running; });
+    else if (!m_done.wait_for(lock, std::chrono::duration<float, std::milli>(timeout), [this]() { return !m_running; }))
+        return false;
+    return m_metrics.ready;
+}
+
+void Warmup::join()
+{
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+bool Warmup::isReady() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_metrics.ready;
+}
+
+StartupMetrics Warmup::getMetrics() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_metrics;
+}
+
+}
+}
+}
@@ -0,0 +1,248 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "xpcf/xpcf.h"
+
+#include "IPopSiftBinaryCodes.h"
+#include "IPopSiftBinaryMatcher.h"
+#include "SolARPopSiftBinarySift.h"
+#include "SolARPopSiftKernels.h"
+#include "SolARTest_ModulePopSift_SyntheticDescriptors.h"
+#include "core/Log.h"
+
+#include <boost/log/core.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace SolAR;
+using namespace SolAR::datastructure;
+using namespace SolAR::MODULES::POPSIFT;
+using namespace SolAR::MODULES::POPSIFT::TEST;
+
+namespace xpcf  = org::bcom::xpcf;
+
+namespace {
+
+const uint32_t width = 640;
+const uint32_t height = 480;
+const uint32_t nbWords = BinarySiftEmbedding::nbWords;
+
+std::vector<uint64_t> encode(const BinarySiftEmbedding & embedding, const std::vector<float> & descriptors)
+{
+    std::vector<uint64_t> codes(descriptors.size() / descriptorLength * nbWords);
+    embedding.encode(descriptors.data(), descriptors.size() / descriptorLength, codes.data());
+    return codes;
+}
+
+}
+
+int main()
+{
+#if NDEBUG
+    boost::log::core::get()->set_logging_enabled(false);
+#endif
+    LOG_ADD_LOG_TO_CONSOLE();
+
+    int result = 0;
+
+    // Hamming kernel of the CPU against a bit by bit count, on a number of codes which is not a multiple of the vector width
+    std::mt19937_64 random64(11);
+    const uint32_t nbCodes = 1001;
+    std::vector<uint64_t> codes(nbCodes * nbWords);
+    for (uint64_t & word : codes)
+        word = random64();
+    std::vector<uint32_t> distances(nbCodes);
+    kernels::hamming256Rows(codes.data(), codes.data(), nbCodes, distances.data());
+    uint32_t nbWrongDistances = 0;
+    for (uint32_t i = 0; i < nbCodes; ++i) {
+        uint32_t expected = 0;
+        for (uint32_t w = 0; w < nbWords; ++w)
+            for (uint64_t bits = codes[w] ^ codes[i * nbWords + w]; bits; bits >>= 1)
+                expected += uint32_t(bits & 1);
+        nbWrongDistances += distances[i] != expected || kernels::hamming256(codes.data(), codes.data() + i * nbWords) != expected;
+    }
+    LOG_INFO("{} Hamming kernels", kernels::hammingInstructionSet());
+    if (nbWrongDistances > 0) {
+        LOG_ERROR("{} wrong Hamming distances with the {} kernels", nbWrongDistances, kernels::hammingInstructionSet());
+        result = -1;
+    }
+
+    // the random projection only depends on its seed, and the codes on the direction of the descriptors
+    MatchingSet set = createMatchingSet(5000, 300, 100, 7);
+    BinarySiftEmbedding embedding, sameEmbedding, otherEmbedding;
+    embedding.setRandom(1);
+    sameEmbedding.setRandom(1);
+    otherEmbedding.setRandom(2);
+    std::vector<float> scaled(set.database);
+    for (float & value : scaled)
+        value *= 2.0f;
+    std::vector<uint64_t> databaseCodes = encode(embedding, set.database);
+    std::vector<uint64_t> queryCodes = encode(embedding, set.queries);
+    if (encode(sameEmbedding, set.database) != databaseCodes || encode(otherEmbedding, set.database) == databaseCodes ||
+        encode(embedding, scaled) != databaseCodes) {
+        LOG_ERROR("Binary codes depend on something else than the seed and the direction of the descriptors");
+        result = -1;
+    }
+
+    // the trained thresholds split the sample in two halves
+    BinarySiftEmbedding trainedEmbedding;
+    trainedEmbedding.setRandom(1);
+    trainedEmbedding.train(set.database.data(), set.database.size() / descriptorLength);
+    std::vector<uint64_t> trainedCodes = encode(trainedEmbedding, set.database);
+    uint32_t nbUnbalancedBits = 0;
+    for (uint32_t bit = 0; bit < BinarySiftEmbedding::nbBits; ++bit) {
+        uint32_t nbSet = 0;
+        for (std::size_t i = 0; i < trainedCodes.size(); i += nbWords)
+            nbSet += uint32_t((trainedCodes[i + bit / 64] >> (bit % 64)) & 1);
+        float fraction = float(nbSet) * nbWords / trainedCodes.size();
+        nbUnbalancedBits += fraction < 0.45f || fraction > 0.55f;
+    }
+    if (nbUnbalancedBits > 0) {
+        LOG_ERROR("{} bits are not balanced by the training", nbUnbalancedBits);
+        result = -1;
+    }
+
+    // a saved projection gives the same codes once loaded
+    const char * projectionFile = "SolARTest_ModulePopSift_BinaryCodes_projection.txt";
+    BinarySiftEmbedding loadedEmbedding;
+    if (!trainedEmbedding.save(projectionFile) || !loadedEmbedding.load(projectionFile) ||
+        encode(loadedEmbedding, set.database) != trainedCodes) {
+        LOG_ERROR("The saved projection does not give the same codes");
+        result = -1;
+    }
+    std::remove(projectionFile);
+    if (loadedEmbedding.load("missing_projection.txt") || !loadedEmbedding.isValid()) {
+        LOG_ERROR("Loading a missing projection file must fail and keep the previous projection");
+        result = -1;
+    }
+
+    // recall of the Hamming matching, alone and re-ranked, against the float matching
+    BinarySiftMatcher matcher;
+    std::vector<DescriptorMatch> hammingMatches, rerankedMatches, floatMatches;
+    uint32_t nbQueries = uint32_t(set.truth.size()), nbDatabase = uint32_t(set.database.size() / descriptorLength);
+    matcher.match(queryCodes.data(), nbQueries, databaseCodes.data(), nbDatabase, nullptr, nullptr, kernels::DescriptorType::Float, hammingMatches);
+    BinaryMatcherConfig rerankConfig;
+    rerankConfig.nbCandidates = 16;
+    matcher.setConfig(rerankConfig);
+    matcher.match(queryCodes.data(), nbQueries, databaseCodes.data(), nbDatabase,
+                  set.queries.data(), set.database.data(), kernels::DescriptorType::Float, rerankedMatches);
+    uint64_t nbFloatEvaluations = matcher.getNbFloatEvaluations();
+    std::vector<float> floatDistances;
+    bruteForceMatch(set.queries, set.database, rerankConfig.ratio, floatMatches, floatDistances);
+    float hammingRecall = recallOf(hammingMatches, set.truth);
+    float rerankedRecall = recallOf(rerankedMatches, set.truth);
+    float floatRecall = recallOf(floatMatches, set.truth);
+    LOG_INFO("Recall: Hamming {}, re-ranked {} ({} float distances), float {}", hammingRecall, rerankedRecall, nbFloatEvaluations, floatRecall);
+    if (rerankedRecall < hammingRecall || rerankedRecall < 0.95f * floatRecall || nbFloatEvaluations != uint64_t(nbQueries) * rerankConfig.nbCandidates) {
+        LOG_ERROR("Re-ranking does not recover the recall of the float matching");
+        result = -1;
+    }
+
+    // re-ranking all the codes is the exhaustive float matching
+    BinaryMatcherConfig exhaustiveConfig;
+    exhaustiveConfig.nbCandidates = nbDatabase;
+    matcher.setConfig(exhaustiveConfig);
+    matcher.match(queryCodes.data(), nbQueries, databaseCodes.data(), nbDatabase,
+                  set.queries.data(), set.database.data(), kernels::DescriptorType::Float, rerankedMatches);
+    bool sameMatches = rerankedMatches.size() == floatMatches.size();
+    for (std::size_t i = 0; sameMatches && i < rerankedMatches.size(); ++i)
+        sameMatches = rerankedMatches[i].getIndexInDescriptorA() == floatMatches[i].getIndexInDescriptorA() &&
+                      rerankedMatches[i].getIndexInDescriptorB() == floatMatches[i].getIndexInDescriptorB();
+    if (!sameMatches) {
+        LOG_ERROR("Re-ranking all the codes differs from the float matching: {} matches instead of {}", rerankedMatches.size(), floatMatches.size());
+        result = -1;
+    }
+
+    // the Hamming limit
+    BinaryMatcherConfig limitConfig;
+    limitConfig.ratio = 1.0f;
+    limitConfig.maxHammingDistance = 20;
+    matcher.setConfig(limitConfig);
+    matcher.match(queryCodes.data(), nbQueries, databaseCodes.data(), nbDatabase, nullptr, nullptr, kernels::DescriptorType::Float, hammingMatches);
+    for (const auto & match : hammingMatches)
+        if (match.getMatchingScore() > limitConfig.maxHammingDistance) {
+            LOG_ERROR("Match at Hamming distance {} over the limit {}", match.getMatchingScore(), limitConfig.maxHammingDistance);
+            result = -1;
+            break;
+        }
+
+    // descriptor buffers: codes computed from byte descriptors, invalid inputs
+    SRef<DescriptorBuffer> databaseBuffer = toBuffer(set.database);
+    SRef<DescriptorBuffer> byteBuffer = xpcf::utils::make_shared<DescriptorBuffer>(DescriptorType::SIFT, DescriptorDataType::TYPE_8U, descriptorLength, 2);
+    unsigned char * bytes = static_cast<unsigned char *>(byteBuffer->data());
+    for (uint32_t j = 0; j < 2 * descriptorLength; ++j)
+        bytes[j] = static_cast<unsigned char>(std::min(255.0f, set.database[j] * 255.0f));
+    SRef<DescriptorBuffer> codeBuffer, byteCodes;
+    if (embedding.encode(databaseBuffer, codeBuffer) != FrameworkReturnCode::_SUCCESS ||
+        codeBuffer->getNbDescriptors() != nbDatabase || codeBuffer->getDescriptorLength() != BinarySiftEmbedding::codeSize ||
+        embedding.encode(byteBuffer, byteCodes) != FrameworkReturnCode::_SUCCESS || byteCodes->getNbDescriptors() != 2 ||
+        matcher.match(databaseBuffer, databaseBuffer, hammingMatches) == FrameworkReturnCode::_SUCCESS ||
+        matcher.match(codeBuffer, byteBuffer, codeBuffer, databaseBuffer, hammingMatches) == FrameworkReturnCode::_SUCCESS) {
+        LOG_ERROR("Wrong handling of the descriptor buffers");
+        result = -1;
+    }
+
+    // codes of the extractor, matched by the component
+    try {
+        SRef<xpcf::IComponentManager> xpcfComponentManager = xpcf::getComponentManagerInstance();
+        if (xpcfComponentManager->load("SolARTest_ModulePopSift_BinaryCodes_conf.xml") != org::bcom::xpcf::_SUCCESS) {
+            LOG_ERROR("Failed to load the configuration file SolARTest_ModulePopSift_BinaryCodes_conf.xml")
+            return -1;
+        }
+        SRef<IPopSiftBinaryCodes> extractor = xpcfComponentManager->resolve<IPopSiftBinaryCodes>();
+        SRef<IPopSiftBinaryMatcher> binaryMatcher = xpcfComponentManager->resolve<IPopSiftBinaryMatcher>();
+
+        SRef<DescriptorBuffer> queryCodeBuffer, databaseCodeBuffer;
+        if (extractor->encode(toBuffer(set.queries), queryCodeBuffer) != FrameworkReturnCode::_SUCCESS ||
+            extractor->encode(databaseBuffer, databaseCodeBuffer) != FrameworkReturnCode::_SUCCESS ||
+            binaryMatcher->matchCodes(queryCodeBuffer, toBuffer(set.queries), databaseCodeBuffer, databaseBuffer, rerankedMatches) != FrameworkReturnCode::_SUCCESS ||
+            recallOf(rerankedMatches, set.truth) < 0.95f * floatRecall) {
+            LOG_ERROR("Wrong matches of the binary matcher component");
+            result = -1;
+        }
+
+        SRef<Image> image = createBlobImage(width, height);
+        std::vector<Keypoint> keypoints;
+        SRef<DescriptorBuffer> descriptors, imageCodes;
+        if (extractor->extractWithCodes(image, keypoints, descriptors, imageCodes) != FrameworkReturnCode::_SUCCESS) {
+            LOG_ERROR("Extraction with binary codes failed");
+            return -1;
+        }
+        // an image matched with itself: the accepted matches are the identity
+        binaryMatcher->matchCodes(imageCodes, descriptors, imageCodes, descriptors, rerankedMatches);
+        uint32_t nbIdentity = 0;
+        for (const auto & match : rerankedMatches)
+            nbIdentity += match.getIndexInDescriptorA() == match.getIndexInDescriptorB();
+        LOG_INFO("{} keypoints, {} matches of the image with itself, {} identical", keypoints.size(), rerankedMatches.size(), nbIdentity);
+        if (keypoints.empty() || imageCodes->getNbDescriptors() != descriptors->getNbDescriptors() ||
+            rerankedMatches.empty() || nbIdentity != rerankedMatches.size()) {
+            LOG_ERROR("Wrong binary codes of the extracted descriptors");
+            result = -1;
+        }
+    }
+    catch (xpcf::Exception e)
+    {
+        LOG_ERROR ("The following exception has been catch : {}", e.what());
+        return -1;
+    }
+
+    if (result == 0)
+        LOG_INFO("Binary codes test succeeded");
+    return result;
+}
@@ -0,0 +1,270 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "xpcf/xpcf.h"
+
+#include "IPopSiftBoWVocabulary.h"
+#include "SolARPopSiftKernels.h"
+#include "SolARTest_ModulePopSift_SyntheticDescriptors.h"
+#include "core/Log.h"
+
+#include <boost/log/core.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace SolAR;
+using namespace SolAR::datastructure;
+using namespace SolAR::MODULES::POPSIFT;
+using namespace SolAR::MODULES::POPSIFT::TEST;
+
+namespace xpcf  = org::bcom::xpcf;
+
+namespace {
+
+const char * textVocabularyFile = "SolARTest_ModulePopSift_BoWVocabulary.txt";
+const char * binaryVocabularyFile = "SolARTest_ModulePopSift_BoWVocabulary.psvoc";
+const uint32_t branching = 4;
+const uint32_t nbWords = branching * branching;
+
+// Two levels vocabulary: the centroids of the first level, then those of the leaves, leaf (a, b) being child b of
+// node a. Its word is a * branching + b once the nodes are renumbered breadth first.
+struct Vocabulary {
+    std::vector<float> nodes, leaves;
+    std::vector<float> weights;     // idf of each word
+};
+
+Vocabulary createVocabulary(unsigned int seed)
+{
+    Vocabulary vocabulary;
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> uniform(0.0f, 255.0f);
+    std::normal_distribution<float> spread(0.0f, 30.0f);
+    vocabulary.nodes.resize(branching * descriptorLength);
+    for (float & value : vocabulary.nodes)
+        value = std::round(uniform(random));
+    for (uint32_t leaf = 0; leaf < nbWords; ++leaf) {
+        for (uint32_t j = 0; j < descriptorLength; ++j)
+            vocabulary.leaves.push_back(std::round(vocabulary.nodes[(leaf / branching) * descriptorLength + j] + spread(random)));
+        vocabulary.weights.push_back(0.5f + 0.1f * float(leaf));
+    }
+    return vocabulary;
+}
+
+// DBoW2 text format, written depth first so that the import has to renumber the nodes
+bool writeTextVocabulary(const Vocabulary & vocabulary, const std::string & path)
+{
+    std::ofstream file(path);
+    file << branching << " 2 0 0\n";
+    uint32_t nodeId = 1;
+    for (uint32_t a = 0; a < branching; ++a) {
+        uint32_t parent = nodeId++;
+        file << "0 0";
+        for (uint32_t j = 0; j < descriptorLength; ++j)
+            file << " " << vocabulary.nodes[a * descriptorLength + j];
+        file << " 0\n";
+        for (uint32_t b = 0; b < branching; ++b, ++nodeId) {
+            uint32_t leaf = a * branching + b;
+            file << parent << " 1";
+            for (uint32_t j = 0; j < descriptorLength; ++j)
+                file << " " << vocabulary.leaves[leaf * descriptorLength + j];
+            file << " " << vocabulary.weights[leaf] << "\n";
+        }
+    }
+    return bool(file);
+}
+
+// Word of a descriptor by a brute force descent of the tree
+uint32_t descend(const Vocabulary & vocabulary, const float * descriptor)
+{
+    std::vector<float> distances(branching);
+    kernels::l2sqrRows(descriptor, vocabulary.nodes.data(), branching, descriptorLength, distances.data());
+    uint32_t a = uint32_t(std::min_element(distances.begin(), distances.end()) - distances.begin());
+    kernels::l2sqrRows(descriptor, vocabulary.leaves.data() + a * branching * descriptorLength, branching, descriptorLength, distances.data());
+    return a * branching + uint32_t(std::min_element(distances.begin(), distances.end()) - distances.begin());
+}
+
+// Byte valued descriptors, each one near a random leaf
+std::vector<float> createDescriptors(const Vocabulary & vocabulary, uint32_t nbDescriptors, unsigned int seed)
+{
+    std::mt19937 random(seed);
+    std::normal_distribution<float> noise(0.0f, 25.0f);
+    std::vector<float> descriptors;
+    for (uint32_t i = 0; i < nbDescriptors; ++i) {
+        uint32_t leaf = random() % nbWords;
+        for (uint32_t j = 0; j < descriptorLength; ++j)
+            descriptors.push_back(std::round(std::min(255.0f, std::max(0.0f, vocabulary.leaves[leaf * descriptorLength + j] + noise(random)))));
+    }
+    return descriptors;
+}
+
+// TF-IDF vector of words, L1 normalized
+BoWVector expectedBoW(const Vocabulary & vocabulary, const std::vector<uint32_t> & words)
+{
+    std::map<uint32_t, uint32_t> counts;
+    for (uint32_t word : words)
+        counts[word]++;
+    BoWVector bow;
+    float norm = 0.0f;
+    for (const auto & count : counts) {
+        bow.emplace_back(count.first, float(count.second) / float(words.size()) * vocabulary.weights[count.first]);
+        norm += bow.back().second;
+    }
+    for (auto & entry : bow)
+        entry.second /= norm;
+    return bow;
+}
+
+bool sameBoW(const BoWVector & bow, const BoWVector & expected)
+{
+    if (bow.size() != expected.size())
+        return false;
+    for (std::size_t i = 0; i < bow.size(); ++i)
+        if (bow[i].first != expected[i].first || std::abs(bow[i].second - expected[i].second) > 1e-5f)
+            return false;
+    return true;
+}
+
+}
+
+int main()
+{
+#if NDEBUG
+    boost::log::core::get()->set_logging_enabled(false);
+#endif
+    LOG_ADD_LOG_TO_CONSOLE();
+
+    int result = 0;
+    Vocabulary vocabulary = createVocabulary(3);
+    if (!writeTextVocabulary(vocabulary, textVocabularyFile)) {
+        LOG_ERROR("Cannot write the vocabulary {}", textVocabularyFile);
+        return -1;
+    }
+    std::vector<float> descriptors = createDescriptors(vocabulary, 1000, 5);
+    std::vector<uint8_t> byteDescriptors(descriptors.begin(), descriptors.end());
+    SRef<DescriptorBuffer> byteBuffer = xpcf::utils::make_shared<DescriptorBuffer>(byteDescriptors.data(), DescriptorType::SIFT, DescriptorDataType::TYPE_8U,
+                                                                                   descriptorLength, uint32_t(byteDescriptors.size() / descriptorLength));
+    std::vector<uint32_t> expectedWords;
+    for (std::size_t i = 0; i < descriptors.size() / descriptorLength; ++i)
+        expectedWords.push_back(descend(vocabulary, descriptors.data() + i * descriptorLength));
+
+    try {
+        SRef<xpcf::IComponentManager> xpcfComponentManager = xpcf::getComponentManagerInstance();
+        if (xpcfComponentManager->load("SolARTest_ModulePopSift_BoWVocabulary_conf.xml") != org::bcom::xpcf::_SUCCESS) {
+            LOG_ERROR("Failed to load the configuration file SolARTest_ModulePopSift_BoWVocabulary_conf.xml")
+            return -1;
+        }
+
+        // DBoW2 text import: quantization against the brute force descent, in blocks spread over the workers
+        SRef<IPopSiftBoWVocabulary> textVocabulary = xpcfComponentManager->resolve<IPopSiftBoWVocabulary>("text");
+        BoWVector bow, byteBow;
+        std::vector<uint32_t> words, byteWords;
+        if (textVocabulary->getNbWords() != nbWords ||
+            textVocabulary->transform(toBuffer(descriptors), bow, words) != FrameworkReturnCode::_SUCCESS ||
+            textVocabulary->transform(byteBuffer, byteBow, byteWords) != FrameworkReturnCode::_SUCCESS) {
+            LOG_ERROR("Quantization on the imported vocabulary failed");
+            return -1;
+        }
+        uint32_t nbWrongWords = 0;
+        for (std::size_t i = 0; i < expectedWords.size(); ++i)
+            nbWrongWords += words[i] != expectedWords[i];
+        LOG_INFO("{} words, {} descriptors quantized, {} differ from the brute force descent", textVocabulary->getNbWords(), words.size(), nbWrongWords);
+        if (nbWrongWords > 0 || byteWords != words) {
+            LOG_ERROR("Wrong words of the imported vocabulary");
+            result = -1;
+        }
+
+        // TF-IDF weights, L1 normalized
+        if (!sameBoW(bow, expectedBoW(vocabulary, expectedWords)) || !sameBoW(byteBow, bow) || std::abs(textVocabulary->score(bow, bow) - 1.0f) > 1e-5f) {
+            LOG_ERROR("Wrong TF-IDF vector");
+            result = -1;
+        }
+
+        // binary vocabulary saved then memory mapped
+        if (textVocabulary->saveVocabulary(binaryVocabularyFile) != FrameworkReturnCode::_SUCCESS) {
+            LOG_ERROR("Cannot save the vocabulary {}", binaryVocabularyFile);
+            return -1;
+        }
+        SRef<IPopSiftBoWVocabulary> binaryVocabulary = xpcfComponentManager->resolve<IPopSiftBoWVocabulary>("binary");
+        BoWVector binaryBow;
+        std::vector<uint32_t> binaryWords;
+        if (binaryVocabulary->getNbWords() != nbWords ||
+            binaryVocabulary->transform(toBuffer(descriptors), binaryBow, binaryWords) != FrameworkReturnCode::_SUCCESS ||
+            binaryWords != words || !sameBoW(binaryBow, bow)) {
+            LOG_ERROR("The saved vocabulary does not quantize like the imported one");
+            result = -1;
+        }
+
+        // inverted file against a linear scan of the scores
+        const uint32_t nbImages = 40;
+        std::vector<BoWVector> images(nbImages);
+        for (uint32_t image = 0; image < nbImages; ++image) {
+            std::vector<float> imageDescriptors = createDescriptors(vocabulary, 5 + image % 7, 100 + image);
+            binaryVocabulary->transform(toBuffer(imageDescriptors), images[image], words);
+            if (binaryVocabulary->addToIndex(image, images[image]) != FrameworkReturnCode::_SUCCESS)
+                result = -1;
+        }
+        if (binaryVocabulary->addToIndex(0, images[0]) == FrameworkReturnCode::_SUCCESS ||
+            binaryVocabulary->removeFromIndex(7) != FrameworkReturnCode::_SUCCESS ||
+            binaryVocabulary->removeFromIndex(7) == FrameworkReturnCode::_SUCCESS) {
+            LOG_ERROR("Wrong handling of the image ids of the index");
+            result = -1;
+        }
+        uint32_t nbWrongQueries = 0;
+        for (uint32_t image = 0; image < nbImages; image += 3) {
+            std::map<uint32_t, float> expected;
+            for (uint32_t other = 0; other < nbImages; ++other) {
+                float score = binaryVocabulary->score(images[image], images[other]);
+                if (other != 7 && score > 0.0f)
+                    expected[other] = score;
+            }
+            std::vector<std::pair<uint32_t, float>> results, topResults;
+            binaryVocabulary->query(images[image], results);
+            binaryVocabulary->query(images[image], topResults, 5);
+            // the inverted file sums the scores in another order: compare them with a tolerance
+            bool same = results.size() == expected.size() && topResults.size() == std::min<std::size_t>(5, results.size());
+            for (std::size_t i = 0; same && i < results.size(); ++i)
+                same = expected.count(results[i].first) && std::abs(results[i].second - expected[results[i].first]) <= 1e-5f &&
+                       (i == 0 || results[i - 1].second >= results[i].second);
+            for (std::size_t i = 0; same && i < topResults.size(); ++i)
+                same = topResults[i] == results[i];
+            nbWrongQueries += !same;
+        }
+        binaryVocabulary->clearIndex();
+        std::vector<std::pair<uint32_t, float>> results;
+        binaryVocabulary->query(images[0], results);
+        LOG_INFO("{} queries of the inverted file differ from the linear scan", nbWrongQueries);
+        if (nbWrongQueries > 0 || !results.empty()) {
+            LOG_ERROR("Wrong inverted file queries");
+            result = -1;
+        }
+    }
+    catch (xpcf::Exception e)
+    {
+        LOG_ERROR ("The following exception has been catch : {}", e.what());
+        return -1;
+    }
+    std::remove(textVocabularyFile);
+    std::remove(binaryVocabularyFile);
+
+    if (result == 0)
+        LOG_INFO("BoW vocabulary test succeeded");
+    return result;
+}
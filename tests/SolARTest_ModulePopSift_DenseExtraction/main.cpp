@@ -0,0 +1,122 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "xpcf/xpcf.h"
+
+#include "api/features/IDescriptorsExtractorFromImage.h"
+#include "SolARTest_ModulePopSift_SyntheticImages.h"
+#include "core/Log.h"
+
+#include <boost/log/core.hpp>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace SolAR;
+using namespace SolAR::datastructure;
+using namespace SolAR::api;
+using namespace SolAR::MODULES::POPSIFT::TEST;
+
+namespace xpcf  = org::bcom::xpcf;
+
+static float distance(const float * a, const float * b)
+{
+    float sum = 0.0f;
+    for (int i = 0; i < 128; ++i)
+        sum += (a[i] - b[i]) * (a[i] - b[i]);
+    return std::sqrt(sum);
+}
+
+int main()
+{
+#if NDEBUG
+    boost::log::core::get()->set_logging_enabled(false);
+#endif
+    try {
+        LOG_ADD_LOG_TO_CONSOLE();
+
+        SRef<xpcf::IComponentManager> xpcfComponentManager = xpcf::getComponentManagerInstance();
+
+        if(xpcfComponentManager->load("SolARTest_ModulePopSift_DenseExtraction_conf.xml")!=org::bcom::xpcf::_SUCCESS)
+        {
+            LOG_ERROR("Failed to load the configuration file SolARTest_ModulePopSift_DenseExtraction_conf.xml")
+            return -1;
+        }
+
+        SRef<features::IDescriptorsExtractorFromImage> extractor = xpcfComponentManager->resolve<features::IDescriptorsExtractorFromImage>();
+        if (!extractor)
+        {
+            LOG_ERROR("One or more component creations have failed");
+            return -1;
+        }
+        const int stride = 8;
+
+        std::vector<Keypoint> keypoints1, keypoints2;
+        SRef<DescriptorBuffer> descriptors1, descriptors2;
+        if (extractor->extract(createTexturedImage(320, 240, 0), keypoints1, descriptors1) != FrameworkReturnCode::_SUCCESS ||
+            extractor->extract(createTexturedImage(320, 240, stride), keypoints2, descriptors2) != FrameworkReturnCode::_SUCCESS)
+        {
+            LOG_ERROR("Dense extraction failed");
+            return -1;
+        }
+
+        // one descriptor per grid keypoint
+        if (keypoints1.empty() || descriptors1->getNbDescriptors() != keypoints1.size() ||
+            descriptors1->getDescriptorLength() != 128 || descriptors1->getDescriptorDataType() != DescriptorDataType::TYPE_32F)
+        {
+            LOG_ERROR("{} keypoints and {} descriptors were extracted", keypoints1.size(), descriptors1->getNbDescriptors());
+            return -1;
+        }
+        LOG_INFO("{} dense keypoints extracted", keypoints1.size());
+
+        // the second image is the first one shifted by one grid step: the descriptor at (x, y) in the second image
+        // must be close to the descriptor at (x + stride, y) in the first image
+        std::map<std::tuple<float, float, float>, int> grid1;
+        for (int i = 0; i < int(keypoints1.size()); ++i)
+            grid1[std::make_tuple(keypoints1[i].getX(), keypoints1[i].getY(), keypoints1[i].getSize())] = i;
+        const float * data1 = static_cast<const float *>(descriptors1->data());
+        const float * data2 = static_cast<const float *>(descriptors2->data());
+        float sameDistance = 0.0f, otherDistance = 0.0f;
+        int nbPairs = 0;
+        for (int i = 0; i < int(keypoints2.size()); ++i)
+        {
+            auto it = grid1.find(std::make_tuple(keypoints2[i].getX() + stride, keypoints2[i].getY(), keypoints2[i].getSize()));
+            if (it == grid1.end())
+                continue;
+            int other = (it->second + int(keypoints1.size()) / 2) % int(keypoints1.size());
+            sameDistance += distance(data2 + i * 128, data1 + it->second * 128);
+            otherDistance += distance(data2 + i * 128, data1 + other * 128);
+            ++nbPairs;
+        }
+        if (nbPairs == 0 || sameDistance > 0.25f * otherDistance)
+        {
+            LOG_ERROR("Dense descriptors are not shift consistent: {} pairs, mean distance {} against {} for unrelated keypoints",
+                      nbPairs, sameDistance / std::max(nbPairs, 1), otherDistance / std::max(nbPairs, 1));
+            return -1;
+        }
+        LOG_INFO("Dense descriptors are shift consistent: {} pairs, mean distance {} against {} for unrelated keypoints",
+                 nbPairs, sameDistance / nbPairs, otherDistance / nbPairs);
+    }
+    catch (xpcf::Exception e)
+    {
+        LOG_ERROR ("The following exception has been catch : {}", e.what());
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,151 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "xpcf/xpcf.h"
+
+#include "SolARPopSiftDenseSift.h"
+#include "SolARPopSiftDescriptorKernels.h"
+#include "SolARTest_ModulePopSift_SyntheticImages.h"
+#include "core/Log.h"
+
+#include <boost/log/core.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace SolAR;
+using namespace SolAR::datastructure;
+using namespace SolAR::MODULES::POPSIFT;
+using namespace SolAR::MODULES::POPSIFT::TEST;
+
+namespace xpcf  = org::bcom::xpcf;
+
+// The specialized kernels of a configuration give the results of the generic ones
+static bool checkKernels(const kernels::DescriptorKernels & specialized)
+{
+    const std::size_t nbPixels = 1001;
+    const std::size_t nbDescriptors = 64;
+    const std::size_t length = DenseSift::descriptorLength;
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+
+    std::vector<uint8_t> bytePixels(nbPixels);
+    std::vector<float> floatPixels(nbPixels);
+    for (std::size_t i = 0; i < nbPixels; ++i) {
+        bytePixels[i] = uint8_t(random() % 256);
+        floatPixels[i] = uniform(random);
+    }
+    const void * pixels = specialized.input == kernels::InputType::Byte ? (const void *)bytePixels.data() : (const void *)floatPixels.data();
+    std::vector<float> plane(nbPixels), genericPlane(nbPixels);
+    specialized.convertPixels(pixels, plane.data(), 7, nbPixels);
+    kernels::convertPixelsGeneric(specialized.input, pixels, genericPlane.data(), 7, nbPixels);
+    if (std::memcmp(plane.data(), genericPlane.data(), nbPixels * sizeof(float)) != 0) {
+        LOG_ERROR("{}: the pixel conversion differs from the generic one", specialized.name);
+        return false;
+    }
+
+    std::vector<unsigned char> descriptors(nbDescriptors * specialized.descriptorSize);
+    std::vector<unsigned char> genericDescriptors(descriptors.size());
+    for (std::size_t i = 0; i < nbDescriptors; ++i) {
+        std::vector<float> histogram(length);
+        for (auto & bin : histogram)
+            bin = uniform(random) * uniform(random) * 10.0f;
+        if (i == 0)
+            std::fill(histogram.begin(), histogram.end(), 0.0f);
+        std::vector<float> genericHistogram = histogram;
+        specialized.finalizeDescriptor(histogram.data(), descriptors.data() + i * specialized.descriptorSize);
+        kernels::finalizeDescriptorGeneric(specialized.norm, specialized.descriptor, genericHistogram.data(),
+                                           genericDescriptors.data() + i * specialized.descriptorSize);
+    }
+    if (descriptors != genericDescriptors) {
+        LOG_ERROR("{}: the descriptor normalization differs from the generic one", specialized.name);
+        return false;
+    }
+
+    // the float distance of the specialized kernel is vectorized: the order of the sums differs
+    for (std::size_t i = 0; i + 1 < nbDescriptors; ++i) {
+        const unsigned char * a = descriptors.data() + i * specialized.descriptorSize;
+        const unsigned char * b = a + specialized.descriptorSize;
+        float distance = specialized.descriptorDistance(a, b);
+        float genericDistance = kernels::descriptorDistanceGeneric(specialized.descriptor, a, b);
+        if (std::fabs(distance - genericDistance) > 1e-4f * std::max(1.0f, genericDistance)) {
+            LOG_ERROR("{}: distance {} instead of {}", specialized.name, distance, genericDistance);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main()
+{
+#if NDEBUG
+    boost::log::core::get()->set_logging_enabled(false);
+#endif
+    LOG_ADD_LOG_TO_CONSOLE();
+
+    int result = 0;
+    for (kernels::NormMode norm : { kernels::NormMode::RootSift, kernels::NormMode::Classic })
+        for (kernels::InputType input : { kernels::InputType::Byte, kernels::InputType::Float })
+            for (kernels::DescriptorType type : { kernels::DescriptorType::Float, kernels::DescriptorType::Byte }) {
+                const kernels::DescriptorKernels & specialized = kernels::selectDescriptorKernels(norm, input, type);
+                if (specialized.norm != norm || specialized.input != input || specialized.descriptor != type) {
+                    LOG_ERROR("{} is selected for another configuration", specialized.name);
+                    result = -1;
+                }
+                else if (!checkKernels(specialized))
+                    result = -1;
+            }
+
+    // unsigned char descriptors of the dense extraction are the saturated float ones
+    SRef<Image> image = createTexturedImage(160, 120);
+    for (kernels::NormMode norm : { kernels::NormMode::RootSift, kernels::NormMode::Classic }) {
+        std::vector<SRef<DescriptorBuffer>> descriptors;
+        for (kernels::DescriptorType type : { kernels::DescriptorType::Float, kernels::DescriptorType::Byte }) {
+            DenseSiftConfig config;
+            config.normMode = norm;
+            config.descriptorType = type;
+            DenseSift denseSift(config);
+            std::vector<Keypoint> keypoints;
+            SRef<DescriptorBuffer> buffer;
+            if (denseSift.extract(image, keypoints, buffer) != FrameworkReturnCode::_SUCCESS || keypoints.empty()) {
+                LOG_ERROR("Dense extraction failed");
+                return -1;
+            }
+            descriptors.push_back(buffer);
+        }
+        if (descriptors[0]->getDescriptorDataType() != DescriptorDataType::TYPE_32F
+            || descriptors[1]->getDescriptorDataType() != DescriptorDataType::TYPE_8U
+            || descriptors[0]->getNbDescriptors() != descriptors[1]->getNbDescriptors()) {
+            LOG_ERROR("Wrong type or number of dense descriptors");
+            return -1;
+        }
+        const float * floats = static_cast<const float *>(descriptors[0]->data());
+        const uint8_t * bytes = static_cast<const uint8_t *>(descriptors[1]->data());
+        std::size_t size = std::size_t(descriptors[0]->getNbDescriptors()) * DenseSift::descriptorLength;
+        for (std::size_t i = 0; i < size; ++i)
+            if (bytes[i] != uint8_t(std::min(255.0f, std::max(0.0f, std::nearbyint(floats[i]))))) {
+                LOG_ERROR("Dense unsigned char descriptor element {} is {} for the float {}", i, int(bytes[i]), floats[i]);
+                result = -1;
+                break;
+            }
+    }
+
+    if (result == 0)
+        LOG_INFO("Descriptor kernels test succeeded");
+    return result;
+}
@@ -0,0 +1,267 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "xpcf/xpcf.h"
+#include "xpcf/component/ComponentBase.h"
+
+#include "api/features/IDescriptorsExtractorFromImage.h"
+#include "SolARPopSiftExtractionChannel.h"
+#include "core/Log.h"
+
+#include <boost/log/core.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace SolAR;
+using namespace SolAR::datastructure;
+using namespace SolAR::api;
+using namespace SolAR::MODULES::POPSIFT;
+
+namespace xpcf  = org::bcom::xpcf;
+
+namespace {
+
+const char * serverName = "/solar_popsift_test";
+const int nbClientThreads = 3;
+const int nbFramesPerClient = 20;
+
+// Keypoints and descriptors derived from the image content, so that every result can be checked
+void expectedFeatures(const SRef<Image> image, std::vector<Keypoint> & keypoints, std::vector<float> & descriptors)
+{
+    const unsigned char * pixels = static_cast<const unsigned char *>(image->data());
+    uint32_t nbPixels = image->getWidth() * image->getHeight();
+    uint32_t nbKeypoints = 10 + pixels[0] % 50;
+    keypoints.resize(nbKeypoints);
+    descriptors.resize(nbKeypoints * 128);
+    for (uint32_t i = 0; i < nbKeypoints; ++i) {
+        keypoints[i].init(i, float(i % image->getWidth()), float(i / image->getWidth()), 0.0f, 0.0f, 0.0f, 1.0f + pixels[i % nbPixels], 0.5f);
+        for (uint32_t j = 0; j < 128; ++j)
+            descriptors[i * 128 + j] = float(pixels[(i + j) % nbPixels]) + float(j);
+    }
+}
+
+SRef<Image> createImage(int seed)
+{
+    SRef<Image> image = xpcf::utils::make_shared<Image>(160, 120, Image::ImageLayout::LAYOUT_GREY, Image::PixelOrder::INTERLEAVED, Image::DataType::TYPE_8U);
+    unsigned char * pixels = static_cast<unsigned char *>(image->data());
+    for (uint32_t i = 0; i < 160 * 120; ++i)
+        pixels[i] = static_cast<unsigned char>((i * 31 + uint32_t(seed) * 17) % 251);
+    return image;
+}
+
+bool checkResult(const SRef<Image> image, const std::vector<Keypoint> & keypoints, const SRef<DescriptorBuffer> descriptors)
+{
+    std::vector<Keypoint> expectedKeypoints;
+    std::vector<float> expectedDescriptors;
+    expectedFeatures(image, expectedKeypoints, expectedDescriptors);
+    if (keypoints.size() != expectedKeypoints.size() || !descriptors || descriptors->getNbDescriptors() != keypoints.size())
+        return false;
+    const float * data = static_cast<const float *>(descriptors->data());
+    for (std::size_t i = 0; i < keypoints.size(); ++i)
+        if (keypoints[i].getX() != expectedKeypoints[i].getX() || keypoints[i].getSize() != expectedKeypoints[i].getSize())
+            return false;
+    return std::equal(expectedDescriptors.begin(), expectedDescriptors.end(), data);
+}
+
+}
+
+// Stand-in for the PopSift extractor served by the daemon
+class MockExtractor : public xpcf::ComponentBase, public features::IDescriptorsExtractorFromImage
+{
+public:
+    MockExtractor() : ComponentBase(xpcf::toUUID<MockExtractor>())
+    {
+        addInterface<features::IDescriptorsExtractorFromImage>(this);
+    }
+
+    std::string getTypeString() override { return std::string("DescriptorsExtractorType::SIFT"); }
+
+    FrameworkReturnCode extract(const SRef<Image> image, std::vector<Keypoint> & keypoints, SRef<DescriptorBuffer> & descriptors) override
+    {
+        std::vector<float> data;
+        expectedFeatures(image, keypoints, data);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        descriptors.reset(new DescriptorBuffer(reinterpret_cast<unsigned char *>(data.data()), DescriptorType::SIFT, DescriptorDataType::TYPE_32F, 128, uint32_t(keypoints.size())));
+        return FrameworkReturnCode::_SUCCESS;
+    }
+};
+
+template <> struct org::bcom::xpcf::ComponentTraits<MockExtractor>
+{
+    static constexpr const char * UUID = "{e1c8257d-d7f0-4e40-bb1c-cd61bcea9e57}";
+    static constexpr const char * NAME = "MockExtractor";
+    static constexpr const char * DESCRIPTION = "MockExtractor implements SolAR::api::features::IDescriptorsExtractorFromImage interface";
+};
+
+static ExtractionServer * runningServer = nullptr;
+
+static void stopServer(int)
+{
+    if (runningServer)
+        runningServer->stop();
+}
+
+// Daemon process: serves the mock extractor until SIGTERM
+static int serve(int readyPipe, int expectedRequests)
+{
+    ExtractionServer server;
+    ExtractionChannelConfig config;
+    config.maxClients = 4;
+    config.maxImageBytes = 160 * 120;
+    config.maxKeypoints = 100;
+    if (server.create(serverName, xpcf::utils::make_shared<MockExtractor>(), config) != FrameworkReturnCode::_SUCCESS)
+        return 1;
+    runningServer = &server;
+    std::signal(SIGTERM, stopServer);
+    char ready = 1;
+    if (write(readyPipe, &ready, 1) != 1)
+        return 1;
+    server.run();
+    ExtractionServerStats stats = server.getStats();
+    LOG_INFO("Server served {} requests in {} batches (max batch {})", stats.nbRequests, stats.nbBatches, stats.maxBatchSize);
+    return stats.nbRequests == uint64_t(expectedRequests) ? 0 : 2;
+}
+
+// Second client process, using the channel directly
+static int clientProcess()
+{
+    ExtractionClient client;
+    if (client.connect(serverName) != FrameworkReturnCode::_SUCCESS)
+        return 1;
+    for (int frame = 0; frame < nbFramesPerClient; ++frame) {
+        SRef<Image> image = createImage(1000 + frame);
+        std::vector<Keypoint> keypoints;
+        SRef<DescriptorBuffer> descriptors;
+        if (client.extract(image, keypoints, descriptors, 5000) != FrameworkReturnCode::_SUCCESS || !checkResult(image, keypoints, descriptors))
+            return 2;
+    }
+    return 0;
+}
+
+int main()
+{
+#if NDEBUG
+    boost::log::core::get()->set_logging_enabled(false);
+#endif
+    LOG_ADD_LOG_TO_CONSOLE();
+
+    int readyPipe[2];
+    if (pipe(readyPipe) != 0)
+        return -1;
+    pid_t serverPid = fork();
+    if (serverPid == 0)
+        _exit(serve(readyPipe[1], (nbClientThreads + 1) * nbFramesPerClient));
+    char ready = 0;
+    if (read(readyPipe[0], &ready, 1) != 1) {
+        LOG_ERROR("Extraction server failed to start");
+        return -1;
+    }
+    pid_t clientPid = fork();
+    if (clientPid == 0)
+        _exit(clientProcess());
+
+    int result = 0;
+    SRef<features::IDescriptorsExtractorFromImage> restartedExtractor;
+    try {
+        SRef<xpcf::IComponentManager> xpcfComponentManager = xpcf::getComponentManagerInstance();
+
+        if(xpcfComponentManager->load("SolARTest_ModulePopSift_ExtractionServer_conf.xml")!=org::bcom::xpcf::_SUCCESS)
+        {
+            LOG_ERROR("Failed to load the configuration file SolARTest_ModulePopSift_ExtractionServer_conf.xml")
+            result = -1;
+        }
+
+        // several components of this process share the server with the second client process
+        std::atomic<int> nbFailures(0);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < nbClientThreads && result == 0; ++t) {
+            SRef<features::IDescriptorsExtractorFromImage> extractor = xpcfComponentManager->resolve<features::IDescriptorsExtractorFromImage>();
+            if (!extractor) {
+                LOG_ERROR("One or more component creations have failed");
+                result = -1;
+                break;
+            }
+            restartedExtractor = extractor;
+            threads.emplace_back([extractor, t, &nbFailures]() {
+                for (int frame = 0; frame < nbFramesPerClient; ++frame) {
+                    SRef<Image> image = createImage(t * 100 + frame);
+                    std::vector<Keypoint> keypoints;
+                    SRef<DescriptorBuffer> descriptors;
+                    if (extractor->extract(image, keypoints, descriptors) != FrameworkReturnCode::_SUCCESS || !checkResult(image, keypoints, descriptors))
+                        nbFailures++;
+                }
+            });
+        }
+        for (auto & thread : threads)
+            thread.join();
+        if (nbFailures > 0) {
+            LOG_ERROR("{} extractions through the server failed or returned wrong results", nbFailures.load());
+            result = -1;
+        }
+    }
+    catch (xpcf::Exception e)
+    {
+        LOG_ERROR ("The following exception has been catch : {}", e.what());
+        result = -1;
+    }
+
+    int clientStatus = 0, serverStatus = 0;
+    waitpid(clientPid, &clientStatus, 0);
+    kill(serverPid, SIGTERM);
+    waitpid(serverPid, &serverStatus, 0);
+    if (!WIFEXITED(clientStatus) || WEXITSTATUS(clientStatus) != 0) {
+        LOG_ERROR("Client process failed with status {}", clientStatus);
+        result = -1;
+    }
+    if (result == 0 && (!WIFEXITED(serverStatus) || WEXITSTATUS(serverStatus) != 0)) {
+        LOG_ERROR("Server process failed with status {}", serverStatus);
+        result = -1;
+    }
+
+    // daemon restart: the component fails while the server is stopped, then connects to the new segment
+    if (result == 0) {
+        SRef<Image> image = createImage(2000);
+        std::vector<Keypoint> keypoints;
+        SRef<DescriptorBuffer> descriptors;
+        bool failedWhileStopped = restartedExtractor->extract(image, keypoints, descriptors) != FrameworkReturnCode::_SUCCESS;
+        serverPid = fork();
+        if (serverPid == 0)
+            _exit(serve(readyPipe[1], 1));
+        if (read(readyPipe[0], &ready, 1) != 1) {
+            LOG_ERROR("Extraction server failed to restart");
+            return -1;
+        }
+        bool servedAfterRestart = restartedExtractor->extract(image, keypoints, descriptors) == FrameworkReturnCode::_SUCCESS &&
+                                  checkResult(image, keypoints, descriptors);
+        kill(serverPid, SIGTERM);
+        waitpid(serverPid, &serverStatus, 0);
+        if (!failedWhileStopped || !servedAfterRestart || !WIFEXITED(serverStatus) || WEXITSTATUS(serverStatus) != 0) {
+            LOG_ERROR("The client did not connect to the restarted server");
+            result = -1;
+        }
+    }
+
+    if (result == 0)
+        LOG_INFO("Extraction server test succeeded");
+    return result;
+}
@@ -0,0 +1,589 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "xpcf/xpcf.h"
+
+#include "api/features/IDescriptorsExtractorFromImage.h"
+#include "api/features/IImageMatcher.h"
+#include "SolARPopSiftBinarySift.h"
+#include "SolARPopSiftDenseSift.h"
+#include "SolARPopSiftDescriptorKernels.h"
+#include "SolARPopSiftKernels.h"
+#include "SolARPopSiftStereoMatcher.h"
+#include "SolARTest_ModulePopSift_SyntheticDescriptors.h"
+#include "core/Log.h"
+
+#include <boost/log/core.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+using namespace SolAR;
+using namespace SolAR::datastructure;
+using namespace SolAR::api;
+using namespace SolAR::MODULES::POPSIFT::TEST;
+
+namespace xpcf  = org::bcom::xpcf;
+
+// Allocation counters. The replacement operators are used by the module libraries too on Linux; on Windows
+// each DLL keeps its own allocator, so only the allocations of the test itself are counted.
+static std::atomic<uint64_t> nbAllocations(0);
+static std::atomic<uint64_t> nbDeallocations(0);
+
+void * operator new(std::size_t size)
+{
+    nbAllocations++;
+    void * p = std::malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void * p) noexcept
+{
+    if (p) {
+        nbDeallocations++;
+        std::free(p);
+    }
+}
+
+void * operator new[](std::size_t size) { return operator new(size); }
+void operator delete[](void * p) noexcept { operator delete(p); }
+void operator delete(void * p, std::size_t) noexcept { operator delete(p); }
+void operator delete[](void * p, std::size_t) noexcept { operator delete(p); }
+
+namespace {
+
+const char * confFile = "SolARTest_ModulePopSift_Performance_conf.xml";
+const char * defaultBaselineFile = "SolARTest_ModulePopSift_Performance_baseline.txt";
+const uint32_t imageWidth = 640;
+const uint32_t imageHeight = 480;
+const int nbImages = 4;
+
+// Resident set size of the process, in MB
+double currentRssMB()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return double(counters.WorkingSetSize) / (1024.0 * 1024.0);
+#else
+    long pages = 0, residentPages = 0;
+    std::ifstream statm("/proc/self/statm");
+    if (!(statm >> pages >> residentPages))
+        return 0.0;
+    return double(residentPages) * double(sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0);
+#endif
+}
+
+double peakRssMB()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return double(counters.PeakWorkingSetSize) / (1024.0 * 1024.0);
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return double(usage.ru_maxrss) / (1024.0 * 1024.0);
+#else
+    return double(usage.ru_maxrss) / 1024.0;
+#endif
+#endif
+}
+
+// Deterministic textured grey image with blob-like structures, shifted horizontally by offsetX pixels
+SRef<Image> createImage(int seed, int offsetX)
+{
+    SRef<Image> image = xpcf::utils::make_shared<Image>(imageWidth, imageHeight, Image::ImageLayout::LAYOUT_GREY, Image::PixelOrder::INTERLEAVED, Image::DataType::TYPE_8U);
+    unsigned char * pixels = static_cast<unsigned char *>(image->data());
+    float phase = 0.7f * float(seed);
+    for (uint32_t y = 0; y < imageHeight; ++y)
+        for (uint32_t x = 0; x < imageWidth; ++x) {
+            float u = float(int(x) + offsetX);
+            float v = float(y);
+            float value = 128.0f + 50.0f * std::sin(u * 0.13f + phase) * std::cos(v * 0.11f - phase)
+                                 + 40.0f * std::sin((u + 2.0f * v) * 0.031f + 2.0f * phase)
+                                 + 30.0f * std::cos(std::sqrt(u * u + v * v) * 0.07f + phase);
+            pixels[y * imageWidth + x] = static_cast<unsigned char>(std::min(255.0f, std::max(0.0f, value)));
+        }
+    return image;
+}
+
+struct Metric {
+    std::string name;
+    double value;
+    bool higherIsBetter;
+};
+
+struct BaselineEntry {
+    double value = 0.0;
+    double tolerance = 0.0;
+    bool relative = true;       // tolerance in percent of the baseline value, else absolute
+};
+
+// Measures a workload: frames are run nbWarmup times unmeasured, then nbFrames times
+std::vector<Metric> runWorkload(const std::string & name, int nbWarmup, int nbFrames, const std::function<bool(int)> & frame)
+{
+    for (int i = 0; i < nbWarmup; ++i)
+        if (!frame(i))
+            return {};
+
+    std::vector<double> latencies(nbFrames);
+    double rssBefore = currentRssMB();
+    uint64_t allocationsBefore = nbAllocations;
+    int64_t liveBefore = int64_t(nbAllocations - nbDeallocations);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < nbFrames; ++i) {
+        auto frameStart = std::chrono::steady_clock::now();
+        if (!frame(nbWarmup + i))
+            return {};
+        latencies[i] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    int64_t liveAfter = int64_t(nbAllocations - nbDeallocations);
+    uint64_t allocations = nbAllocations - allocationsBefore;
+    double rssAfter = currentRssMB();
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+        std::size_t index = std::size_t(std::ceil(p * double(latencies.size())));
+        return latencies[std::min(latencies.size() - 1, index > 0 ? index - 1 : 0)];
+    };
+    return {
+        { name + ".latency_p50_ms", percentile(0.50), false },
+        { name + ".latency_p90_ms", percentile(0.90), false },
+        { name + ".latency_p99_ms", percentile(0.99), false },
+        { name + ".latency_max_ms", latencies.back(), false },
+        { name + ".throughput_fps", double(nbFrames) / seconds, true },
+        { name + ".allocations_per_frame", double(allocations) / double(nbFrames), false },
+        { name + ".leaked_allocations_per_frame", double(liveAfter - liveBefore) / double(nbFrames), false },
+        { name + ".rss_growth_mb", rssAfter - rssBefore, false }
+    };
+}
+
+bool loadBaseline(const std::string & path, std::map<std::string, BaselineEntry> & baseline)
+{
+    std::ifstream file(path);
+    if (!file)
+        return false;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream fields(line);
+        std::string name, tolerance;
+        BaselineEntry entry;
+        if (!(fields >> name >> entry.value >> tolerance))
+            continue;
+        entry.relative = tolerance.back() == '%';
+        entry.tolerance = std::atof(tolerance.c_str());
+        baseline[name] = entry;
+    }
+    return !baseline.empty();
+}
+
+// Default tolerance of a metric added to the baseline by --update-baseline
+BaselineEntry defaultTolerance(const Metric & metric)
+{
+    BaselineEntry entry;
+    entry.value = metric.value;
+    if (metric.name.find("leaked_allocations") != std::string::npos) {
+        entry.relative = false;
+        entry.tolerance = 0.0;
+    }
+    else if (metric.name.find("rss_growth") != std::string::npos) {
+        entry.relative = false;
+        entry.tolerance = 16.0;
+    }
+    else if (metric.name.find("latency_max") != std::string::npos || metric.name.find("latency_p99") != std::string::npos)
+        entry.tolerance = 50.0;
+    else if (metric.name.find("allocations") != std::string::npos)
+        entry.tolerance = 10.0;
+    else
+        entry.tolerance = 25.0;
+    return entry;
+}
+
+bool saveBaseline(const std::string & path, const std::vector<Metric> & metrics, const std::map<std::string, BaselineEntry> & previous)
+{
+    std::ofstream file(path);
+    if (!file)
+        return false;
+    file << "# SolARModulePopSift performance baseline: <metric> <value> <tolerance, in % of the value or absolute>\n"
+         << "# Metrics without an entry are reported but not checked. Regenerate with --update-baseline on the reference machine.\n";
+    for (const auto & metric : metrics) {
+        BaselineEntry entry = defaultTolerance(metric);
+        auto it = previous.find(metric.name);
+        if (it != previous.end()) {
+            entry.relative = it->second.relative;
+            entry.tolerance = it->second.tolerance;
+        }
+        file << metric.name << " " << metric.value << " " << entry.tolerance << (entry.relative ? "%" : "") << "\n";
+    }
+    return true;
+}
+
+// Reports every metric against the baseline, returns the number of regressions
+int compare(const std::vector<Metric> & metrics, const std::map<std::string, BaselineEntry> & baseline)
+{
+    int nbRegressions = 0;
+    for (const auto & metric : metrics) {
+        std::cout << std::left << std::setw(52) << metric.name << std::right << std::setw(12) << std::fixed << std::setprecision(3) << metric.value;
+        auto it = baseline.find(metric.name);
+        if (it == baseline.end()) {
+            std::cout << "   (no baseline)" << std::endl;
+            continue;
+        }
+        const BaselineEntry & entry = it->second;
+        double tolerance = entry.relative ? std::fabs(entry.value) * entry.tolerance / 100.0 : entry.tolerance;
+        bool regression = metric.higherIsBetter ? metric.value < entry.value - tolerance : metric.value > entry.value + tolerance;
+        std::cout << "   baseline " << std::setw(12) << entry.value << (regression ? "   REGRESSION" : "   ok") << std::endl;
+        if (regression)
+            ++nbRegressions;
+    }
+    return nbRegressions;
+}
+
+}
+
+int main(int argc, char * argv[])
+{
+#if NDEBUG
+    boost::log::core::get()->set_logging_enabled(false);
+#endif
+    std::string baselineFile = defaultBaselineFile;
+    bool updateBaseline = false;
+    int nbFrames = 100;
+    int nbWarmup = 10;
+    uint32_t maxThreads = 64;
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--update-baseline"))
+            updateBaseline = true;
+        else if (!std::strcmp(argv[i], "--baseline") && i + 1 < argc)
+            baselineFile = argv[++i];
+        else if (!std::strcmp(argv[i], "--frames") && i + 1 < argc)
+            nbFrames = std::max(1, std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--max-threads") && i + 1 < argc)
+            maxThreads = uint32_t(std::max(1, std::atoi(argv[++i])));
+        else {
+            std::cout << "SolARTest_ModulePopSift_Performance [--baseline file] [--frames n] [--max-threads n] [--update-baseline]" << std::endl;
+            return -1;
+        }
+    }
+
+    try {
+        LOG_ADD_LOG_TO_CONSOLE();
+
+        // the metrics are only left unchecked when the baseline is being recorded
+        std::map<std::string, BaselineEntry> baseline;
+        if (!loadBaseline(baselineFile, baseline)) {
+            if (!updateBaseline) {
+                LOG_ERROR("Cannot read the baseline file {}, record it with --update-baseline", baselineFile);
+                return -1;
+            }
+            LOG_WARNING("No baseline file {}, it is created", baselineFile);
+        }
+
+        SRef<xpcf::IComponentManager> xpcfComponentManager = xpcf::getComponentManagerInstance();
+
+        if(xpcfComponentManager->load(confFile)!=org::bcom::xpcf::_SUCCESS)
+        {
+            LOG_ERROR("Failed to load the configuration file {}", confFile)
+            return -1;
+        }
+
+        SRef<features::IDescriptorsExtractorFromImage> extractor = xpcfComponentManager->resolve<features::IDescriptorsExtractorFromImage>("detector");
+        SRef<features::IDescriptorsExtractorFromImage> denseExtractor = xpcfComponentManager->resolve<features::IDescriptorsExtractorFromImage>("dense");
+        SRef<features::IImageMatcher> imageMatcher = xpcfComponentManager->resolve<features::IImageMatcher>();
+        if (!extractor || !denseExtractor || !imageMatcher)
+        {
+            LOG_ERROR("One or more component creations have failed");
+            return -1;
+        }
+
+        std::vector<SRef<Image>> images, shiftedImages;
+        for (int i = 0; i < nbImages; ++i) {
+            images.push_back(createImage(i, 0));
+            shiftedImages.push_back(createImage(i, 5));
+        }
+
+        std::vector<Keypoint> keypoints1, keypoints2;
+        SRef<DescriptorBuffer> descriptors1, descriptors2;
+        std::vector<DescriptorMatch> matches;
+        auto extraction = [&](SRef<features::IDescriptorsExtractorFromImage> component) {
+            return [&, component](int frame) {
+                keypoints1.clear();
+                descriptors1.reset();
+                return component->extract(images[frame % nbImages], keypoints1, descriptors1) == FrameworkReturnCode::_SUCCESS && !keypoints1.empty();
+            };
+        };
+        auto matching = [&](int frame) {
+            keypoints1.clear();
+            keypoints2.clear();
+            matches.clear();
+            return imageMatcher->match(images[frame % nbImages], shiftedImages[frame % nbImages], keypoints1, keypoints2, descriptors1, descriptors2, matches) == FrameworkReturnCode::_SUCCESS;
+        };
+
+        std::vector<std::pair<std::string, std::function<bool(int)>>> workloads = {
+            { "extraction", extraction(extractor) },
+            { "dense_extraction", extraction(denseExtractor) },
+            { "image_matching", matching }
+        };
+
+        std::vector<Metric> metrics;
+        for (const auto & workload : workloads) {
+            std::vector<Metric> workloadMetrics = runWorkload(workload.first, nbWarmup, nbFrames, workload.second);
+            if (workloadMetrics.empty()) {
+                LOG_ERROR("Workload {} failed", workload.first);
+                return -1;
+            }
+            metrics.insert(metrics.end(), workloadMetrics.begin(), workloadMetrics.end());
+        }
+        // scaling of the CPU dense extraction with the number of workers of the task scheduler
+        double singleThreadFps = 0.0;
+        int nbScalingFrames = std::max(1, nbFrames / 5);
+        for (uint32_t nbThreads = 1; nbThreads <= maxThreads; nbThreads *= 2) {
+            MODULES::POPSIFT::DenseSiftConfig denseConfig;
+            denseConfig.nbThreads = nbThreads;
+            MODULES::POPSIFT::DenseSift denseSift(denseConfig);
+            std::string name = "dense_scaling_" + std::to_string(nbThreads) + "_threads";
+            std::vector<Metric> workloadMetrics = runWorkload(name, nbWarmup, nbScalingFrames, [&](int frame) {
+                return denseSift.extract(images[frame % nbImages], keypoints1, descriptors1) == FrameworkReturnCode::_SUCCESS;
+            });
+            if (workloadMetrics.empty()) {
+                LOG_ERROR("Workload {} failed", name);
+                return -1;
+            }
+            double fps = 0.0;
+            for (const auto & metric : workloadMetrics)
+                if (metric.name == name + ".throughput_fps")
+                    fps = metric.value;
+            if (nbThreads == 1)
+                singleThreadFps = fps;
+            double meanUtilization = 0.0, minUtilization = 1.0;
+            std::ostringstream utilizations;
+            for (const auto & worker : denseSift.getWorkerStats()) {
+                meanUtilization += worker.utilization / double(nbThreads);
+                minUtilization = std::min(minUtilization, worker.utilization);
+                utilizations << " " << std::setprecision(0) << std::fixed << worker.utilization * 100.0 << "%";
+            }
+            std::cout << name << " worker utilization:" << utilizations.str() << std::endl;
+            metrics.insert(metrics.end(), workloadMetrics.begin(), workloadMetrics.end());
+            metrics.push_back({ name + ".speedup", singleThreadFps > 0.0 ? fps / singleThreadFps : 0.0, true });
+            metrics.push_back({ name + ".mean_worker_utilization", meanUtilization, true });
+            metrics.push_back({ name + ".min_worker_utilization", minUtilization, true });
+        }
+        // descriptor kernels of every configuration, specialized at compile time or testing the configuration in their loops
+        namespace kernels = MODULES::POPSIFT::kernels;
+        const std::size_t nbPixels = 640 * 480;
+        const std::size_t nbHistograms = 2000;
+        const std::size_t descriptorLength = MODULES::POPSIFT::DenseSift::descriptorLength;
+        std::vector<uint8_t> bytePixels(nbPixels);
+        std::vector<float> floatPixels(nbPixels), plane(nbPixels);
+        std::vector<float> histograms(nbHistograms * descriptorLength), histogram(descriptorLength);
+        std::vector<float> kernelOutput(nbHistograms * descriptorLength);
+        std::mt19937 random(11);
+        std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+        for (std::size_t i = 0; i < nbPixels; ++i) {
+            bytePixels[i] = uint8_t(random() % 256);
+            floatPixels[i] = bytePixels[i] / 255.0f;
+        }
+        for (auto & bin : histograms)
+            bin = uniform(random) * uniform(random);
+        std::vector<const kernels::DescriptorKernels *> configurations;
+        for (kernels::NormMode norm : { kernels::NormMode::RootSift, kernels::NormMode::Classic })
+            for (kernels::InputType input : { kernels::InputType::Byte, kernels::InputType::Float })
+                for (kernels::DescriptorType type : { kernels::DescriptorType::Float, kernels::DescriptorType::Byte })
+                    configurations.push_back(&kernels::selectDescriptorKernels(norm, input, type));
+        volatile float kernelSink = 0.0f;
+        auto descriptorKernels = [&](bool specialized) {
+            return [&, specialized](int) {
+                for (const kernels::DescriptorKernels * configuration : configurations) {
+                    const void * pixels = configuration->input == kernels::InputType::Byte ? (const void *)bytePixels.data() : (const void *)floatPixels.data();
+                    unsigned char * output = reinterpret_cast<unsigned char *>(kernelOutput.data());
+                    std::size_t size = configuration->descriptorSize;
+                    if (specialized)
+                        configuration->convertPixels(pixels, plane.data(), 0, nbPixels);
+                    else
+                        kernels::convertPixelsGeneric(configuration->input, pixels, plane.data(), 0, nbPixels);
+                    for (std::size_t i = 0; i < nbHistograms; ++i) {
+                        std::copy(histograms.begin() + i * descriptorLength, histograms.begin() + (i + 1) * descriptorLength, histogram.begin());
+                        if (specialized)
+                            configuration->finalizeDescriptor(histogram.data(), output + i * size);
+                        else
+                            kernels::finalizeDescriptorGeneric(configuration->norm, configuration->descriptor, histogram.data(), output + i * size);
+                    }
+                    float sum = 0.0f;
+                    for (std::size_t i = 0; i < nbHistograms; ++i) {
+                        const void * a = output + i * size;
+                        const void * b = output + ((i + 1) % nbHistograms) * size;
+                        sum += specialized ? configuration->descriptorDistance(a, b)
+                                           : kernels::descriptorDistanceGeneric(configuration->descriptor, a, b);
+                    }
+                    kernelSink = kernelSink + sum + plane[nbPixels / 2];
+                }
+                return true;
+            };
+        };
+        double kernelFps[2] = { 0.0, 0.0 };
+        for (bool specialized : { true, false }) {
+            std::string name = std::string("descriptor_kernels_") + (specialized ? "specialized" : "generic");
+            std::vector<Metric> workloadMetrics = runWorkload(name, nbWarmup, nbScalingFrames, descriptorKernels(specialized));
+            if (workloadMetrics.empty()) {
+                LOG_ERROR("Workload {} failed", name);
+                return -1;
+            }
+            for (const auto & metric : workloadMetrics)
+                if (metric.name == name + ".throughput_fps")
+                    kernelFps[specialized ? 0 : 1] = metric.value;
+            metrics.insert(metrics.end(), workloadMetrics.begin(), workloadMetrics.end());
+        }
+        metrics.push_back({ "descriptor_kernels_specialized.speedup", kernelFps[1] > 0.0 ? kernelFps[0] / kernelFps[1] : 0.0, true });
+
+        // Rectified stereo matching of synthetic features: the right keypoints are the left ones shifted by a
+        // disparity, with noisy descriptors and sub-pixel row errors, plus unmatched ones
+        const StereoPair stereoPair = createStereoPair(2000, imageWidth, imageHeight, 96.0f, 13);
+        MODULES::POPSIFT::RectifiedStereoMatcher stereoMatcher;
+        std::vector<DescriptorMatch> stereoMatches;
+        std::vector<float> disparities, distances;
+        uint64_t stereoEvaluations[2] = { 0, 0 };
+        double stereoRecall[2] = { 0.0, 0.0 };
+        double stereoFps[2] = { 0.0, 0.0 };
+        for (bool rowBand : { true, false }) {
+            std::string name = std::string("stereo_matching_") + (rowBand ? "row_band" : "all_pairs");
+            std::vector<Metric> workloadMetrics = runWorkload(name, nbWarmup, nbScalingFrames, [&, rowBand](int) {
+                if (rowBand) {
+                    stereoMatcher.match(stereoPair.leftKeypoints, stereoPair.leftDescriptors.data(), stereoPair.rightKeypoints,
+                                        stereoPair.rightDescriptors.data(), uint32_t(descriptorLength), stereoMatches, disparities);
+                    stereoEvaluations[0] = stereoMatcher.getNbDistanceEvaluations();
+                    return true;
+                }
+                // unconstrained matching with the same ratio test
+                bruteForceMatch(stereoPair.leftDescriptors, stereoPair.rightDescriptors, stereoMatcher.getConfig().ratio, stereoMatches, distances);
+                stereoEvaluations[1] = uint64_t(stereoPair.leftKeypoints.size()) * stereoPair.rightKeypoints.size();
+                return true;
+            });
+            if (workloadMetrics.empty()) {
+                LOG_ERROR("Workload {} failed", name);
+                return -1;
+            }
+            for (const auto & metric : workloadMetrics)
+                if (metric.name == name + ".throughput_fps")
+                    stereoFps[rowBand ? 0 : 1] = metric.value;
+            stereoRecall[rowBand ? 0 : 1] = recallOf(stereoMatches, stereoPair.truth);
+            metrics.insert(metrics.end(), workloadMetrics.begin(), workloadMetrics.end());
+            metrics.push_back({ name + ".distance_evaluations", double(stereoEvaluations[rowBand ? 0 : 1]), false });
+            metrics.push_back({ name + ".recall", stereoRecall[rowBand ? 0 : 1], true });
+        }
+        metrics.push_back({ "stereo_matching_row_band.evaluation_reduction",
+                            stereoEvaluations[0] > 0 ? double(stereoEvaluations[1]) / stereoEvaluations[0] : 0.0, true });
+        metrics.push_back({ "stereo_matching_row_band.speedup", stereoFps[1] > 0.0 ? stereoFps[0] / stereoFps[1] : 0.0, true });
+
+        // Matching of query descriptors against a keyframe set: each query is a noisy copy of one database descriptor.
+        // Binary codes matched by Hamming distance, with and without float re-ranking, are compared to float matching.
+        const uint32_t nbDatabaseDescriptors = 10000;
+        const uint32_t nbQueryDescriptors = 500;
+        const uint32_t nbRerankedCandidates = 16;
+        const MatchingSet matchingSet = createMatchingSet(nbDatabaseDescriptors, nbQueryDescriptors, 200, 17);
+        const std::vector<float> & databaseDescriptors = matchingSet.database;
+        const std::vector<float> & queryDescriptors = matchingSet.queries;
+        MODULES::POPSIFT::BinarySiftEmbedding embedding;
+        embedding.setRandom(1);
+        std::vector<uint64_t> databaseCodes(std::size_t(nbDatabaseDescriptors) * MODULES::POPSIFT::BinarySiftEmbedding::nbWords);
+        std::vector<uint64_t> queryCodes(std::size_t(nbQueryDescriptors) * MODULES::POPSIFT::BinarySiftEmbedding::nbWords);
+        embedding.encode(databaseDescriptors.data(), nbDatabaseDescriptors, databaseCodes.data());
+        embedding.encode(queryDescriptors.data(), nbQueryDescriptors, queryCodes.data());
+        MODULES::POPSIFT::BinarySiftMatcher binaryMatcher;
+        std::vector<DescriptorMatch> binaryMatches;
+        std::vector<float> databaseDistances(nbDatabaseDescriptors);
+        const float matchingRatio = binaryMatcher.getConfig().ratio;
+        const char * binaryWorkloads[3] = { "binary_matching_hamming", "binary_matching_reranked", "float_matching" };
+        double binaryFps[3] = { 0.0, 0.0, 0.0 };
+        for (int mode = 0; mode < 3; ++mode) {
+            std::string name = binaryWorkloads[mode];
+            MODULES::POPSIFT::BinaryMatcherConfig binaryConfig;
+            binaryConfig.nbCandidates = mode == 1 ? nbRerankedCandidates : 0;
+            binaryMatcher.setConfig(binaryConfig);
+            std::vector<Metric> workloadMetrics = runWorkload(name, nbWarmup, nbScalingFrames, [&, mode](int) {
+                if (mode < 2) {
+                    binaryMatcher.match(queryCodes.data(), nbQueryDescriptors, databaseCodes.data(), nbDatabaseDescriptors,
+                                        mode == 1 ? queryDescriptors.data() : nullptr, databaseDescriptors.data(),
+                                        kernels::DescriptorType::Float, binaryMatches);
+                    return true;
+                }
+                bruteForceMatch(queryDescriptors, databaseDescriptors, matchingRatio, binaryMatches, databaseDistances);
+                return true;
+            });
+            if (workloadMetrics.empty()) {
+                LOG_ERROR("Workload {} failed", name);
+                return -1;
+            }
+            for (const auto & metric : workloadMetrics)
+                if (metric.name == name + ".throughput_fps")
+                    binaryFps[mode] = metric.value;
+            metrics.insert(metrics.end(), workloadMetrics.begin(), workloadMetrics.end());
+            metrics.push_back({ name + ".recall", recallOf(binaryMatches, matchingSet.truth), true });
+        }
+        metrics.push_back({ "binary_matching_hamming.speedup", binaryFps[2] > 0.0 ? binaryFps[0] / binaryFps[2] : 0.0, true });
+        metrics.push_back({ "binary_matching_reranked.speedup", binaryFps[2] > 0.0 ? binaryFps[1] / binaryFps[2] : 0.0, true });
+        metrics.push_back({ "process.peak_rss_mb", peakRssMB(), false });
+
+        int nbRegressions = compare(metrics, baseline);
+
+        if (updateBaseline) {
+            if (!saveBaseline(baselineFile, metrics, baseline)) {
+                LOG_ERROR("Cannot write the baseline file {}", baselineFile);
+                return -1;
+            }
+            std::cout << "Baseline " << baselineFile << " updated" << std::endl;
+            return 0;
+        }
+        if (nbRegressions > 0) {
+            std::cout << nbRegressions << " metrics regressed against " << baselineFile << std::endl;
+            return -1;
+        }
+    }
+    catch (xpcf::Exception e)
+    {
+        LOG_ERROR ("The following exception has been catch : {}", e.what());
+        return -1;
+    }
+    return 0;
+}
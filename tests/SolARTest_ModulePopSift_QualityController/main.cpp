@@ -0,0 +1,271 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "xpcf/xpcf.h"
+#include "xpcf/component/ComponentBase.h"
+
+#include "api/features/IDescriptorsExtractorFromImage.h"
+#include "IPopSiftQualityControl.h"
+#include "SolARPopSiftQualityController.h"
+#include "SolARTest_ModulePopSift_SyntheticImages.h"
+#include "core/Log.h"
+
+#include <boost/log/core.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace SolAR;
+using namespace SolAR::datastructure;
+using namespace SolAR::api;
+using namespace SolAR::MODULES::POPSIFT;
+using namespace SolAR::MODULES::POPSIFT::TEST;
+
+namespace xpcf  = org::bcom::xpcf;
+
+namespace {
+
+const float targetLatency = 20.0f;
+const float baseThreshold = 0.04f;
+const uint32_t baseMaxKeypoints = 10000;
+
+}
+
+// Stand-in for the PopSift extractor: the stage times are modelled from the settings of the controller and from a
+// load factor simulating the other work of the GPU and of the CPU. At load 1, the configured settings take 18.4 ms.
+class SimulatedExtractor : public xpcf::ComponentBase,
+    public features::IDescriptorsExtractorFromImage,
+    public IPopSiftQualityControl
+{
+public:
+    SimulatedExtractor() : ComponentBase(xpcf::toUUID<SimulatedExtractor>()), m_random(42)
+    {
+        addInterface<features::IDescriptorsExtractorFromImage>(this);
+        addInterface<IPopSiftQualityControl>(this);
+        QualityControllerConfig config;
+        config.base.threshold = baseThreshold;
+        config.base.maxKeypoints = baseMaxKeypoints;
+        config.maxThreshold = 0.12f;
+        config.minKeypoints = 500;
+        config.maxFirstOctave = 2;
+        m_controller.setConfig(config);
+    }
+
+    void setLoad(float load) { m_load = load; }
+
+    std::string getTypeString() override { return std::string("DescriptorsExtractorType::SIFT"); }
+
+    FrameworkReturnCode extract(const SRef<Image> image, std::vector<Keypoint> & keypoints, SRef<DescriptorBuffer> & descriptors) override
+    {
+        QualitySettings settings = m_controller.getSettings();
+        float octaveScale = std::pow(2.0f, float(settings.firstOctave));
+        float nbExtrema = 8000.0f * std::pow(baseThreshold / settings.threshold, 1.5f) / octaveScale;
+        uint32_t nbKeypoints = std::min(uint32_t(nbExtrema), settings.maxKeypoints);
+        std::uniform_real_distribution<float> jitter(0.97f, 1.03f);
+        float pyramidTime = 8.0f * m_load / (octaveScale * octaveScale);
+        float descriptionTime = 0.0008f * m_load * float(nbKeypoints);
+        float conversionTime = 0.0005f * m_load * float(nbKeypoints);
+
+        keypoints.resize(nbKeypoints);
+        for (uint32_t i = 0; i < nbKeypoints; ++i)
+            keypoints[i].init(i, float(i % image->getWidth()), float(i / image->getWidth() % image->getHeight()), 0.0f, 0.0f, 0.0f, octaveScale, 0.0f);
+        descriptors.reset(new DescriptorBuffer(DescriptorType::SIFT, DescriptorDataType::TYPE_32F, 128, nbKeypoints));
+        m_lastLatency = (pyramidTime + descriptionTime) * jitter(m_random) + conversionTime * jitter(m_random);
+        m_controller.update(m_lastLatency - conversionTime, conversionTime, nbKeypoints);
+        return FrameworkReturnCode::_SUCCESS;
+    }
+
+    void setTargetLatency(float target) override { m_controller.setTargetLatency(target); }
+
+    QualityState getQualityState() const override { return m_controller.getState(); }
+
+    float getLastLatency() const { return m_lastLatency; }
+
+private:
+    QualityController m_controller;
+    std::mt19937 m_random;
+    float m_load = 1.0f;
+    float m_lastLatency = 0.0f;
+};
+
+template <> struct org::bcom::xpcf::ComponentTraits<SimulatedExtractor>
+{
+    static constexpr const char * UUID = "{aae20982-d60d-47a8-b4bf-7a51231f3bf8}";
+    static constexpr const char * NAME = "SimulatedExtractor";
+    static constexpr const char * DESCRIPTION = "SimulatedExtractor implements SolAR::api::features::IDescriptorsExtractorFromImage interface";
+};
+
+struct PhaseResult {
+    float meanLatency = 0.0f;       // over the last frames of the phase
+    float maxLatency = 0.0f;        // over the last frames of the phase
+    uint64_t lateAdjustments = 0;   // adjustments during the last frames of the phase
+    uint32_t nbKeypoints = 0;       // of the last frame
+};
+
+// Runs nbFrames under a load factor, the last nbSteadyFrames being measured
+static PhaseResult runPhase(SRef<SimulatedExtractor> extractor, const SRef<Image> image, float load, int nbFrames, int nbSteadyFrames)
+{
+    PhaseResult result;
+    extractor->setLoad(load);
+    std::vector<Keypoint> keypoints;
+    SRef<DescriptorBuffer> descriptors;
+    uint64_t adjustments = 0;
+    for (int frame = 0; frame < nbFrames; ++frame) {
+        if (frame == nbFrames - nbSteadyFrames)
+            adjustments = extractor->getQualityState().nbAdjustments;
+        extractor->extract(image, keypoints, descriptors);
+        if (frame >= nbFrames - nbSteadyFrames) {
+            result.meanLatency += extractor->getLastLatency() / float(nbSteadyFrames);
+            result.maxLatency = std::max(result.maxLatency, extractor->getLastLatency());
+        }
+    }
+    result.lateAdjustments = extractor->getQualityState().nbAdjustments - adjustments;
+    result.nbKeypoints = uint32_t(keypoints.size());
+    return result;
+}
+
+int main()
+{
+#if NDEBUG
+    boost::log::core::get()->set_logging_enabled(false);
+#endif
+    LOG_ADD_LOG_TO_CONSOLE();
+
+    SRef<Image> image = xpcf::utils::make_shared<Image>(640, 480, Image::ImageLayout::LAYOUT_GREY, Image::PixelOrder::INTERLEAVED, Image::DataType::TYPE_8U);
+    SRef<SimulatedExtractor> extractor = xpcf::utils::make_shared<SimulatedExtractor>();
+    SRef<IPopSiftQualityControl> qualityControl = extractor;
+    qualityControl->setTargetLatency(targetLatency);
+
+    // the state is watched from another thread while the frames are extracted
+    std::atomic<bool> stopWatching(false);
+    std::atomic<int> nbInvalidStates(0);
+    std::thread watcher([&]() {
+        while (!stopWatching) {
+            QualityState state = qualityControl->getQualityState();
+            if (!state.enabled || state.settings.threshold < baseThreshold || state.settings.threshold > 0.12f ||
+                state.settings.maxKeypoints < 500 || state.settings.maxKeypoints > baseMaxKeypoints || state.settings.firstOctave > 2)
+                nbInvalidStates++;
+            std::this_thread::yield();
+        }
+    });
+
+    // nominal load: the configured settings meet the target, nothing changes
+    PhaseResult nominal = runPhase(extractor, image, 1.0f, 50, 50);
+    uint64_t nominalAdjustments = qualityControl->getQualityState().nbAdjustments;
+    // load spike: the settings are degraded until the target is met again
+    PhaseResult spike = runPhase(extractor, image, 3.0f, 100, 30);
+    QualityState spikeState = qualityControl->getQualityState();
+    // back to nominal load: the configured settings are restored
+    PhaseResult recovery = runPhase(extractor, image, 1.0f, 200, 30);
+    QualityState recoveryState = qualityControl->getQualityState();
+
+    stopWatching = true;
+    watcher.join();
+
+    LOG_INFO("Nominal load: {} ms, {} keypoints, {} adjustments", nominal.meanLatency, nominal.nbKeypoints, nominalAdjustments);
+    LOG_INFO("Load spike: {} ms (max {}), {} keypoints, threshold {}, keypoint cap {}, first octave {}, {} adjustments in steady state",
+             spike.meanLatency, spike.maxLatency, spike.nbKeypoints, spikeState.settings.threshold, spikeState.settings.maxKeypoints,
+             spikeState.settings.firstOctave, spike.lateAdjustments);
+    LOG_INFO("Recovery: {} ms, {} keypoints, threshold {}, keypoint cap {}, first octave {}",
+             recovery.meanLatency, recovery.nbKeypoints, recoveryState.settings.threshold, recoveryState.settings.maxKeypoints,
+             recoveryState.settings.firstOctave);
+
+    int result = 0;
+    if (nominalAdjustments != 0) {
+        LOG_ERROR("The settings changed at nominal load");
+        result = -1;
+    }
+    if (spike.meanLatency > targetLatency * 1.1f || spike.lateAdjustments > 3) {
+        LOG_ERROR("The controller did not converge under the target during the load spike");
+        result = -1;
+    }
+    if (spikeState.settings.firstOctave == 0) {
+        LOG_ERROR("The pyramid cost alone exceeds the target during the load spike, the first octave should have been raised");
+        result = -1;
+    }
+    if (recovery.meanLatency > targetLatency * 1.1f || recovery.nbKeypoints < nominal.nbKeypoints * 95 / 100 || recoveryState.settings.firstOctave != 0) {
+        LOG_ERROR("The configured settings were not restored after the load spike");
+        result = -1;
+    }
+    if (nbInvalidStates > 0) {
+        LOG_ERROR("{} states read from the watching thread were out of bounds", nbInvalidStates.load());
+        result = -1;
+    }
+
+    // disabling the controller restores the configured settings
+    qualityControl->setTargetLatency(0.0f);
+    QualityState disabledState = qualityControl->getQualityState();
+    if (disabledState.enabled || disabledState.settings.threshold != baseThreshold ||
+        disabledState.settings.maxKeypoints != baseMaxKeypoints || disabledState.settings.firstOctave != 0) {
+        LOG_ERROR("The configured settings were not restored when disabling the controller");
+        result = -1;
+    }
+
+    // PopSift extractor: the degraded settings must reach the context, whose pyramid is allocated by the priming job
+    try {
+        SRef<xpcf::IComponentManager> xpcfComponentManager = xpcf::getComponentManagerInstance();
+        if (xpcfComponentManager->load("SolARTest_ModulePopSift_QualityController_conf.xml") != org::bcom::xpcf::_SUCCESS) {
+            LOG_ERROR("Failed to load the configuration file SolARTest_ModulePopSift_QualityController_conf.xml")
+            return -1;
+        }
+        SRef<features::IDescriptorsExtractorFromImage> popSiftExtractor = xpcfComponentManager->resolve<features::IDescriptorsExtractorFromImage>();
+        SRef<IPopSiftQualityControl> popSiftQualityControl = popSiftExtractor->bindTo<IPopSiftQualityControl>();
+        SRef<Image> blobImage = createBlobImage(640, 480);
+        std::vector<Keypoint> keypoints;
+        SRef<DescriptorBuffer> descriptors;
+
+        popSiftExtractor->extract(blobImage, keypoints, descriptors);
+        uint32_t nominalKeypoints = descriptors->getNbDescriptors();
+        // an unreachable target degrades the settings at every frame
+        popSiftQualityControl->setTargetLatency(0.001f);
+        for (int frame = 0; frame < 10; ++frame)
+            popSiftExtractor->extract(blobImage, keypoints, descriptors);
+        uint32_t degradedKeypoints = descriptors->getNbDescriptors();
+        QualityState degradedState = popSiftQualityControl->getQualityState();
+        popSiftQualityControl->setTargetLatency(0.0f);
+        popSiftExtractor->extract(blobImage, keypoints, descriptors);
+        uint32_t restoredKeypoints = descriptors->getNbDescriptors();
+
+        LOG_INFO("PopSift extractor: {} keypoints, {} with threshold {} and keypoint cap {}, {} once restored", nominalKeypoints,
+                 degradedKeypoints, degradedState.settings.threshold, degradedState.settings.maxKeypoints, restoredKeypoints);
+        if (nominalKeypoints == 0 || degradedState.nbAdjustments == 0 || degradedKeypoints >= nominalKeypoints) {
+            LOG_ERROR("The degraded settings did not reach the PopSift context");
+            result = -1;
+        }
+        if (restoredKeypoints != nominalKeypoints) {
+            LOG_ERROR("The configured settings did not reach the PopSift context when disabling the controller");
+            result = -1;
+        }
+        // each extraction replaces the keypoints of the previous one
+        if (keypoints.size() != restoredKeypoints) {
+            LOG_ERROR("{} keypoints returned for {} descriptors", keypoints.size(), restoredKeypoints);
+            result = -1;
+        }
+    }
+    catch (xpcf::Exception e)
+    {
+        LOG_ERROR ("The following exception has been catch : {}", e.what());
+        return -1;
+    }
+
+    if (result == 0)
+        LOG_INFO("Quality controller test succeeded");
+    return result;
+}
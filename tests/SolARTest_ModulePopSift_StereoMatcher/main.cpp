@@ -0,0 +1,198 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "xpcf/xpcf.h"
+
+#include "IPopSiftStereoMatcher.h"
+#include "SolARPopSiftKernels.h"
+#include "SolARPopSiftStereoMatcher.h"
+#include "SolARTest_ModulePopSift_SyntheticDescriptors.h"
+#include "core/Log.h"
+
+#include <boost/log/core.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace SolAR;
+using namespace SolAR::datastructure;
+using namespace SolAR::MODULES::POPSIFT;
+using namespace SolAR::MODULES::POPSIFT::TEST;
+
+namespace xpcf  = org::bcom::xpcf;
+
+namespace {
+
+const uint32_t width = 640;
+const uint32_t height = 480;
+
+// Exhaustive search of the right keypoints satisfying the constraints, with the decisions of the row-band search
+void referenceMatch(const StereoPair & pair, const StereoMatcherConfig & config, std::vector<DescriptorMatch> & matches, std::vector<float> & disparities)
+{
+    matches.clear();
+    disparities.clear();
+    for (uint32_t i = 0; i < pair.leftKeypoints.size(); ++i) {
+        const Keypoint & left = pair.leftKeypoints[i];
+        float best = std::numeric_limits<float>::max();
+        float second = std::numeric_limits<float>::max();
+        uint32_t bestIndex = 0;
+        for (uint32_t j = 0; j < pair.rightKeypoints.size(); ++j) {
+            const Keypoint & right = pair.rightKeypoints[j];
+            float disparity = left.getX() - right.getX();
+            if (std::abs(right.getY() - left.getY()) > config.rowTolerance || disparity < config.minDisparity || disparity > config.maxDisparity)
+                continue;
+            float distance = kernels::l2sqr(pair.leftDescriptors.data() + i * descriptorLength, pair.rightDescriptors.data() + j * descriptorLength, descriptorLength);
+            if (distance < best) {
+                second = best;
+                best = distance;
+                bestIndex = j;
+            }
+            else if (distance < second)
+                second = distance;
+        }
+        if (best == std::numeric_limits<float>::max())
+            continue;
+        if (second != std::numeric_limits<float>::max() && best >= config.ratio * config.ratio * second)
+            continue;
+        if (config.maxDistance > 0.0f && best > config.maxDistance * config.maxDistance)
+            continue;
+        matches.push_back(DescriptorMatch(i, bestIndex, std::sqrt(best)));
+        disparities.push_back(left.getX() - pair.rightKeypoints[bestIndex].getX());
+    }
+}
+
+bool sameMatches(const std::vector<DescriptorMatch> & matches, const std::vector<float> & disparities,
+                 const std::vector<DescriptorMatch> & expected, const std::vector<float> & expectedDisparities)
+{
+    if (matches.size() != expected.size() || disparities.size() != matches.size() || expectedDisparities.size() != expected.size())
+        return false;
+    for (std::size_t i = 0; i < matches.size(); ++i)
+        if (matches[i].getIndexInDescriptorA() != expected[i].getIndexInDescriptorA() ||
+            matches[i].getIndexInDescriptorB() != expected[i].getIndexInDescriptorB() ||
+            matches[i].getMatchingScore() != expected[i].getMatchingScore() ||
+            disparities[i] != expectedDisparities[i])
+            return false;
+    return true;
+}
+
+}
+
+int main()
+{
+#if NDEBUG
+    boost::log::core::get()->set_logging_enabled(false);
+#endif
+    LOG_ADD_LOG_TO_CONSOLE();
+
+    int result = 0;
+    StereoPair pair = createStereoPair(3000, width, height, 96.0f, 7);
+    SRef<DescriptorBuffer> leftDescriptors = toBuffer(pair.leftDescriptors);
+    SRef<DescriptorBuffer> rightDescriptors = toBuffer(pair.rightDescriptors);
+
+    // recall, disparities and distance evaluations of the default configuration
+    RectifiedStereoMatcher matcher;
+    std::vector<DescriptorMatch> matches;
+    std::vector<float> disparities;
+    if (matcher.match(pair.leftKeypoints, leftDescriptors, pair.rightKeypoints, rightDescriptors, matches, disparities) != FrameworkReturnCode::_SUCCESS) {
+        LOG_ERROR("Stereo matching failed");
+        return -1;
+    }
+    uint32_t nbWrongDisparities = 0;
+    for (std::size_t i = 0; i < matches.size(); ++i) {
+        uint32_t left = matches[i].getIndexInDescriptorA();
+        if (pair.truth[left] == int(matches[i].getIndexInDescriptorB()) && std::abs(disparities[i] - pair.disparities[left]) > 1e-3f)
+            ++nbWrongDisparities;
+    }
+    float recall = recallOf(matches, pair.truth);
+    uint64_t nbAllPairs = uint64_t(pair.leftKeypoints.size()) * pair.rightKeypoints.size();
+    LOG_INFO("{} matches, recall {}, {} distance evaluations instead of {}", matches.size(), recall, matcher.getNbDistanceEvaluations(), nbAllPairs);
+    if (recall < 0.95f || nbWrongDisparities > 0) {
+        LOG_ERROR("Wrong stereo matches: recall {}, {} wrong disparities", recall, nbWrongDisparities);
+        result = -1;
+    }
+    if (matcher.getNbDistanceEvaluations() * 10 > nbAllPairs) {
+        LOG_ERROR("The row bands do not reduce the distance evaluations by an order of magnitude");
+        result = -1;
+    }
+
+    // same matches as the exhaustive search of the constrained candidates, for several search windows
+    std::vector<StereoMatcherConfig> configurations(4);
+    configurations[1].rowTolerance = 0.3f;
+    configurations[2].rowTolerance = 6.5f;
+    configurations[2].minDisparity = 10.0f;
+    configurations[2].maxDisparity = 40.0f;
+    configurations[3].ratio = 1.0f;
+    configurations[3].maxDistance = 0.5f;
+    for (const StereoMatcherConfig & configuration : configurations) {
+        std::vector<DescriptorMatch> expected;
+        std::vector<float> expectedDisparities;
+        matcher.setConfig(configuration);
+        matcher.match(pair.leftKeypoints, leftDescriptors, pair.rightKeypoints, rightDescriptors, matches, disparities);
+        referenceMatch(pair, configuration, expected, expectedDisparities);
+        if (!sameMatches(matches, disparities, expected, expectedDisparities)) {
+            LOG_ERROR("Row-band search differs from the exhaustive one (row tolerance {}, disparities [{}, {}], ratio {}): {} matches instead of {}",
+                      configuration.rowTolerance, configuration.minDisparity, configuration.maxDisparity, configuration.ratio, matches.size(), expected.size());
+            result = -1;
+        }
+    }
+
+    // invalid inputs
+    std::vector<Keypoint> noKeypoints;
+    if (matcher.match(noKeypoints, toBuffer({}), pair.rightKeypoints, rightDescriptors, matches, disparities) != FrameworkReturnCode::_SUCCESS || !matches.empty() ||
+        matcher.match(pair.leftKeypoints, rightDescriptors, pair.rightKeypoints, rightDescriptors, matches, disparities) == FrameworkReturnCode::_SUCCESS) {
+        LOG_ERROR("Wrong handling of empty or inconsistent features");
+        result = -1;
+    }
+
+    // stereo mode of the image matcher on a pair with a constant disparity
+    try {
+        SRef<xpcf::IComponentManager> xpcfComponentManager = xpcf::getComponentManagerInstance();
+        if (xpcfComponentManager->load("SolARTest_ModulePopSift_StereoMatcher_conf.xml") != org::bcom::xpcf::_SUCCESS) {
+            LOG_ERROR("Failed to load the configuration file SolARTest_ModulePopSift_StereoMatcher_conf.xml")
+            return -1;
+        }
+        SRef<IPopSiftStereoMatcher> stereoMatcher = xpcfComponentManager->resolve<IPopSiftStereoMatcher>();
+        const int shift = 24;
+        SRef<Image> left = createBlobImage(width, height);
+        SRef<Image> right = createBlobImage(width, height, shift);
+        std::vector<Keypoint> leftKeypoints, rightKeypoints;
+        SRef<DescriptorBuffer> leftImageDescriptors, rightImageDescriptors;
+        if (stereoMatcher->matchStereo(left, right, leftKeypoints, rightKeypoints, leftImageDescriptors, rightImageDescriptors, matches, disparities) != FrameworkReturnCode::_SUCCESS) {
+            LOG_ERROR("Stereo matching of the images failed");
+            return -1;
+        }
+        uint32_t nbConsistent = 0;
+        for (float disparity : disparities)
+            nbConsistent += std::abs(disparity - shift) <= 1.0f;
+        LOG_INFO("{} and {} keypoints, {} matches, {} at the disparity of the pair, {} distance evaluations",
+                 leftKeypoints.size(), rightKeypoints.size(), matches.size(), nbConsistent, stereoMatcher->getNbDistanceEvaluations());
+        if (matches.empty() || nbConsistent < 0.9f * matches.size() ||
+            stereoMatcher->getNbDistanceEvaluations() * 10 > uint64_t(leftKeypoints.size()) * rightKeypoints.size()) {
+            LOG_ERROR("Wrong stereo matches of the images");
+            result = -1;
+        }
+    }
+    catch (xpcf::Exception e)
+    {
+        LOG_ERROR ("The following exception has been catch : {}", e.what());
+        return -1;
+    }
+
+    if (result == 0)
+        LOG_INFO("Stereo matcher test succeeded");
+    return result;
+}
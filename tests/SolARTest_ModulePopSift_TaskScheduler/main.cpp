@@ -0,0 +1,141 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "xpcf/xpcf.h"
+
+#include "SolARPopSiftDenseSift.h"
+#include "SolARPopSiftTaskScheduler.h"
+#include "SolARTest_ModulePopSift_SyntheticImages.h"
+#include "core/Log.h"
+
+#include <boost/log/core.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace SolAR;
+using namespace SolAR::datastructure;
+using namespace SolAR::MODULES::POPSIFT;
+using namespace SolAR::MODULES::POPSIFT::TEST;
+
+namespace xpcf  = org::bcom::xpcf;
+
+// Random graph of uneven tasks: every task must run once, after all its dependencies
+static bool checkGraph(TaskScheduler & scheduler, int nbRuns)
+{
+    const int nbTasks = 2000;
+    std::mt19937 random(7);
+    std::vector<std::vector<TaskGraph::TaskId>> dependencies(nbTasks);
+    for (int i = 1; i < nbTasks; ++i) {
+        int nbDependencies = int(random() % 4);
+        for (int d = 0; d < nbDependencies; ++d)
+            dependencies[i].push_back(TaskGraph::TaskId(random() % i));
+    }
+    std::vector<std::atomic<int>> runs(nbTasks);
+    std::atomic<int> nbErrors(0);
+    TaskGraph graph;
+    for (int i = 0; i < nbTasks; ++i) {
+        uint32_t work = 100u << (random() % 8);
+        graph.add([&, i, work]() {
+            for (TaskGraph::TaskId dependency : dependencies[i])
+                if (runs[dependency] == 0)
+                    nbErrors++;
+            volatile float sink = 0.0f;
+            for (uint32_t k = 0; k < work; ++k)
+                sink = sink + std::sqrt(float(k));
+            runs[i]++;
+        }, dependencies[i]);
+    }
+    for (int run = 0; run < nbRuns; ++run) {
+        for (auto & count : runs)
+            count = 0;
+        scheduler.run(graph);
+        for (int i = 0; i < nbTasks; ++i)
+            if (runs[i] != 1)
+                nbErrors++;
+    }
+    if (nbErrors > 0)
+        LOG_ERROR("{} threads: {} tasks ran out of order or not exactly once", scheduler.getNbThreads(), nbErrors.load());
+    return nbErrors == 0;
+}
+
+int main()
+{
+#if NDEBUG
+    boost::log::core::get()->set_logging_enabled(false);
+#endif
+    LOG_ADD_LOG_TO_CONSOLE();
+
+    int result = 0;
+    for (bool pinWorkers : { false, true }) {
+        for (uint32_t nbThreads : { 1u, 2u, 4u, 8u }) {
+            TaskScheduler scheduler(nbThreads, pinWorkers);
+            if (!checkGraph(scheduler, 5))
+                result = -1;
+            uint64_t nbTasks = 0;
+            for (const WorkerStats & stats : scheduler.getWorkerStats()) {
+                nbTasks += stats.nbTasks;
+                if (stats.utilization < 0.0 || stats.utilization > 1.0)
+                    result = -1;
+                // the workers are only pinned on request
+                if (!pinWorkers && stats.cpu != -1) {
+                    LOG_ERROR("{} threads: a worker is pinned to CPU {} without request", nbThreads, stats.cpu);
+                    result = -1;
+                }
+            }
+            if (nbTasks != 5 * 2000) {
+                LOG_ERROR("{} threads: the workers report {} tasks instead of {}", nbThreads, nbTasks, 5 * 2000);
+                result = -1;
+            }
+        }
+    }
+
+    // the dense extraction does not depend on the number of threads
+    SRef<Image> image = createTexturedImage(320, 240);
+    std::vector<float> reference;
+    for (uint32_t nbThreads : { 1u, 3u, 8u }) {
+        DenseSiftConfig config;
+        config.scales = { 1.6f, 3.2f, 6.4f };
+        config.nbThreads = nbThreads;
+        config.tileHeight = 16;
+        DenseSift denseSift(config);
+        std::vector<Keypoint> keypoints;
+        SRef<DescriptorBuffer> descriptors;
+        if (denseSift.extract(image, keypoints, descriptors) != FrameworkReturnCode::_SUCCESS || keypoints.empty()) {
+            LOG_ERROR("Dense extraction with {} threads failed", nbThreads);
+            return -1;
+        }
+        const float * data = static_cast<const float *>(descriptors->data());
+        std::size_t size = std::size_t(descriptors->getNbDescriptors()) * DenseSift::descriptorLength;
+        if (reference.empty())
+            reference.assign(data, data + size);
+        else if (size != reference.size() || std::memcmp(data, reference.data(), size * sizeof(float)) != 0) {
+            LOG_ERROR("Dense extraction with {} threads differs from the single thread one", nbThreads);
+            result = -1;
+        }
+        std::vector<WorkerStats> stats = denseSift.getWorkerStats();
+        for (std::size_t i = 0; i < stats.size(); ++i)
+            LOG_INFO("{} threads, worker {} (cpu {}, node {}): {} tasks, {} stolen, {}% busy", nbThreads, i,
+                     stats[i].cpu, stats[i].numaNode, stats[i].nbTasks, stats[i].nbStolenTasks, int(stats[i].utilization * 100.0));
+    }
+
+    if (result == 0)
+        LOG_INFO("Task scheduler test succeeded");
+    return result;
+}
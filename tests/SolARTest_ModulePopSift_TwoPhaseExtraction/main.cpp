@@ -0,0 +1,126 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "xpcf/xpcf.h"
+
+#include "api/features/IDescriptorsExtractor.h"
+#include "api/features/IDescriptorsExtractorFromImage.h"
+#include "api/features/IKeypointDetector.h"
+#include "SolARTest_ModulePopSift_SyntheticImages.h"
+#include "core/Log.h"
+
+#include <boost/log/core.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace SolAR;
+using namespace SolAR::datastructure;
+using namespace SolAR::api;
+using namespace SolAR::MODULES::POPSIFT::TEST;
+
+namespace xpcf  = org::bcom::xpcf;
+
+int main()
+{
+#if NDEBUG
+    boost::log::core::get()->set_logging_enabled(false);
+#endif
+    try {
+        LOG_ADD_LOG_TO_CONSOLE();
+
+        SRef<xpcf::IComponentManager> xpcfComponentManager = xpcf::getComponentManagerInstance();
+
+        if(xpcfComponentManager->load("SolARTest_ModulePopSift_TwoPhaseExtraction_conf.xml")!=org::bcom::xpcf::_SUCCESS)
+        {
+            LOG_ERROR("Failed to load the configuration file SolARTest_ModulePopSift_TwoPhaseExtraction_conf.xml")
+            return -1;
+        }
+
+        // the same component provides the single call and the two-phase APIs. IDescriptorsExtractor is bound from the
+        // resolved component, the registry listing only the interfaces it is resolved by
+        SRef<features::IKeypointDetector> detector = xpcfComponentManager->resolve<features::IKeypointDetector>();
+        if (!detector)
+        {
+            LOG_ERROR("One or more component creations have failed");
+            return -1;
+        }
+        SRef<features::IDescriptorsExtractor> descriptorsExtractor = detector->bindTo<features::IDescriptorsExtractor>();
+        SRef<features::IDescriptorsExtractorFromImage> extractorFromImage = detector->bindTo<features::IDescriptorsExtractorFromImage>();
+
+        SRef<Image> image = createTexturedImage(320, 240, 0);
+        std::vector<Keypoint> keypoints;
+        detector->detect(image, keypoints);
+        if (keypoints.empty())
+        {
+            LOG_ERROR("No keypoint was detected");
+            return -1;
+        }
+
+        // the caller culls the keypoints before describing them: about 70% are dropped
+        std::vector<Keypoint> keptKeypoints;
+        for (size_t i = 0; i < keypoints.size(); i += 3)
+            keptKeypoints.push_back(keypoints[i]);
+        SRef<DescriptorBuffer> keptDescriptors;
+        descriptorsExtractor->extract(image, keptKeypoints, keptDescriptors);
+        if (!keptDescriptors || keptDescriptors->getNbDescriptors() != keptKeypoints.size() || keptDescriptors->getDescriptorLength() != 128)
+        {
+            LOG_ERROR("{} descriptors were computed for {} kept keypoints", keptDescriptors ? keptDescriptors->getNbDescriptors() : 0, keptKeypoints.size());
+            return -1;
+        }
+        LOG_INFO("{} keypoints detected, {} described", keypoints.size(), keptKeypoints.size());
+
+        // the descriptors of the kept keypoints are the ones of the single call extraction
+        std::vector<Keypoint> allKeypoints;
+        SRef<DescriptorBuffer> allDescriptors;
+        if (extractorFromImage->extract(image, allKeypoints, allDescriptors) != FrameworkReturnCode::_SUCCESS || allKeypoints.size() != keypoints.size())
+        {
+            LOG_ERROR("The single call extraction does not detect the same keypoints");
+            return -1;
+        }
+        const float * allData = static_cast<const float *>(allDescriptors->data());
+        const float * keptData = static_cast<const float *>(keptDescriptors->data());
+        for (size_t i = 0; i < keptKeypoints.size(); ++i)
+        {
+            const Keypoint & keypoint = allKeypoints[i * 3];
+            if (keypoint.getX() != keptKeypoints[i].getX() || keypoint.getY() != keptKeypoints[i].getY() ||
+                std::memcmp(allData + i * 3 * 128, keptData + i * 128, 128 * sizeof(float)) != 0)
+            {
+                LOG_ERROR("The descriptor of keypoint {} differs from the single call extraction", keptKeypoints[i].getId());
+                return -1;
+            }
+        }
+
+        // describing the keypoints on another image rebuilds the resident pyramid
+        SRef<DescriptorBuffer> shiftedDescriptors;
+        descriptorsExtractor->extract(createTexturedImage(320, 240, 8), keptKeypoints, shiftedDescriptors);
+        if (!shiftedDescriptors || shiftedDescriptors->getNbDescriptors() != keptKeypoints.size() ||
+            std::memcmp(shiftedDescriptors->data(), keptDescriptors->data(), keptKeypoints.size() * 128 * sizeof(float)) == 0)
+        {
+            LOG_ERROR("The descriptors were not computed on the second image");
+            return -1;
+        }
+        LOG_INFO("Two-phase extraction matches the single call extraction");
+    }
+    catch (xpcf::Exception e)
+    {
+        LOG_ERROR ("The following exception has been catch : {}", e.what());
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,283 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "xpcf/xpcf.h"
+#include "xpcf/component/ComponentBase.h"
+
+#include "api/features/IDescriptorsExtractorFromImage.h"
+#include "IPopSiftWarmup.h"
+#include "SolARPopSiftWarmup.h"
+#include "core/Log.h"
+
+#include <boost/log/core.hpp>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace SolAR;
+using namespace SolAR::datastructure;
+using namespace SolAR::api;
+using namespace SolAR::MODULES::POPSIFT;
+
+namespace xpcf  = org::bcom::xpcf;
+
+namespace {
+
+// simulated costs of the PopSift extractor, in ms
+const int deviceQueryCost = 40;
+const int contextCreationCost = 250;
+const int contextReconfigurationCost = 5;
+const int allocationCost = 120;     // buffers of a new image size, on the first job
+const int frameCost = 10;
+
+void simulate(int cost)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(cost));
+}
+
+float elapsed(Warmup::Clock::time_point start)
+{
+    return std::chrono::duration<float, std::milli>(Warmup::Clock::now() - start).count();
+}
+
+}
+
+// Stand-in for the PopSift extractor: its configuration follows the one of the component, with the device query, the
+// context creation and the allocations of the first job of an image size simulated by sleeps
+class SimulatedExtractor : public xpcf::ComponentBase,
+    public features::IDescriptorsExtractorFromImage,
+    public IPopSiftWarmup
+{
+public:
+    SimulatedExtractor() : ComponentBase(xpcf::toUUID<SimulatedExtractor>())
+    {
+        addInterface<features::IDescriptorsExtractorFromImage>(this);
+        addInterface<IPopSiftWarmup>(this);
+    }
+
+    ~SimulatedExtractor() { m_warmup.join(); }
+
+    void setAsyncWarmup(bool asyncWarmup) { m_asyncWarmup = asyncWarmup; }
+    void setFloatImages(bool floatImages) { m_floatImages = floatImages; }
+    void setWarmupSize(uint32_t width, uint32_t height) { m_warmupWidth = width; m_warmupHeight = height; }
+
+    void configure()
+    {
+        auto configureStart = Warmup::Clock::now();
+        m_warmup.join();
+        bool reuseContext = m_hasContext && m_contextFloatImages == m_floatImages;
+        std::vector<WarmupStage> stages;
+        if (!m_deviceQueried)
+            stages.push_back({ &StartupMetrics::deviceQueryTime, [this]() {
+                simulate(deviceQueryCost);
+                m_deviceQueried = true;
+            }});
+        stages.push_back({ &StartupMetrics::contextTime, [this, reuseContext]() {
+            if (reuseContext) {
+                simulate(contextReconfigurationCost);
+                return;
+            }
+            simulate(contextCreationCost);
+            m_hasContext = true;
+            m_contextFloatImages = m_floatImages;
+            m_allocatedWidth = m_allocatedHeight = 0;
+        }});
+        if (m_warmupWidth > 0 && m_warmupHeight > 0)
+            stages.push_back({ &StartupMetrics::primingTime, [this]() { job(m_warmupWidth, m_warmupHeight); }});
+        m_warmup.start(configureStart, std::move(stages), m_asyncWarmup, reuseContext);
+    }
+
+    std::string getTypeString() override { return std::string("DescriptorsExtractorType::SIFT"); }
+
+    FrameworkReturnCode extract(const SRef<Image> image, std::vector<Keypoint> & keypoints, SRef<DescriptorBuffer> & descriptors) override
+    {
+        if (!m_warmup.waitForFrame())
+            return FrameworkReturnCode::_ERROR_;
+        job(image->getWidth(), image->getHeight());
+        keypoints.clear();
+        descriptors.reset(new DescriptorBuffer(DescriptorType::SIFT, DescriptorDataType::TYPE_32F, 128, 0));
+        return FrameworkReturnCode::_SUCCESS;
+    }
+
+    bool isReady() const override { return m_warmup.isReady(); }
+    bool waitUntilReady(float timeout) override { return m_warmup.waitUntilReady(timeout); }
+    StartupMetrics getStartupMetrics() const override { return m_warmup.getMetrics(); }
+
+private:
+    void job(uint32_t width, uint32_t height)
+    {
+        if (width != m_allocatedWidth || height != m_allocatedHeight) {
+            simulate(allocationCost);
+            m_allocatedWidth = width;
+            m_allocatedHeight = height;
+        }
+        simulate(frameCost);
+    }
+
+    Warmup m_warmup;
+    bool m_asyncWarmup = true;
+    bool m_floatImages = false;
+    uint32_t m_warmupWidth = 640;
+    uint32_t m_warmupHeight = 480;
+    bool m_deviceQueried = false;
+    bool m_hasContext = false;
+    bool m_contextFloatImages = false;
+    uint32_t m_allocatedWidth = 0;
+    uint32_t m_allocatedHeight = 0;
+};
+
+template <> struct org::bcom::xpcf::ComponentTraits<SimulatedExtractor>
+{
+    static constexpr const char * UUID = "{9ee375bb-5fa2-4dbe-a33e-408a91482840}";
+    static constexpr const char * NAME = "SimulatedExtractor";
+    static constexpr const char * DESCRIPTION = "SimulatedExtractor implements SolAR::api::features::IDescriptorsExtractorFromImage interface";
+};
+
+// Latency of one frame
+static float frameLatency(SRef<features::IDescriptorsExtractorFromImage> extractor, const SRef<Image> image)
+{
+    std::vector<Keypoint> keypoints;
+    SRef<DescriptorBuffer> descriptors;
+    auto start = Warmup::Clock::now();
+    extractor->extract(image, keypoints, descriptors);
+    return elapsed(start);
+}
+
+static void logMetrics(const std::string & name, const StartupMetrics & metrics)
+{
+    LOG_INFO("{}: configure {} ms, device query {} ms, context {} ms ({}), priming {} ms, ready after {} ms, first frame waited {} ms",
+             name, metrics.configureTime, metrics.deviceQueryTime, metrics.contextTime, metrics.contextReused ? "reused" : "created",
+             metrics.primingTime, metrics.readyTime, metrics.firstFrameWaitTime);
+}
+
+int main()
+{
+#if NDEBUG
+    boost::log::core::get()->set_logging_enabled(false);
+#endif
+    LOG_ADD_LOG_TO_CONSOLE();
+
+    int result = 0;
+    SRef<Image> image = xpcf::utils::make_shared<Image>(640, 480, Image::ImageLayout::LAYOUT_GREY, Image::PixelOrder::INTERLEAVED, Image::DataType::TYPE_8U);
+    SRef<SimulatedExtractor> extractor = xpcf::utils::make_shared<SimulatedExtractor>();
+    SRef<IPopSiftWarmup> warmup = extractor;
+
+    // background warm-up: the configuration returns at once, the first frame runs at steady-state latency
+    extractor->configure();
+    StartupMetrics configured = warmup->getStartupMetrics();
+    bool readyAtOnce = warmup->isReady();
+    if (!warmup->waitUntilReady(5000.0f)) {
+        LOG_ERROR("The background warm-up did not end");
+        return -1;
+    }
+    float firstFrame = frameLatency(extractor, image);
+    float steadyFrame = frameLatency(extractor, image);
+    StartupMetrics background = warmup->getStartupMetrics();
+    logMetrics("Background warm-up", background);
+    LOG_INFO("First frame {} ms, steady state {} ms", firstFrame, steadyFrame);
+    if (configured.configureTime > 30.0f || readyAtOnce) {
+        LOG_ERROR("The configuration waited for the warm-up ({} ms)", configured.configureTime);
+        result = -1;
+    }
+    if (!background.ready || !background.background || background.contextReused || background.deviceQueryTime < deviceQueryCost ||
+        background.contextTime < contextCreationCost || background.primingTime < allocationCost || background.readyTime < background.primingTime) {
+        LOG_ERROR("Wrong startup metrics of the background warm-up");
+        result = -1;
+    }
+    if (firstFrame > steadyFrame + frameCost) {
+        LOG_ERROR("The first frame did not run at steady-state latency");
+        result = -1;
+    }
+
+    // a frame given during the warm-up waits for it, the wait being reported
+    extractor->setFloatImages(true);
+    extractor->configure();
+    frameLatency(extractor, image);
+    StartupMetrics early = warmup->getStartupMetrics();
+    logMetrics("Frame during the warm-up", early);
+    if (early.contextReused || early.deviceQueryTime != 0.0f || early.firstFrameWaitTime < contextCreationCost / 2) {
+        LOG_ERROR("Wrong startup metrics of a frame given during the warm-up");
+        result = -1;
+    }
+
+    // reconfiguration for the same image type: the context and the buffers are kept
+    extractor->configure();
+    warmup->waitUntilReady();
+    StartupMetrics reconfigured = warmup->getStartupMetrics();
+    logMetrics("Reconfiguration", reconfigured);
+    if (!reconfigured.contextReused || reconfigured.contextTime > contextCreationCost / 2 || reconfigured.nbConfigurations != 3) {
+        LOG_ERROR("The context was not kept by the reconfiguration");
+        result = -1;
+    }
+
+    // warm-up on the calling thread
+    extractor->setAsyncWarmup(false);
+    extractor->setFloatImages(false);
+    extractor->configure();
+    StartupMetrics synchronous = warmup->getStartupMetrics();
+    logMetrics("Synchronous warm-up", synchronous);
+    if (!synchronous.ready || synchronous.background || synchronous.configureTime < contextCreationCost) {
+        LOG_ERROR("Wrong startup metrics of the synchronous warm-up");
+        result = -1;
+    }
+
+    // without priming, the first frame pays the allocations
+    extractor->setAsyncWarmup(true);
+    extractor->setFloatImages(true);
+    extractor->setWarmupSize(0, 0);
+    extractor->configure();
+    warmup->waitUntilReady();
+    float unprimedFrame = frameLatency(extractor, image);
+    LOG_INFO("First frame without priming {} ms", unprimedFrame);
+    if (unprimedFrame < allocationCost) {
+        LOG_ERROR("The first frame without priming should pay the allocations");
+        result = -1;
+    }
+
+    // the dense extractor of the module warms up the same way
+    try {
+        SRef<xpcf::IComponentManager> xpcfComponentManager = xpcf::getComponentManagerInstance();
+        if (xpcfComponentManager->load("SolARTest_ModulePopSift_Warmup_conf.xml") != org::bcom::xpcf::_SUCCESS) {
+            LOG_ERROR("Failed to load the configuration file SolARTest_ModulePopSift_Warmup_conf.xml")
+            return -1;
+        }
+        SRef<features::IDescriptorsExtractorFromImage> denseExtractor = xpcfComponentManager->resolve<features::IDescriptorsExtractorFromImage>();
+        SRef<IPopSiftWarmup> denseWarmup = denseExtractor->bindTo<IPopSiftWarmup>();
+        if (!denseWarmup->waitUntilReady(10000.0f)) {
+            LOG_ERROR("The dense extractor warm-up failed");
+            return -1;
+        }
+        StartupMetrics dense = denseWarmup->getStartupMetrics();
+        logMetrics("Dense extractor", dense);
+        SRef<Image> denseImage = xpcf::utils::make_shared<Image>(320, 240, Image::ImageLayout::LAYOUT_GREY, Image::PixelOrder::INTERLEAVED, Image::DataType::TYPE_8U);
+        std::vector<Keypoint> keypoints;
+        SRef<DescriptorBuffer> descriptors;
+        if (!dense.background || dense.primingTime <= 0.0f ||
+            denseExtractor->extract(denseImage, keypoints, descriptors) != FrameworkReturnCode::_SUCCESS || keypoints.empty()) {
+            LOG_ERROR("Wrong warm-up of the dense extractor");
+            result = -1;
+        }
+    }
+    catch (xpcf::Exception e)
+    {
+        LOG_ERROR ("The following exception has been catch : {}", e.what());
+        return -1;
+    }
+
+    if (result == 0)
+        LOG_INFO("Warm-up test succeeded");
+    return result;
+}
@@ -0,0 +1,162 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOLARTEST_MODULEPOPSIFT_SYNTHETICDESCRIPTORS_H
+#define SOLARTEST_MODULEPOPSIFT_SYNTHETICDESCRIPTORS_H
+
+#include "xpcf/xpcf.h"
+
+#include "SolARPopSiftKernels.h"
+#include "SolARTest_ModulePopSift_SyntheticImages.h"
+#include "datastructure/DescriptorBuffer.h"
+#include "datastructure/DescriptorMatch.h"
+#include "datastructure/Keypoint.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+// Deterministic synthetic descriptors and matching references shared by the tests of the module
+namespace SolAR {
+namespace MODULES {
+namespace POPSIFT {
+namespace TEST {
+
+const uint32_t descriptorLength = 128;
+
+/// @brief wraps contiguous float SIFT descriptors, without copy.
+inline SRef<datastructure::DescriptorBuffer> toBuffer(const std::vector<float> & descriptors)
+{
+    using namespace datastructure;
+    return org::bcom::xpcf::utils::make_shared<DescriptorBuffer>((unsigned char*)descriptors.data(), DescriptorType::SIFT, DescriptorDataType::TYPE_32F,
+                                                                 descriptorLength, uint32_t(descriptors.size() / descriptorLength));
+}
+
+// Features of a synthetic rectified pair: the right keypoints are the left ones shifted by a disparity, with noisy
+// descriptors and sub-pixel row errors, one left keypoint out of 5 having no correspondence
+struct StereoPair {
+    std::vector<datastructure::Keypoint> leftKeypoints, rightKeypoints;
+    std::vector<float> leftDescriptors, rightDescriptors;
+    std::vector<int> truth;             // right index of each left keypoint, -1 if none
+    std::vector<float> disparities;     // true disparity of each left keypoint
+};
+
+inline StereoPair createStereoPair(uint32_t nbKeypoints, uint32_t width, uint32_t height, float maxDisparity, unsigned int seed)
+{
+    StereoPair pair;
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    std::uniform_real_distribution<float> noise(-0.05f, 0.05f);
+    for (uint32_t i = 0; i < nbKeypoints; ++i) {
+        float x = maxDisparity + uniform(random) * (width - maxDisparity);
+        float y = uniform(random) * height;
+        float disparity = uniform(random) * maxDisparity;
+        datastructure::Keypoint left;
+        left.init(i, x, y, 0.0f, 0.0f, 0.0f, 2.0f, 0.0f);
+        pair.leftKeypoints.push_back(left);
+        pair.disparities.push_back(disparity);
+        bool matched = (i % 5 != 0);
+        for (uint32_t j = 0; j < descriptorLength; ++j) {
+            float value = uniform(random);
+            pair.leftDescriptors.push_back(value);
+            if (matched)
+                pair.rightDescriptors.push_back(value + noise(random));
+        }
+        if (!matched) {
+            pair.truth.push_back(-1);
+            continue;
+        }
+        datastructure::Keypoint right;
+        right.init(uint32_t(pair.rightKeypoints.size()), x - disparity, y + noise(random) * 10.0f, 0.0f, 0.0f, 0.0f, 2.0f, 0.0f);
+        pair.truth.push_back(int(pair.rightKeypoints.size()));
+        pair.rightKeypoints.push_back(right);
+    }
+    return pair;
+}
+
+// Query descriptors matched against a database: the database descriptors are variations of a few patterns, as on
+// repetitive textures, each query being a noisy copy of one of them
+struct MatchingSet {
+    std::vector<float> database, queries;
+    std::vector<uint32_t> truth;        // database index of each query
+};
+
+inline MatchingSet createMatchingSet(uint32_t nbDatabase, uint32_t nbQueries, uint32_t nbPatterns, unsigned int seed)
+{
+    MatchingSet set;
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    std::normal_distribution<float> noise(0.0f, 0.05f);
+    std::vector<float> patterns(nbPatterns * descriptorLength);
+    for (float & value : patterns) {
+        // SIFT descriptors are non negative and dominated by a few bins
+        float u = uniform(random);
+        value = u * u * u;
+    }
+    for (uint32_t i = 0; i < nbDatabase; ++i) {
+        uint32_t pattern = random() % nbPatterns;
+        for (uint32_t j = 0; j < descriptorLength; ++j)
+            set.database.push_back(std::max(0.0f, patterns[pattern * descriptorLength + j] + noise(random)));
+    }
+    for (uint32_t i = 0; i < nbQueries; ++i) {
+        set.truth.push_back(random() % nbDatabase);
+        for (uint32_t j = 0; j < descriptorLength; ++j)
+            set.queries.push_back(std::max(0.0f, set.database[set.truth.back() * descriptorLength + j] + noise(random)));
+    }
+    return set;
+}
+
+/// @brief exhaustive float matching with a ratio test, the score being the L2 distance.
+/// @param[in,out] distances, scratch buffer, so that repeated matchings do not allocate.
+inline void bruteForceMatch(const std::vector<float> & queries, const std::vector<float> & database, float ratio,
+                            std::vector<datastructure::DescriptorMatch> & matches, std::vector<float> & distances)
+{
+    matches.clear();
+    uint32_t nbDatabase = uint32_t(database.size() / descriptorLength);
+    if (nbDatabase == 0)
+        return;
+    distances.resize(nbDatabase);
+    for (uint32_t i = 0; i < queries.size() / descriptorLength; ++i) {
+        kernels::l2sqrRows(queries.data() + i * descriptorLength, database.data(), nbDatabase, descriptorLength, distances.data());
+        auto best = std::min_element(distances.begin(), distances.end());
+        float bestDistance = *best;
+        *best = std::numeric_limits<float>::max();
+        if (bestDistance < ratio * ratio * *std::min_element(distances.begin(), distances.end()))
+            matches.push_back(datastructure::DescriptorMatch(i, uint32_t(best - distances.begin()), std::sqrt(bestDistance)));
+    }
+}
+
+/// @return the ratio of the queries with a truth that are matched to it.
+template <typename Index>
+float recallOf(const std::vector<datastructure::DescriptorMatch> & matches, const std::vector<Index> & truth)
+{
+    uint32_t nbTrue = 0, nbFound = 0;
+    for (Index index : truth)
+        nbTrue += index != Index(-1);
+    for (const auto & match : matches)
+        nbFound += truth[match.getIndexInDescriptorA()] == Index(match.getIndexInDescriptorB());
+    return nbTrue > 0 ? float(nbFound) / nbTrue : 0.0f;
+}
+
+}
+}
+}
+}
+
+#endif // SOLARTEST_MODULEPOPSIFT_SYNTHETICDESCRIPTORS_H
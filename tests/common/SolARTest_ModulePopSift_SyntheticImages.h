@@ -0,0 +1,86 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOLARTEST_MODULEPOPSIFT_SYNTHETICIMAGES_H
+#define SOLARTEST_MODULEPOPSIFT_SYNTHETICIMAGES_H
+
+#include "xpcf/xpcf.h"
+
+#include "datastructure/Image.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Deterministic synthetic images shared by the tests of the module
+namespace SolAR {
+namespace MODULES {
+namespace POPSIFT {
+namespace TEST {
+
+/// @brief grey image of smooth waves, shifted horizontally by offsetX pixels.
+inline SRef<datastructure::Image> createTexturedImage(uint32_t width, uint32_t height, int offsetX = 0)
+{
+    using datastructure::Image;
+    SRef<Image> image = org::bcom::xpcf::utils::make_shared<Image>(width, height, Image::ImageLayout::LAYOUT_GREY,
+                                                                   Image::PixelOrder::INTERLEAVED, Image::DataType::TYPE_8U);
+    unsigned char * pixels = static_cast<unsigned char *>(image->data());
+    for (uint32_t y = 0; y < height; ++y)
+        for (uint32_t x = 0; x < width; ++x) {
+            float u = float(int(x) + offsetX);
+            float v = float(y);
+            float value = 128.0f + 60.0f * std::sin(u * 0.21f) * std::cos(v * 0.17f)
+                                 + 40.0f * std::sin((u + 2.0f * v) * 0.05f)
+                                 + 20.0f * std::cos(std::sqrt(u * u + v * v) * 0.3f);
+            pixels[y * width + x] = static_cast<unsigned char>(std::min(255.0f, std::max(0.0f, value)));
+        }
+    return image;
+}
+
+/// @brief grey image of random blobs, shifted to the left by shift pixels (the right image of a rectified pair).
+inline SRef<datastructure::Image> createBlobImage(uint32_t width, uint32_t height, int shift = 0)
+{
+    using datastructure::Image;
+    SRef<Image> image = org::bcom::xpcf::utils::make_shared<Image>(width, height, Image::ImageLayout::LAYOUT_GREY,
+                                                                   Image::PixelOrder::INTERLEAVED, Image::DataType::TYPE_8U);
+    std::vector<float> values(width * height, 128.0f);
+    std::mt19937 random(5);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    for (int blob = 0; blob < 600; ++blob) {
+        float cx = uniform(random) * (width + 64) - shift;
+        float cy = uniform(random) * height;
+        float radius = 2.0f + uniform(random) * 8.0f;
+        float contrast = (uniform(random) - 0.5f) * 200.0f;
+        for (int y = std::max(0, int(cy - 3 * radius)); y < std::min(int(height), int(cy + 3 * radius)); ++y)
+            for (int x = std::max(0, int(cx - 3 * radius)); x < std::min(int(width), int(cx + 3 * radius)); ++x) {
+                float d2 = ((x - cx) * (x - cx) + (y - cy) * (y - cy)) / (radius * radius);
+                values[y * width + x] += contrast * std::exp(-0.5f * d2);
+            }
+    }
+    unsigned char * pixels = static_cast<unsigned char *>(image->data());
+    for (std::size_t i = 0; i < values.size(); ++i)
+        pixels[i] = static_cast<unsigned char>(std::min(255.0f, std::max(0.0f, values[i])));
+    return image;
+}
+
+}
+}
+}
+}
+
+#endif // SOLARTEST_MODULEPOPSIFT_SYNTHETICIMAGES_H
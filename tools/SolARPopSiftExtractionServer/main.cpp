@@ -0,0 +1,108 @@
+/**
+ * @copyright Copyright (c) 2017 B-com http://www.b-com.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "xpcf/xpcf.h"
+
+#include "api/features/IDescriptorsExtractorFromImage.h"
+#include "SolARPopSiftExtractionChannel.h"
+#include "core/Log.h"
+
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace SolAR;
+using namespace SolAR::api;
+using namespace SolAR::MODULES::POPSIFT;
+
+namespace xpcf  = org::bcom::xpcf;
+
+static ExtractionServer server;
+
+static void stopServer(int)
+{
+    server.stop();
+}
+
+static void usage()
+{
+    std::printf("SolARPopSiftExtractionServer [--conf file] [--name /segment] [--clients n] [--slots n] [--max-image-bytes n] [--max-keypoints n]\n"
+                "Serves the extractor resolved from the configuration file to the SolARDescriptorsExtractorFromImageClientPopSift components of this machine.\n");
+}
+
+int main(int argc, char * argv[])
+{
+    std::string confFile = "SolARPopSiftExtractionServer_conf.xml";
+    std::string name = "/solar_popsift";
+    ExtractionChannelConfig config;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--conf") && hasValue)
+            confFile = argv[++i];
+        else if (!std::strcmp(argv[i], "--name") && hasValue)
+            name = argv[++i];
+        else if (!std::strcmp(argv[i], "--clients") && hasValue)
+            config.maxClients = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (!std::strcmp(argv[i], "--slots") && hasValue)
+            config.slotsPerClient = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (!std::strcmp(argv[i], "--max-image-bytes") && hasValue)
+            config.maxImageBytes = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--max-keypoints") && hasValue)
+            config.maxKeypoints = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else {
+            usage();
+            return -1;
+        }
+    }
+
+    try {
+        LOG_ADD_LOG_TO_CONSOLE();
+
+        SRef<xpcf::IComponentManager> xpcfComponentManager = xpcf::getComponentManagerInstance();
+        if (xpcfComponentManager->load(confFile.c_str()) != org::bcom::xpcf::_SUCCESS)
+        {
+            LOG_ERROR("Failed to load the configuration file {}", confFile);
+            return -1;
+        }
+
+        // one extractor, hence one PopSift context, for all the clients
+        SRef<features::IDescriptorsExtractorFromImage> extractor = xpcfComponentManager->resolve<features::IDescriptorsExtractorFromImage>();
+        if (!extractor)
+        {
+            LOG_ERROR("One or more component creations have failed");
+            return -1;
+        }
+        if (server.create(name, extractor, config) != FrameworkReturnCode::_SUCCESS)
+            return -1;
+
+        std::signal(SIGINT, stopServer);
+        std::signal(SIGTERM, stopServer);
+        LOG_INFO("SolARPopSiftExtractionServer serving on {}", name);
+        server.run();
+        server.destroy();
+
+        ExtractionServerStats stats = server.getStats();
+        LOG_INFO("SolARPopSiftExtractionServer served {} requests in {} batches (max batch {}), {} dead clients reclaimed",
+                 stats.nbRequests, stats.nbBatches, stats.maxBatchSize, stats.nbReclaimedClients);
+    }
+    catch (xpcf::Exception e)
+    {
+        LOG_ERROR ("The following exception has been catch : {}", e.what());
+        return -1;
+    }
+    return 0;
+}